@@ -0,0 +1,114 @@
+#include "AllocationCounter.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTLS.h"
+#include <atomic>
+
+namespace
+{
+    // Forwards everything to the allocator it was put in front of, and counts what the counting thread asks for
+    class FCountingMalloc final : public FMalloc
+    {
+    public:
+        virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+        {
+            Record(Count);
+            return Inner->Malloc(Count, Alignment);
+        }
+
+        virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+        {
+            Record(Count);
+            return Inner->TryMalloc(Count, Alignment);
+        }
+
+        virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+        {
+            // A realloc to zero is a free
+            if (Count > 0)
+            {
+                Record(Count);
+            }
+            return Inner->Realloc(Original, Count, Alignment);
+        }
+
+        virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+        {
+            if (Count > 0)
+            {
+                Record(Count);
+            }
+            return Inner->TryRealloc(Original, Count, Alignment);
+        }
+
+        virtual void Free(void* Original) override { Inner->Free(Original); }
+        virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+        virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+        virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+        virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+        virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+        virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+        virtual void UpdateStats() override { Inner->UpdateStats(); }
+        virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+        virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+        virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+        virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+        virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+        // The allocator every call goes on to
+        FMalloc* Inner = nullptr;
+
+        // Thread whose allocations are counted, zero while no counter is active
+        std::atomic<uint32> CountingThreadId{ 0 };
+
+        // Only written by the counting thread
+        int64 NumAllocations = 0;
+        int64 NumBytes = 0;
+
+    private:
+        void Record(SIZE_T Size)
+        {
+            if (CountingThreadId.load(std::memory_order_relaxed) == FPlatformTLS::GetCurrentThreadId())
+            {
+                NumAllocations++;
+                NumBytes += Size;
+            }
+        }
+    };
+
+    // Never destroyed: another thread may still be inside a call it read from GMalloc just before the counter ended
+    FCountingMalloc& GetCountingMalloc()
+    {
+        static FCountingMalloc* CountingMalloc = new FCountingMalloc();
+        return *CountingMalloc;
+    }
+}
+
+FScopedAllocationCounter::FScopedAllocationCounter()
+{
+    FCountingMalloc& CountingMalloc = GetCountingMalloc();
+    check(GMalloc != &CountingMalloc);
+    CountingMalloc.Inner = GMalloc;
+    CountingMalloc.NumAllocations = 0;
+    CountingMalloc.NumBytes = 0;
+    CountingMalloc.CountingThreadId.store(FPlatformTLS::GetCurrentThreadId());
+    GMalloc = &CountingMalloc;
+}
+
+FScopedAllocationCounter::~FScopedAllocationCounter()
+{
+    FCountingMalloc& CountingMalloc = GetCountingMalloc();
+    check(GMalloc == &CountingMalloc);
+    check(CountingMalloc.CountingThreadId.load() == FPlatformTLS::GetCurrentThreadId());
+    CountingMalloc.CountingThreadId.store(0);
+    GMalloc = CountingMalloc.Inner;
+}
+
+int64 FScopedAllocationCounter::GetNumAllocations() const
+{
+    return GetCountingMalloc().NumAllocations;
+}
+
+int64 FScopedAllocationCounter::GetNumBytes() const
+{
+    return GetCountingMalloc().NumBytes;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Counts every heap allocation the calling thread makes while the counter is in scope, whoever makes it. A proxy
+ * is put in front of GMalloc that forwards every call and counts the Malloc and Realloc calls coming from the
+ * counting thread, so allocations the code under test never reports itself (path buffers, container slack, maps)
+ * are counted too. Other threads keep allocating through the proxy uncounted.
+ *
+ * For checks and benchmarks only: one counter may be active at a time, and it must end on the thread it began on.
+ */
+class PATHFINDINGPROJECT_API FScopedAllocationCounter
+{
+public:
+    FScopedAllocationCounter();
+    ~FScopedAllocationCounter();
+
+    FScopedAllocationCounter(const FScopedAllocationCounter&) = delete;
+    FScopedAllocationCounter& operator=(const FScopedAllocationCounter&) = delete;
+
+    // Allocations and reallocations made by the counting thread so far
+    int64 GetNumAllocations() const;
+
+    // Bytes requested by those allocations
+    int64 GetNumBytes() const;
+};
@@ -0,0 +1,343 @@
+#include "CompressedPathDatabase.h"
+#include "GridNodeStore.h"
+#include "IndexedNodeHeap.h"
+#include "PathfindingStats.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Crc.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// Identifies a saved database, and the layout it was saved with
+static constexpr uint32 BlobMagic = 0x42445043; // "CPDB"
+static constexpr uint32 BlobVersion = 1;
+
+// Dijkstra state for the row of one source at a time, one per worker
+struct FFirstMoveSearch
+{
+    TArray<float> Distances;
+    TArray<uint8> FirstMoves;
+    FIndexedNodeHeap OpenSet;
+
+    // Finds the first move from Source to every tile, charging steps like FGridNodeStore::FindPath
+    void Run(const FGridNodeStore& Nodes, int32 Source)
+    {
+        Distances.Init(TNumericLimits<float>::Max(), Nodes.Num());
+        FirstMoves.Init(FCompressedPathDatabase::NoMove, Nodes.Num());
+        OpenSet.Reserve(Nodes.Num());
+
+        auto IsCloser = [this](int32 A, int32 B)
+        {
+            return Distances[A] < Distances[B];
+        };
+
+        Distances[Source] = 0.0f;
+        OpenSet.Push(Source, IsCloser);
+        while (!OpenSet.IsEmpty())
+        {
+            const int32 Current = OpenSet.Pop(IsCloser);
+            for (int32 Direction = 0; Direction < FGridNodeStore::NumDirections; Direction++)
+            {
+                const int32 Neighbor = Nodes.GetNeighbor(Current, Direction);
+                if (Neighbor == INDEX_NONE || Nodes.Obstacles[Neighbor])
+                {
+                    continue;
+                }
+
+                const float Distance = Distances[Current] + FVector::Dist(Nodes.Positions[Current], Nodes.Positions[Neighbor]) * Nodes.Weights[Neighbor];
+                if (Distance < Distances[Neighbor])
+                {
+                    // Tiles inherit the first move of the tile they are reached from, except the source's own neighbors
+                    Distances[Neighbor] = Distance;
+                    FirstMoves[Neighbor] = Current == Source ? (uint8)Direction : FirstMoves[Current];
+                    if (OpenSet.Contains(Neighbor))
+                    {
+                        OpenSet.DecreaseKey(Neighbor, IsCloser);
+                    }
+                    else
+                    {
+                        OpenSet.Push(Neighbor, IsCloser);
+                    }
+                }
+            }
+        }
+    }
+};
+
+bool FCompressedPathDatabase::Build(const FGridNodeStore& Nodes, int32 MaxWorkers, const std::atomic<bool>* CancelFlag)
+{
+    Reset();
+    const double StartTime = FPlatformTime::Seconds();
+    const int32 NumTiles = Nodes.Num();
+    if (NumTiles == 0)
+    {
+        return true;
+    }
+
+    TArray<int32> Positions;
+    ComputeTargetOrder(Nodes, Positions);
+    TArray<int32> OrderedTargets;
+    OrderedTargets.SetNum(NumTiles);
+    for (int32 Index = 0; Index < NumTiles; Index++)
+    {
+        OrderedTargets[Positions[Index]] = Index;
+    }
+
+    if (MaxWorkers <= 0)
+    {
+        MaxWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+    }
+    const int32 NumWorkers = FMath::Min(MaxWorkers, NumTiles);
+
+    // Every source writes only its own row, so the rows are computed independently and joined afterwards
+    TArray<TArray<uint32>> Rows;
+    Rows.SetNum(NumTiles);
+    std::atomic<int32> NextSource(0);
+    ParallelFor(NumWorkers, [&Nodes, &OrderedTargets, &Rows, &NextSource, CancelFlag](int32 WorkerIndex)
+    {
+        FFirstMoveSearch Search;
+        for (int32 Source = NextSource++; Source < Rows.Num(); Source = NextSource++)
+        {
+            if (CancelFlag && CancelFlag->load())
+            {
+                return;
+            }
+            Search.Run(Nodes, Source);
+
+            // A new run starts wherever the move changes. Obstacles and the source itself are never looked up,
+            // so they extend whatever run they fall into.
+            TArray<uint32>& Row = Rows[Source];
+            uint8 RunMove = 0xFF;
+            for (int32 Position = 0; Position < OrderedTargets.Num(); Position++)
+            {
+                const int32 Target = OrderedTargets[Position];
+                if (Target == Source || Nodes.Obstacles[Target])
+                {
+                    continue;
+                }
+
+                const uint8 Move = Search.FirstMoves[Target];
+                if (Move != RunMove)
+                {
+                    Row.Add((Row.Num() == 0 ? 0u : (uint32)Position) << MoveBits | Move);
+                    RunMove = Move;
+                }
+            }
+            Row.Shrink();
+        }
+    });
+    if (CancelFlag && CancelFlag->load())
+    {
+        return false;
+    }
+
+    int32 NumRuns = 0;
+    for (const TArray<uint32>& Row : Rows)
+    {
+        NumRuns += Row.Num();
+    }
+    RowStarts.Reserve(NumTiles + 1);
+    Runs.Reserve(NumRuns);
+    for (TArray<uint32>& Row : Rows)
+    {
+        RowStarts.Add(Runs.Num());
+        Runs.Append(Row);
+        Row.Empty();
+    }
+    RowStarts.Add(Runs.Num());
+
+    GridCount = Nodes.GetGridCount();
+    NumNodes = NumTiles;
+    GridHash = GetGridHash(Nodes);
+    TargetPositions = MoveTemp(Positions);
+    BuildSeconds = FPlatformTime::Seconds() - StartTime;
+    return true;
+}
+
+void FCompressedPathDatabase::Reset()
+{
+    GridCount = 0;
+    NumNodes = 0;
+    GridHash = 0;
+    TargetPositions.Empty();
+    RowStarts.Empty();
+    Runs.Empty();
+    BuildSeconds = 0.0;
+}
+
+bool FCompressedPathDatabase::IsBuiltFor(const FGridNodeStore& Nodes) const
+{
+    return IsBuilt() && Nodes.GetGridCount() == GridCount && Nodes.Num() == NumNodes && GetGridHash(Nodes) == GridHash;
+}
+
+uint8 FCompressedPathDatabase::GetFirstMove(int32 Source, int32 Target) const
+{
+    // The run holding the target is the last one that starts at or before its position
+    const uint32 Position = (uint32)TargetPositions[Target];
+    const int32 RowStart = RowStarts[Source];
+    int32 Low = RowStart;
+    int32 High = RowStarts[Source + 1];
+    while (Low < High)
+    {
+        const int32 Middle = (Low + High) / 2;
+        if ((Runs[Middle] >> MoveBits) <= Position)
+        {
+            Low = Middle + 1;
+        }
+        else
+        {
+            High = Middle;
+        }
+    }
+    return Low > RowStart ? (uint8)(Runs[Low - 1] & MoveMask) : NoMove;
+}
+
+bool FCompressedPathDatabase::FindPath(const FGridNodeStore& Nodes, int32 StartIndex, int32 GoalIndex, TArray<int32>& OutPath) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_PathfindingSearch);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FCompressedPathDatabase_FindPath, PathfindingChannel);
+    FPathQueryStats QueryStats(OutPath);
+
+    OutPath.Reset();
+    if (!Nodes.IsValidIndex(StartIndex) || !Nodes.IsValidIndex(GoalIndex) || Nodes.Num() != NumNodes)
+    {
+        return false;
+    }
+
+    // A search from a tile to itself succeeds even on an obstacle, and no other path may end on one
+    OutPath.Add(StartIndex);
+    if (StartIndex == GoalIndex)
+    {
+        return true;
+    }
+    if (Nodes.Obstacles[GoalIndex])
+    {
+        OutPath.Reset();
+        return false;
+    }
+
+    // Every step gets strictly closer to the goal, so the walk cannot loop; the limit only guards against a stale database
+    for (int32 Current = StartIndex; Current != GoalIndex;)
+    {
+        const uint8 Move = GetFirstMove(Current, GoalIndex);
+        Current = Move == NoMove ? INDEX_NONE : Nodes.GetNeighbor(Current, Move);
+        if (Current == INDEX_NONE || OutPath.Num() > NumNodes)
+        {
+            OutPath.Reset();
+            return false;
+        }
+        OutPath.Add(Current);
+    }
+    return true;
+}
+
+void FCompressedPathDatabase::SaveToBlob(TArray<uint8>& OutBlob) const
+{
+    OutBlob.Reset();
+    FMemoryWriter Writer(OutBlob, true);
+
+    uint32 Magic = BlobMagic;
+    uint32 Version = BlobVersion;
+    int32 SavedGridCount = GridCount;
+    uint32 SavedGridHash = GridHash;
+    Writer << Magic << Version << SavedGridCount << SavedGridHash;
+    Writer << const_cast<TArray<int32>&>(TargetPositions);
+    Writer << const_cast<TArray<int32>&>(RowStarts);
+    Writer << const_cast<TArray<uint32>&>(Runs);
+}
+
+bool FCompressedPathDatabase::LoadFromBlob(TConstArrayView<uint8> Blob)
+{
+    Reset();
+    FMemoryReaderView Reader(Blob, true);
+
+    uint32 Magic = 0;
+    uint32 Version = 0;
+    Reader << Magic << Version;
+    if (Reader.IsError() || Magic != BlobMagic || Version != BlobVersion)
+    {
+        return false;
+    }
+    Reader << GridCount << GridHash;
+    Reader << TargetPositions << RowStarts << Runs;
+
+    // Check everything a lookup relies on, so a damaged blob is rejected instead of read out of bounds
+    const int32 NumTiles = GridCount * GridCount;
+    bool bValid = !Reader.IsError() && GridCount > 0 && TargetPositions.Num() == NumTiles && RowStarts.Num() == NumTiles + 1
+        && RowStarts[0] == 0 && RowStarts.Last() == Runs.Num();
+    for (int32 Index = 0; bValid && Index < NumTiles; Index++)
+    {
+        bValid = TargetPositions[Index] >= 0 && TargetPositions[Index] < NumTiles && RowStarts[Index] <= RowStarts[Index + 1];
+    }
+    for (int32 RunIndex = 0; bValid && RunIndex < Runs.Num(); RunIndex++)
+    {
+        bValid = (Runs[RunIndex] & MoveMask) <= NoMove;
+    }
+    if (!bValid)
+    {
+        Reset();
+        return false;
+    }
+
+    NumNodes = NumTiles;
+    return true;
+}
+
+SIZE_T FCompressedPathDatabase::GetAllocatedSize() const
+{
+    return TargetPositions.GetAllocatedSize() + RowStarts.GetAllocatedSize() + Runs.GetAllocatedSize();
+}
+
+uint32 FCompressedPathDatabase::GetGridHash(const FGridNodeStore& Nodes)
+{
+    uint32 Hash = FCrc::MemCrc32(Nodes.Weights.GetData(), Nodes.Weights.Num() * sizeof(float));
+    Hash = FCrc::MemCrc32(Nodes.Obstacles.GetData(), Nodes.Obstacles.Num() * sizeof(bool), Hash);
+    return HashCombine(Hash, GetTypeHash(Nodes.GetGridCount()));
+}
+
+void FCompressedPathDatabase::ComputeTargetOrder(const FGridNodeStore& Nodes, TArray<int32>& OutTargetPositions)
+{
+    OutTargetPositions.Init(INDEX_NONE, Nodes.Num());
+    int32 NextPosition = 0;
+
+    // Preorder of a depth-first walk: a path from most sources leaves through the same neighbor for a whole
+    // branch of the walk, so those targets share a move and end up in one run
+    TArray<int32> Stack;
+    for (int32 Root = 0; Root < Nodes.Num(); Root++)
+    {
+        if (Nodes.Obstacles[Root] || OutTargetPositions[Root] != INDEX_NONE)
+        {
+            continue;
+        }
+
+        Stack.Add(Root);
+        while (Stack.Num() > 0)
+        {
+            const int32 Current = Stack.Pop(false);
+            if (OutTargetPositions[Current] != INDEX_NONE)
+            {
+                continue;
+            }
+            OutTargetPositions[Current] = NextPosition++;
+
+            for (int32 Direction = FGridNodeStore::NumDirections - 1; Direction >= 0; Direction--)
+            {
+                const int32 Neighbor = Nodes.GetNeighbor(Current, Direction);
+                if (Neighbor != INDEX_NONE && !Nodes.Obstacles[Neighbor] && OutTargetPositions[Neighbor] == INDEX_NONE)
+                {
+                    Stack.Add(Neighbor);
+                }
+            }
+        }
+    }
+
+    // Obstacles are never looked up, so where they go does not matter
+    for (int32 Index = 0; Index < Nodes.Num(); Index++)
+    {
+        if (OutTargetPositions[Index] == INDEX_NONE)
+        {
+            OutTargetPositions[Index] = NextPosition++;
+        }
+    }
+}
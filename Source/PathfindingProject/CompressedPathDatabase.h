@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+struct FGridNodeStore;
+
+/*
+ * First-move compressed path database (CPD) for maps that stop changing once they are loaded.
+ * For every source tile it stores the direction of the first step of a cheapest path to every target tile.
+ * A path is then read one step at a time: look up the first move from the start, step, and look up again from
+ * the tile stepped onto, with no search at all.
+ *
+ * The table would take one entry per pair of tiles, so each source's row is run-length encoded. Targets are
+ * ordered depth first through the open tiles, which keeps tiles that lie in the same direction from most
+ * sources next to each other, and a row is stored as the positions where its move changes. Obstacle targets
+ * can never be reached, so they take whatever move their run has and cost nothing.
+ *
+ * Building runs one Dijkstra search per tile, so it is meant for a background task or an offline step; the
+ * result can be saved to a blob and loaded later for the same grid. The database does not follow tile edits:
+ * IsBuiltFor tells whether it still matches a grid.
+ */
+class PATHFINDINGPROJECT_API FCompressedPathDatabase
+{
+public:
+    // Move stored for targets the source cannot reach
+    static constexpr uint8 NoMove = 6;
+
+    // Builds the database for the current tiles. MaxWorkers limits the threads used; zero uses all of them.
+    // Returns false, leaving the database empty, if CancelFlag was raised before the build finished.
+    bool Build(const FGridNodeStore& Nodes, int32 MaxWorkers = 0, const std::atomic<bool>* CancelFlag = nullptr);
+
+    // Drops the database
+    void Reset();
+
+    // Whether the database holds a grid, and whether that grid has the same size, weights and obstacles as Nodes
+    bool IsBuilt() const { return NumNodes > 0; }
+    bool IsBuiltFor(const FGridNodeStore& Nodes) const;
+
+    // Direction of the first step from Source towards Target (see FGridNodeStore::NumDirections), or NoMove.
+    // Meaningless when Target is an obstacle or Source itself.
+    uint8 GetFirstMove(int32 Source, int32 Target) const;
+
+    // Same contract as FGridNodeStore::FindPath, answered by lookups. Nodes has to be the grid the database was built for.
+    bool FindPath(const FGridNodeStore& Nodes, int32 StartIndex, int32 GoalIndex, TArray<int32>& OutPath) const;
+
+    // Writes the database to a blob, and reads one back. Loading fails on a blob that is damaged or from another version.
+    // The blob is only read, so it can be a view into a larger buffer such as a mapped grid file.
+    void SaveToBlob(TArray<uint8>& OutBlob) const;
+    bool LoadFromBlob(TConstArrayView<uint8> Blob);
+
+    // Total number of runs over all rows, one entry each
+    int32 GetNumRuns() const { return Runs.Num(); }
+
+    // Bytes used by the rows and the target order
+    SIZE_T GetAllocatedSize() const;
+
+    // Time the last Build took, in seconds
+    double BuildSeconds = 0.0;
+
+private:
+    // A run packs the position where it starts in the target order above the move it holds
+    static constexpr uint32 MoveBits = 3;
+    static constexpr uint32 MoveMask = (1u << MoveBits) - 1;
+
+    // Checksum of everything a path depends on, to tell whether a grid is the one the database was built for
+    static uint32 GetGridHash(const FGridNodeStore& Nodes);
+
+    // Position of every tile in the target order, depth first through the open tiles with obstacles at the end
+    static void ComputeTargetOrder(const FGridNodeStore& Nodes, TArray<int32>& OutTargetPositions);
+
+    int32 GridCount = 0;
+    int32 NumNodes = 0;
+    uint32 GridHash = 0;
+
+    TArray<int32> TargetPositions;
+
+    // Runs of source S are Runs[RowStarts[S]] up to Runs[RowStarts[S + 1]]. The first run of a row starts at zero.
+    TArray<int32> RowStarts;
+    TArray<uint32> Runs;
+};
@@ -0,0 +1,348 @@
+#include "ConnectedComponents.h"
+#include "GridNodeStore.h"
+#include "PathfindingStats.h"
+
+void FConnectedComponents::Build(const FGridNodeStore& InNodes)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FConnectedComponents_Build, PathfindingChannel);
+    Nodes = &InNodes;
+    bNeedsRebuild = false;
+    NumVisited = 0;
+
+    const int32 NumNodes = Nodes->Num();
+    Labels.Init(INDEX_NONE, NumNodes);
+    Parents.Reset();
+    Sizes.Reset();
+    NumComponents = 0;
+    VisitStamps.Init(0, NumNodes);
+    VisitOwners.Init(0, NumNodes);
+    VisitGeneration = 0;
+
+    // One flood per region, each reusing the same queue
+    TArray<int32>& Queue = Queues[0];
+    for (int32 Seed = 0; Seed < NumNodes; Seed++)
+    {
+        if (Nodes->Obstacles[Seed] || Labels[Seed] != INDEX_NONE)
+        {
+            continue;
+        }
+
+        const int32 Component = AddComponent();
+        Labels[Seed] = Component;
+        Queue.Reset();
+        Queue.Add(Seed);
+        for (int32 Head = 0; Head < Queue.Num(); Head++)
+        {
+            for (int32 Neighbor : Nodes->GetNeighbors(Queue[Head]))
+            {
+                if (Neighbor != INDEX_NONE && !Nodes->Obstacles[Neighbor] && Labels[Neighbor] == INDEX_NONE)
+                {
+                    Labels[Neighbor] = Component;
+                    Queue.Add(Neighbor);
+                }
+            }
+        }
+        NumVisited += Queue.Num();
+    }
+}
+
+void FConnectedComponents::Reset()
+{
+    Nodes = nullptr;
+    Labels.Reset();
+    Parents.Reset();
+    Sizes.Reset();
+    NumComponents = 0;
+    bNeedsRebuild = false;
+}
+
+void FConnectedComponents::NotifyNodeChanged(int32 Index)
+{
+    if (!Nodes || bNeedsRebuild || !Nodes->IsValidIndex(Index))
+    {
+        return;
+    }
+
+    // Only a change of obstacle state matters, and the label still says what the tile was
+    const bool bWasOpen = Labels[Index] != INDEX_NONE;
+    const bool bIsOpen = !Nodes->Obstacles[Index];
+    if (bWasOpen == bIsOpen)
+    {
+        return;
+    }
+    NumVisited = 0;
+
+    // Ids are never reused, so after many splits the table is rebuilt rather than left to grow
+    if (Parents.Num() > 2 * Nodes->Num() + 64)
+    {
+        Build(*Nodes);
+        return;
+    }
+
+    if (bIsOpen)
+    {
+        // The tile joins every region around it into one
+        int32 Component = INDEX_NONE;
+        for (int32 Neighbor : Nodes->GetNeighbors(Index))
+        {
+            if (Neighbor != INDEX_NONE && Labels[Neighbor] != INDEX_NONE)
+            {
+                const int32 NeighborRoot = CompressRoot(Labels[Neighbor]);
+                Component = Component == INDEX_NONE ? NeighborRoot : Union(Component, NeighborRoot);
+            }
+        }
+        Labels[Index] = Component != INDEX_NONE ? Component : AddComponent();
+        return;
+    }
+
+    // Walk the six neighbors around the tile. Neighbors in consecutive directions touch each other, so each
+    // unbroken arc of open neighbors is certainly still connected; only separate arcs might have been split.
+    Labels[Index] = INDEX_NONE;
+    const TArrayView<const int32> Ring = Nodes->GetNeighbors(Index);
+    auto IsOpen = [this](int32 Neighbor)
+    {
+        return Neighbor != INDEX_NONE && Labels[Neighbor] != INDEX_NONE;
+    };
+
+    int32 Seeds[FGridNodeStore::NumDirections];
+    int32 NumSeeds = 0;
+    int32 NumOpen = 0;
+    for (int32 Direction = 0; Direction < FGridNodeStore::NumDirections; Direction++)
+    {
+        const int32 Neighbor = Ring[Direction];
+        const int32 Previous = Ring[(Direction + FGridNodeStore::NumDirections - 1) % FGridNodeStore::NumDirections];
+        if (IsOpen(Neighbor))
+        {
+            NumOpen++;
+            if (!IsOpen(Previous))
+            {
+                Seeds[NumSeeds++] = Neighbor;
+            }
+        }
+    }
+
+    if (NumOpen == 0)
+    {
+        // The tile was a region of its own, which is gone now
+        NumComponents--;
+    }
+    else if (NumSeeds > 1)
+    {
+        SplitAround(MakeArrayView(Seeds, FMath::Min(NumSeeds, MaxArcs)));
+    }
+}
+
+void FConnectedComponents::NotifyAllChanged()
+{
+    if (Nodes)
+    {
+        bNeedsRebuild = true;
+    }
+}
+
+void FConnectedComponents::Update()
+{
+    if (Nodes && bNeedsRebuild)
+    {
+        Build(*Nodes);
+    }
+}
+
+bool FConnectedComponents::AreConnected(int32 StartIndex, int32 GoalIndex) const
+{
+    if (!Nodes || !Nodes->IsValidIndex(StartIndex) || !Nodes->IsValidIndex(GoalIndex))
+    {
+        return false;
+    }
+    if (StartIndex == GoalIndex)
+    {
+        return true;
+    }
+
+    const int32 GoalComponent = GetComponent(GoalIndex);
+    if (GoalComponent == INDEX_NONE)
+    {
+        return false;
+    }
+    if (Labels[StartIndex] != INDEX_NONE)
+    {
+        return GetComponent(StartIndex) == GoalComponent;
+    }
+
+    // The search steps off an obstacle start onto any open neighbor
+    for (int32 Neighbor : Nodes->GetNeighbors(StartIndex))
+    {
+        if (Neighbor != INDEX_NONE && GetComponent(Neighbor) == GoalComponent)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int32 FConnectedComponents::GetComponent(int32 Index) const
+{
+    return Labels[Index] != INDEX_NONE ? FindRoot(Labels[Index]) : INDEX_NONE;
+}
+
+SIZE_T FConnectedComponents::GetAllocatedSize() const
+{
+    SIZE_T Size = Labels.GetAllocatedSize() + Parents.GetAllocatedSize() + Sizes.GetAllocatedSize() + VisitStamps.GetAllocatedSize() + VisitOwners.GetAllocatedSize();
+    for (const TArray<int32>& Queue : Queues)
+    {
+        Size += Queue.GetAllocatedSize();
+    }
+    return Size;
+}
+
+int32 FConnectedComponents::FindRoot(int32 Component) const
+{
+    while (Parents[Component] != Component)
+    {
+        Component = Parents[Component];
+    }
+    return Component;
+}
+
+int32 FConnectedComponents::CompressRoot(int32 Component)
+{
+    const int32 Root = FindRoot(Component);
+    while (Parents[Component] != Root)
+    {
+        const int32 Next = Parents[Component];
+        Parents[Component] = Root;
+        Component = Next;
+    }
+    return Root;
+}
+
+int32 FConnectedComponents::AddComponent()
+{
+    NumComponents++;
+    Sizes.Add(1);
+    return Parents.Add(Parents.Num());
+}
+
+int32 FConnectedComponents::Union(int32 ComponentA, int32 ComponentB)
+{
+    int32 RootA = CompressRoot(ComponentA);
+    int32 RootB = CompressRoot(ComponentB);
+    if (RootA == RootB)
+    {
+        return RootA;
+    }
+
+    // Hanging the smaller tree under the larger keeps every chain logarithmic, so FindRoot stays cheap without compressing
+    if (Sizes[RootA] < Sizes[RootB])
+    {
+        Swap(RootA, RootB);
+    }
+    Parents[RootB] = RootA;
+    Sizes[RootA] += Sizes[RootB];
+    NumComponents--;
+    return RootA;
+}
+
+void FConnectedComponents::SplitAround(TArrayView<const int32> Seeds)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FConnectedComponents_SplitAround, PathfindingChannel);
+
+    // Stamps from earlier floods read as unvisited. Zero is never used, so a wrapped counter starts over from clean stamps.
+    if (++VisitGeneration == 0)
+    {
+        FMemory::Memzero(VisitStamps.GetData(), VisitStamps.Num() * sizeof(uint32));
+        VisitGeneration = 1;
+    }
+
+    const int32 NumSeeds = Seeds.Num();
+    bool bGroupDone[MaxArcs] = {};
+    for (int32 Search = 0; Search < NumSeeds; Search++)
+    {
+        Queues[Search].Reset();
+        Queues[Search].Add(Seeds[Search]);
+        Heads[Search] = 0;
+        Groups[Search] = Search;
+        VisitStamps[Seeds[Search]] = VisitGeneration;
+        VisitOwners[Seeds[Search]] = (uint8)Search;
+    }
+    auto FindGroup = [this](int32 Search)
+    {
+        while (Groups[Search] != Search)
+        {
+            Search = Groups[Search];
+        }
+        return Search;
+    };
+
+    // Expand every flood one tile at a time, so the work done is bounded by the smaller pieces. Floods that meet
+    // are in the same piece and merge; a piece whose floods all run dry before meeting the others was cut off.
+    int32 NumActive = NumSeeds;
+    while (NumActive > 1)
+    {
+        for (int32 Search = 0; Search < NumSeeds; Search++)
+        {
+            if (bGroupDone[FindGroup(Search)] || Heads[Search] == Queues[Search].Num())
+            {
+                continue;
+            }
+
+            const int32 Current = Queues[Search][Heads[Search]++];
+            NumVisited++;
+            for (int32 Neighbor : Nodes->GetNeighbors(Current))
+            {
+                if (Neighbor == INDEX_NONE || Labels[Neighbor] == INDEX_NONE)
+                {
+                    continue;
+                }
+                if (VisitStamps[Neighbor] != VisitGeneration)
+                {
+                    VisitStamps[Neighbor] = VisitGeneration;
+                    VisitOwners[Neighbor] = (uint8)Search;
+                    Queues[Search].Add(Neighbor);
+                    continue;
+                }
+
+                const int32 Group = FindGroup(Search);
+                const int32 OtherGroup = FindGroup(VisitOwners[Neighbor]);
+                if (Group != OtherGroup)
+                {
+                    Groups[OtherGroup] = Group;
+                    NumActive--;
+                }
+            }
+        }
+
+        for (int32 Group = 0; Group < NumSeeds && NumActive > 1; Group++)
+        {
+            if (FindGroup(Group) != Group || bGroupDone[Group])
+            {
+                continue;
+            }
+
+            bool bRunDry = true;
+            for (int32 Search = 0; Search < NumSeeds; Search++)
+            {
+                bRunDry &= FindGroup(Search) != Group || Heads[Search] == Queues[Search].Num();
+            }
+            if (!bRunDry)
+            {
+                continue;
+            }
+
+            // The piece is complete and apart from the rest, which keeps the old id
+            bGroupDone[Group] = true;
+            NumActive--;
+            const int32 Component = AddComponent();
+            for (int32 Search = 0; Search < NumSeeds; Search++)
+            {
+                if (FindGroup(Search) == Group)
+                {
+                    for (int32 Tile : Queues[Search])
+                    {
+                        Labels[Tile] = Component;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FGridNodeStore;
+
+/*
+ * Labels every open tile with the connected region of open tiles it belongs to, so whether a path exists between
+ * two tiles is a comparison of two labels instead of a search that floods everything reachable before giving up.
+ *
+ * Labels are kept up to date edit by edit. A tile that opens joins the regions of its open neighbors, which are
+ * merged in a union-find over region ids. A tile that closes can only split its region when its open neighbors
+ * form more than one unbroken arc around it; then one flood per arc runs in lockstep until all but one have met or
+ * run dry, and the ones that ran dry get new ids. The cost is the size of the smaller pieces, or of the detour
+ * around the tile when nothing splits.
+ *
+ * Not thread safe: like the other per-grid search state, it belongs to the game thread.
+ */
+class PATHFINDINGPROJECT_API FConnectedComponents
+{
+public:
+    // Labels the tiles of InNodes. The store has to stay alive until the labels are reset.
+    void Build(const FGridNodeStore& InNodes);
+
+    // Drops the labels, for example because the grid was regenerated
+    void Reset();
+
+    // Whether Build has run since the last reset
+    bool IsBuilt() const { return Nodes != nullptr; }
+
+    // Brings the labels up to date after a tile's obstacle state changed. Weight changes do not matter to them.
+    void NotifyNodeChanged(int32 Index);
+
+    // Queues a relabel of the whole grid, for edits that touch most of it. Single edits are ignored until Update.
+    void NotifyAllChanged();
+
+    // Whether a relabel is waiting for Update
+    bool NeedsUpdate() const { return bNeedsRebuild; }
+
+    // Relabels the grid if NotifyAllChanged was called since the last update
+    void Update();
+
+    /* Whether FGridNodeStore::FindPath would find a path from StartIndex to GoalIndex. Same rules as the search: a
+       tile reaches itself, an obstacle goal is never reached, and a search may leave an obstacle start. */
+    bool AreConnected(int32 StartIndex, int32 GoalIndex) const;
+
+    // Region id of a tile, equal for two tiles exactly when they are connected. INDEX_NONE for obstacles.
+    int32 GetComponent(int32 Index) const;
+
+    // Number of separate regions of open tiles
+    int32 GetNumComponents() const { return NumComponents; }
+
+    // Bytes used by the labels and the edit scratch
+    SIZE_T GetAllocatedSize() const;
+
+    // Number of tiles the last Build or NotifyNodeChanged visited
+    int32 NumVisited = 0;
+
+private:
+    // Largest number of separate arcs the open neighbors of a hex tile can form
+    static constexpr int32 MaxArcs = 3;
+
+    // Root of a region id, without changing anything, so const queries stay const
+    int32 FindRoot(int32 Component) const;
+
+    // Root of a region id, pointing every id on the way straight at it
+    int32 CompressRoot(int32 Component);
+
+    // Adds a new region id of its own
+    int32 AddComponent();
+
+    // Merges two regions, the smaller under the larger, and returns the root of the result
+    int32 Union(int32 ComponentA, int32 ComponentB);
+
+    // Floods from one open tile per arc around a tile that just closed and gives the pieces that were cut off new ids
+    void SplitAround(TArrayView<const int32> Seeds);
+
+    const FGridNodeStore* Nodes = nullptr;
+
+    // Region id of each tile, INDEX_NONE for obstacles. Ids are only meaningful through FindRoot.
+    TArray<int32> Labels;
+
+    // Union-find over region ids: the parent of each id, itself for a root, and the number of ids under each root
+    TArray<int32> Parents;
+    TArray<int32> Sizes;
+
+    int32 NumComponents = 0;
+    bool bNeedsRebuild = false;
+
+    // Flood scratch: the tiles each flood reached, in the order reached, how far each has expanded, which flood it
+    // has merged into, and the flood and query that last reached each tile
+    TArray<int32> Queues[MaxArcs];
+    int32 Heads[MaxArcs] = {};
+    int32 Groups[MaxArcs] = {};
+    TArray<uint32> VisitStamps;
+    TArray<uint8> VisitOwners;
+    uint32 VisitGeneration = 0;
+};
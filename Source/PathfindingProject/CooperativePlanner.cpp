@@ -0,0 +1,510 @@
+#include "CooperativePlanner.h"
+#include "GridNodeStore.h"
+#include "PathfindingStats.h"
+#include "Algo/Reverse.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+void FCooperativePlanner::Initialize(const FGridNodeStore& InNodes, TArrayView<const FCooperativeAgent> InAgents, int32 InWindow, int32 InReplanInterval)
+{
+    // Fields kept from runs on another store are of no use
+    if (Nodes != &InNodes)
+    {
+        Fields.Reset();
+    }
+    Nodes = &InNodes;
+    Agents.Reset();
+    Agents.Append(InAgents.GetData(), InAgents.Num());
+    Window = FMath::Max(InWindow, 1);
+    ReplanInterval = FMath::Clamp(InReplanInterval, 1, Window);
+
+    Time = 0;
+    RoundStart = 0;
+    Round = 0;
+    PlanSeconds = 0.0;
+    HeuristicSeconds = 0.0;
+    NumExpanded = 0;
+    NumFallbacks = 0;
+    WaitCost = FVector::Dist(FGridNodeStore::GetTileLocation(0, 0), FGridNodeStore::GetTileLocation(1, 0));
+
+    const int32 NumAgents = Agents.Num();
+    Positions.SetNumUninitialized(NumAgents);
+    StrandedFlags.Init(false, NumAgents);
+    Trajectories.SetNum(NumAgents);
+    Plans.SetNumUninitialized(NumAgents * (Window + 1));
+    AgentFields.Init(nullptr, NumAgents);
+
+    // Drop the fields no unit of this run heads for, and build or repair the ones they do
+    const double StartTime = FPlatformTime::Seconds();
+    TSet<int32> FieldTiles;
+    for (const FCooperativeAgent& Agent : Agents)
+    {
+        FieldTiles.Add(Nodes->IsValidIndex(Agent.HeuristicTile) ? Agent.HeuristicTile : Agent.GoalIndex);
+    }
+    for (auto It = Fields.CreateIterator(); It; ++It)
+    {
+        if (!FieldTiles.Contains(It->Key))
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    for (int32 Agent = 0; Agent < NumAgents; Agent++)
+    {
+        const FCooperativeAgent& Request = Agents[Agent];
+        const bool bValid = Nodes->IsValidIndex(Request.StartIndex) && Nodes->IsValidIndex(Request.GoalIndex);
+        Positions[Agent] = Nodes->IsValidIndex(Request.StartIndex) ? Request.StartIndex : INDEX_NONE;
+        Trajectories[Agent].Reset();
+        Trajectories[Agent].Add(Positions[Agent]);
+        if (bValid)
+        {
+            AgentFields[Agent] = &GetField(Nodes->IsValidIndex(Request.HeuristicTile) ? Request.HeuristicTile : Request.GoalIndex);
+        }
+
+        // A start that cannot reach the goal at all has no heuristic, and the unit just keeps its tile
+        StrandedFlags[Agent] = !bValid || GetHeuristic(Agent, Request.StartIndex) == TNumericLimits<float>::Max();
+    }
+    HeuristicSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+void FCooperativePlanner::Reset()
+{
+    Nodes = nullptr;
+    Agents.Reset();
+    Positions.Reset();
+    StrandedFlags.Reset();
+    Plans.Reset();
+    Trajectories.Reset();
+    Fields.Reset();
+    AgentFields.Reset();
+    Time = 0;
+    Round = 0;
+}
+
+void FCooperativePlanner::NotifyNodeChanged(int32 Index)
+{
+    for (TPair<int32, TUniquePtr<FFlowField>>& Field : Fields)
+    {
+        Field.Value->NotifyNodeChanged(Index);
+    }
+}
+
+bool FCooperativePlanner::Step()
+{
+    if (!Nodes)
+    {
+        return false;
+    }
+
+    bool bAllArrived = true;
+    for (int32 Agent = 0; Agent < Agents.Num() && bAllArrived; Agent++)
+    {
+        bAllArrived = StrandedFlags[Agent] || HasArrived(Agent);
+    }
+    if (bAllArrived)
+    {
+        return false;
+    }
+
+    if (Round == 0 || Time - RoundStart >= ReplanInterval)
+    {
+        PlanRound();
+    }
+
+    const int32 PlanStep = Time - RoundStart + 1;
+    for (int32 Agent = 0; Agent < Agents.Num(); Agent++)
+    {
+        Positions[Agent] = Plans[Agent * (Window + 1) + PlanStep];
+        Trajectories[Agent].Add(Positions[Agent]);
+    }
+    Time++;
+    return true;
+}
+
+int32 FCooperativePlanner::Run(int32 MaxSteps)
+{
+    int32 NumSteps = 0;
+    while (NumSteps < MaxSteps && Step())
+    {
+        NumSteps++;
+    }
+    return NumSteps;
+}
+
+int32 FCooperativePlanner::CountCollisions(const TArray<TArray<int32>>& InTrajectories, int32 NumTiles)
+{
+    int32 NumSteps = 0;
+    for (const TArray<int32>& Trajectory : InTrajectories)
+    {
+        NumSteps = FMath::Max(NumSteps, Trajectory.Num());
+    }
+    auto GetTile = [&InTrajectories](int32 Agent, int32 Step)
+    {
+        const TArray<int32>& Trajectory = InTrajectories[Agent];
+        return Trajectory.Num() > 0 ? Trajectory[FMath::Min(Step, Trajectory.Num() - 1)] : INDEX_NONE;
+    };
+
+    // Unit standing on each tile at the current step, and the tiles to clear again afterwards
+    TArray<int32> Occupants;
+    Occupants.Init(INDEX_NONE, NumTiles);
+    TArray<int32> OccupiedTiles;
+
+    int32 NumCollisions = 0;
+    for (int32 Step = 0; Step < NumSteps; Step++)
+    {
+        OccupiedTiles.Reset();
+        for (int32 Agent = 0; Agent < InTrajectories.Num(); Agent++)
+        {
+            const int32 Tile = GetTile(Agent, Step);
+            if (Tile == INDEX_NONE)
+            {
+                continue;
+            }
+            if (Occupants[Tile] != INDEX_NONE)
+            {
+                NumCollisions++;
+                continue;
+            }
+            Occupants[Tile] = Agent;
+            OccupiedTiles.Add(Tile);
+        }
+
+        // A unit now standing where another came from, that went where this one came from, passed through it
+        for (int32 Agent = 0; Step > 0 && Agent < InTrajectories.Num(); Agent++)
+        {
+            const int32 From = GetTile(Agent, Step - 1);
+            const int32 To = GetTile(Agent, Step);
+            if (From == To || From == INDEX_NONE || To == INDEX_NONE)
+            {
+                continue;
+            }
+            const int32 Other = Occupants[From];
+            if (Other != INDEX_NONE && Other > Agent && GetTile(Other, Step - 1) == To)
+            {
+                NumCollisions++;
+            }
+        }
+
+        for (int32 Tile : OccupiedTiles)
+        {
+            Occupants[Tile] = INDEX_NONE;
+        }
+    }
+    return NumCollisions;
+}
+
+void FCooperativePlanner::PlanRound()
+{
+    SCOPE_CYCLE_COUNTER(STAT_PathfindingSearch);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FCooperativePlanner_PlanRound, PathfindingChannel);
+    const double StartTime = FPlatformTime::Seconds();
+    RoundStart = Time;
+    Round++;
+
+    // Units still on their way plan first, in an order shuffled every round so none of them is always last to
+    // pick. Units that have arrived or cannot move plan last, so they are the ones that make way.
+    Order.Reset(Agents.Num());
+    for (int32 Agent = 0; Agent < Agents.Num(); Agent++)
+    {
+        if (!StrandedFlags[Agent] && !HasArrived(Agent))
+        {
+            Order.Add(Agent);
+        }
+    }
+    const int32 NumMoving = Order.Num();
+    FRandomStream Random(Round);
+    for (int32 i = NumMoving - 1; i > 0; i--)
+    {
+        Order.Swap(i, Random.RandRange(0, i));
+    }
+    for (int32 Agent = 0; Agent < Agents.Num(); Agent++)
+    {
+        if (StrandedFlags[Agent] || HasArrived(Agent))
+        {
+            Order.Add(Agent);
+        }
+    }
+
+    // Every unit holds its own tile at the first step, before anyone has planned
+    Reservations.Reset(Agents.Num() * (Window + 1));
+    for (int32 Agent = 0; Agent < Agents.Num(); Agent++)
+    {
+        if (Positions[Agent] != INDEX_NONE)
+        {
+            Reservations.Add(Positions[Agent], 0, Agent);
+        }
+    }
+
+    for (int32 Agent : Order)
+    {
+        PlanAgent(Agent);
+    }
+
+    PlanSeconds += FPlatformTime::Seconds() - StartTime;
+    UE_LOG(LogPathfinding, Verbose, TEXT("FCooperativePlanner: round %d at step %d planned %d units (%d moving)"), Round, Time, Agents.Num(), NumMoving);
+}
+
+void FCooperativePlanner::PlanAgent(int32 Agent)
+{
+    int32* Plan = Plans.GetData() + Agent * (Window + 1);
+    const int32 StartTile = Positions[Agent];
+    if (StrandedFlags[Agent])
+    {
+        for (int32 PlanStep = 0; PlanStep <= Window; PlanStep++)
+        {
+            Plan[PlanStep] = StartTile;
+            if (StartTile != INDEX_NONE)
+            {
+                Reservations.Add(StartTile, PlanStep, Agent);
+            }
+        }
+        return;
+    }
+
+    const int32 GoalTile = Agents[Agent].GoalIndex;
+    auto IsBetterState = [this](int32 A, int32 B)
+    {
+        // Among equally good states, prefer the one further along in time, like A* prefers the one nearer the goal
+        return States[A].FCost < States[B].FCost || (States[A].FCost == States[B].FCost && States[A].Step > States[B].Step);
+    };
+
+    // Whether the unit can stay on its goal from a step to the end of the window
+    auto CanStayOnGoal = [this, Agent, GoalTile](int32 FromStep)
+    {
+        for (int32 PlanStep = FromStep + 1; PlanStep <= Window; PlanStep++)
+        {
+            const int32 Holder = Reservations.Find(GoalTile, PlanStep);
+            if (Holder != INDEX_NONE && Holder != Agent)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Every expansion adds at most one state per neighbor and one for waiting
+    const int32 MaxStates = 1 + MaxExpansions * (FGridNodeStore::NumDirections + 1);
+    States.Reset();
+    StateLookup.Reset(MaxStates);
+    OpenSet.Reserve(MaxStates);
+    OpenSet.Clear();
+
+    States.Add({ StartTile, 0, INDEX_NONE, 0.0f, GetHeuristic(Agent, StartTile), false });
+    StateLookup.Add(StartTile, 0, 0);
+    OpenSet.Push(0, IsBetterState);
+
+    int32 Found = INDEX_NONE;
+    int32 Best = 0;
+    int32 NumExpansions = 0;
+    while (!OpenSet.IsEmpty() && NumExpansions < MaxExpansions)
+    {
+        const int32 Current = OpenSet.Pop(IsBetterState);
+        States[Current].bClosed = true;
+        NumExpansions++;
+
+        // The state is copied, since adding successors can move the array
+        const FSearchState State = States[Current];
+        if (State.Step > States[Best].Step || (State.Step == States[Best].Step && State.FCost < States[Best].FCost))
+        {
+            Best = Current;
+        }
+
+        // Done at the end of the window, or on the goal if nobody needs it for the rest of the window
+        if (State.Step == Window || (State.Tile == GoalTile && CanStayOnGoal(State.Step)))
+        {
+            Found = Current;
+            break;
+        }
+
+        // Waiting is direction -1, on any tile including an obstacle start, which can still be left
+        const int32 NextStep = State.Step + 1;
+        for (int32 Direction = -1; Direction < FGridNodeStore::NumDirections; Direction++)
+        {
+            const int32 Next = Direction < 0 ? State.Tile : Nodes->GetNeighbor(State.Tile, Direction);
+            if (Next == INDEX_NONE || (Direction >= 0 && Nodes->Obstacles[Next]) || IsBlocked(Agent, State.Tile, Next, NextStep))
+            {
+                continue;
+            }
+            const float HCost = GetHeuristic(Agent, Next);
+            if (HCost == TNumericLimits<float>::Max())
+            {
+                continue;
+            }
+
+            // Moving is charged like FindPath; waiting costs one plain step, except on the goal, where it is free
+            const float StepCost = Direction >= 0 ? FVector::Dist(Nodes->Positions[State.Tile], Nodes->Positions[Next]) * Nodes->Weights[Next]
+                : Next == GoalTile ? 0.0f : WaitCost;
+            const float GCost = State.GCost + StepCost;
+
+            const int32 NextState = StateLookup.Find(Next, NextStep);
+            if (NextState == INDEX_NONE)
+            {
+                const int32 Added = States.Add({ Next, NextStep, Current, GCost, GCost + HCost, false });
+                StateLookup.Add(Next, NextStep, Added);
+                OpenSet.Push(Added, IsBetterState);
+            }
+            else if (!States[NextState].bClosed && GCost < States[NextState].GCost)
+            {
+                States[NextState].GCost = GCost;
+                States[NextState].FCost = GCost + HCost;
+                States[NextState].Parent = Current;
+                OpenSet.DecreaseKey(NextState, IsBetterState);
+            }
+        }
+    }
+    NumExpanded += NumExpansions;
+
+    // Out of budget or boxed in: follow the furthest partial plan and wait at its end
+    if (Found == INDEX_NONE)
+    {
+        NumFallbacks++;
+        Found = Best;
+    }
+
+    PlanScratch.Reset();
+    for (int32 StateIndex = Found; StateIndex != INDEX_NONE; StateIndex = States[StateIndex].Parent)
+    {
+        PlanScratch.Add(States[StateIndex].Tile);
+    }
+    Algo::Reverse(PlanScratch);
+    for (int32 PlanStep = 0; PlanStep <= Window; PlanStep++)
+    {
+        Plan[PlanStep] = PlanScratch[FMath::Min(PlanStep, PlanScratch.Num() - 1)];
+        Reservations.Add(Plan[PlanStep], PlanStep, Agent);
+    }
+}
+
+float FCooperativePlanner::GetHeuristic(int32 Agent, int32 Tile) const
+{
+    const int32 GoalTile = Agents[Agent].GoalIndex;
+    const float Straight = FVector::Dist(Nodes->Positions[Tile], Nodes->Positions[GoalTile]);
+    const FFlowField* Field = AgentFields[Agent];
+    if (!Field)
+    {
+        return Straight;
+    }
+
+    // The field gives the cost to its own tile. Going there through the goal costs no less than going there
+    // directly, so the difference of the two is a lower bound on the cost to the goal, and exact when they coincide.
+    const float GoalDistance = Field->GetDistance(GoalTile);
+    if (GoalDistance == TNumericLimits<float>::Max())
+    {
+        return Straight;
+    }
+    const float Distance = Field->GetDistance(Tile);
+    if (Distance == TNumericLimits<float>::Max())
+    {
+        return TNumericLimits<float>::Max();
+    }
+    return FMath::Max(Straight, Distance - GoalDistance);
+}
+
+bool FCooperativePlanner::IsBlocked(int32 Agent, int32 From, int32 Tile, int32 Step) const
+{
+    const int32 Holder = Reservations.Find(Tile, Step);
+    if (Holder != INDEX_NONE && Holder != Agent)
+    {
+        return true;
+    }
+
+    // A unit going from Tile to From during the same step would pass through this one
+    if (From != Tile)
+    {
+        const int32 Oncoming = Reservations.Find(From, Step);
+        return Oncoming != INDEX_NONE && Oncoming != Agent && Reservations.Find(Tile, Step - 1) == Oncoming;
+    }
+    return false;
+}
+
+const FFlowField& FCooperativePlanner::GetField(int32 Tile)
+{
+    TUniquePtr<FFlowField>& Field = Fields.FindOrAdd(Tile);
+    if (!Field)
+    {
+        Field = MakeUnique<FFlowField>();
+    }
+    if (Field->IsBuilt())
+    {
+        Field->Update();
+    }
+    if (!Field->IsBuilt())
+    {
+        Field->Build(*Nodes, Tile);
+    }
+    return *Field;
+}
+
+void FCooperativePlanner::FSpaceTimeTable::Reset(int32 ExpectedEntries)
+{
+    for (int32 Slot : UsedSlots)
+    {
+        Keys[Slot] = EmptyKey;
+    }
+    UsedSlots.Reset();
+
+    const int32 NumSlots = (int32)FMath::RoundUpToPowerOfTwo((uint32)FMath::Max(ExpectedEntries * 2, 16));
+    if (Keys.Num() < NumSlots)
+    {
+        Keys.Init(EmptyKey, NumSlots);
+        Values.SetNumUninitialized(NumSlots);
+    }
+}
+
+void FCooperativePlanner::FSpaceTimeTable::Add(int32 Tile, int32 Step, int32 Value)
+{
+    if (Keys.Num() == 0 || (UsedSlots.Num() + 1) * 2 > Keys.Num())
+    {
+        Grow();
+    }
+    const uint64 Key = MakeKey(Tile, Step);
+    const int32 Slot = FindSlot(Key);
+    if (Keys[Slot] == EmptyKey)
+    {
+        Keys[Slot] = Key;
+        Values[Slot] = Value;
+        UsedSlots.Add(Slot);
+    }
+}
+
+int32 FCooperativePlanner::FSpaceTimeTable::Find(int32 Tile, int32 Step) const
+{
+    if (Keys.Num() == 0)
+    {
+        return INDEX_NONE;
+    }
+    const int32 Slot = FindSlot(MakeKey(Tile, Step));
+    return Keys[Slot] != EmptyKey ? Values[Slot] : INDEX_NONE;
+}
+
+int32 FCooperativePlanner::FSpaceTimeTable::FindSlot(uint64 Key) const
+{
+    // Fibonacci hashing spreads neighboring tiles and steps over the table; collisions probe the next slots
+    const int32 Mask = Keys.Num() - 1;
+    int32 Slot = (int32)((Key * 0x9E3779B97F4A7C15ull) >> 32) & Mask;
+    while (Keys[Slot] != EmptyKey && Keys[Slot] != Key)
+    {
+        Slot = (Slot + 1) & Mask;
+    }
+    return Slot;
+}
+
+void FCooperativePlanner::FSpaceTimeTable::Grow()
+{
+    TArray<uint64> OldKeys;
+    TArray<int32> OldValues;
+    TArray<int32> OldSlots;
+    Swap(OldKeys, Keys);
+    Swap(OldValues, Values);
+    Swap(OldSlots, UsedSlots);
+
+    const int32 NumSlots = FMath::Max(OldKeys.Num() * 2, 16);
+    Keys.Init(EmptyKey, NumSlots);
+    Values.SetNumUninitialized(NumSlots);
+    for (int32 OldSlot : OldSlots)
+    {
+        const int32 Slot = FindSlot(OldKeys[OldSlot]);
+        Keys[Slot] = OldKeys[OldSlot];
+        Values[Slot] = OldValues[OldSlot];
+        UsedSlots.Add(Slot);
+    }
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IndexedNodeHeap.h"
+#include "FlowField.h"
+
+struct FGridNodeStore;
+
+// One unit moved by FCooperativePlanner
+struct FCooperativeAgent
+{
+    int32 StartIndex = INDEX_NONE;
+    int32 GoalIndex = INDEX_NONE;
+
+    // Tile whose distance field guides the search. Units heading to the same area can share one tile, so they share
+    // one field too; it should be in the same region as the goal. The goal itself when INDEX_NONE.
+    int32 HeuristicTile = INDEX_NONE;
+};
+
+/*
+ * Moves many units over the grid at once without running into each other, with windowed hierarchical cooperative
+ * A* (WHCA*). Time advances in steps in which every unit moves to a neighbor or waits. Every ReplanInterval steps,
+ * the units plan the next Window steps one after another in a priority order that changes each round, and every
+ * plan reserves the tiles it uses at each step, which the later units steer around. Units that have arrived stay
+ * on their goal but still take part, and step aside when a unit with priority has to pass.
+ *
+ * Each unit's search runs over tiles and time, so it can wait for a tile to clear. Its heuristic is the true path
+ * cost from a distance field (FFlowField) towards the unit's heuristic tile, which one backward Dijkstra pass gives
+ * for every unit heading that way; fields are kept between runs and repaired after tile edits. A search expands at
+ * most MaxExpansions states, so the planning cost of a round grows linearly with the number of units. A unit whose
+ * search runs out of budget or finds itself boxed in follows its best partial plan, and may then collide.
+ *
+ * Reservations live in an open-addressing hash of (tile, step) keys that is cleared each round, so its size
+ * follows the number of units times the window and not the size of the grid.
+ */
+class PATHFINDINGPROJECT_API FCooperativePlanner
+{
+public:
+    // Starts a run of Agents over the tiles of InNodes, which have to stay alive and unchanged until it finishes.
+    // Window is the number of steps each plan looks ahead; plans are redone every ReplanInterval steps.
+    void Initialize(const FGridNodeStore& InNodes, TArrayView<const FCooperativeAgent> InAgents, int32 InWindow = 16, int32 InReplanInterval = 8);
+
+    // Drops the run and the distance fields, for example because the grid was regenerated
+    void Reset();
+
+    // Passes a tile edit on to the kept distance fields, which are repaired when the next run needs them
+    void NotifyNodeChanged(int32 Index);
+
+    // Moves every unit one step, planning a new round first when the current one is used up. False once every unit
+    // that can reach its goal is standing on it.
+    bool Step();
+
+    // Steps until every unit that can has arrived, or MaxSteps have passed. Returns the number of steps taken.
+    int32 Run(int32 MaxSteps);
+
+    // Tile of every unit at every step so far, starting with its start tile
+    const TArray<TArray<int32>>& GetTrajectories() const { return Trajectories; }
+
+    // Whether the unit stands on its goal now
+    bool HasArrived(int32 Agent) const { return Positions[Agent] != INDEX_NONE && Positions[Agent] == Agents[Agent].GoalIndex; }
+
+    // Whether the unit's goal cannot be reached from its start at all, so it stays where it is
+    bool IsStranded(int32 Agent) const { return StrandedFlags[Agent]; }
+
+    int32 GetNumAgents() const { return Agents.Num(); }
+    int32 GetNumSteps() const { return Time; }
+
+    /* Counts the times two units stand on the same tile at the same step, or swap tiles during one step, with every
+       unit staying on its last tile once its trajectory ends. Works on any trajectories, such as independent paths. */
+    static int32 CountCollisions(const TArray<TArray<int32>>& InTrajectories, int32 NumTiles);
+
+    // Most states one unit's search may expand in a round
+    int32 MaxExpansions = 1024;
+
+    // Time spent planning and building distance fields since Initialize, in seconds
+    double PlanSeconds = 0.0;
+    double HeuristicSeconds = 0.0;
+
+    // States expanded and searches that ended without a complete plan, since Initialize
+    int64 NumExpanded = 0;
+    int32 NumFallbacks = 0;
+
+private:
+    // Space-time state of a unit's search
+    struct FSearchState
+    {
+        int32 Tile;
+        int32 Step;
+        int32 Parent;
+        float GCost;
+        float FCost;
+        bool bClosed;
+    };
+
+    // Open-addressing hash from (tile, step) to the unit holding it, or to a search state
+    struct FSpaceTimeTable
+    {
+        // Empties the table and makes room for ExpectedEntries. Only the slots in use are cleared.
+        void Reset(int32 ExpectedEntries);
+
+        // Stores Value for the tile and step, unless something is stored there already
+        void Add(int32 Tile, int32 Step, int32 Value);
+
+        // Value stored for the tile and step, or INDEX_NONE
+        int32 Find(int32 Tile, int32 Step) const;
+
+        SIZE_T GetAllocatedSize() const { return Keys.GetAllocatedSize() + Values.GetAllocatedSize() + UsedSlots.GetAllocatedSize(); }
+
+    private:
+        static uint64 MakeKey(int32 Tile, int32 Step) { return ((uint64)(uint32)Step << 32) | (uint32)Tile; }
+
+        // Empty slots hold EmptyKey; the table is a power of two in size and at most half full
+        static constexpr uint64 EmptyKey = MAX_uint64;
+        TArray<uint64> Keys;
+        TArray<int32> Values;
+
+        // Slots holding an entry, so clearing costs as much as the entries and not the table
+        TArray<int32> UsedSlots;
+
+        // Slot of a key: where it is stored, or the empty slot it would go in
+        int32 FindSlot(uint64 Key) const;
+
+        // Doubles the table and puts every entry back
+        void Grow();
+    };
+
+    // Plans the next Window steps of every unit, in a new priority order
+    void PlanRound();
+
+    // Searches the next Window steps of one unit around the reservations, and reserves the plan it settles on
+    void PlanAgent(int32 Agent);
+
+    // Lower bound on the cost from Tile to the unit's goal
+    float GetHeuristic(int32 Agent, int32 Tile) const;
+
+    // Whether another unit holds Tile at the given step, or is moving the other way between From and Tile
+    bool IsBlocked(int32 Agent, int32 From, int32 Tile, int32 Step) const;
+
+    // Distance field towards a tile, built on first use and repaired after edits
+    const FFlowField& GetField(int32 Tile);
+
+    const FGridNodeStore* Nodes = nullptr;
+    TArray<FCooperativeAgent> Agents;
+    int32 Window = 16;
+    int32 ReplanInterval = 8;
+
+    // Current step, the step the current round was planned at, and where every unit is now
+    int32 Time = 0;
+    int32 RoundStart = 0;
+    int32 Round = 0;
+    TArray<int32> Positions;
+    TBitArray<> StrandedFlags;
+
+    // Planned tile of every unit for each step of the round, Window + 1 per unit, the first being where it was
+    TArray<int32> Plans;
+    TArray<TArray<int32>> Trajectories;
+
+    // Units in the order they plan this round
+    TArray<int32> Order;
+
+    FSpaceTimeTable Reservations;
+
+    // Distance fields by tile, shared by every unit heading there, and the field each unit uses
+    TMap<int32, TUniquePtr<FFlowField>> Fields;
+    TArray<const FFlowField*> AgentFields;
+
+    // Cost of waiting a step anywhere but on the goal: one step onto a tile of weight one
+    float WaitCost = 0.0f;
+
+    // Scratch for a unit's search
+    TArray<FSearchState> States;
+    FSpaceTimeTable StateLookup;
+    FIndexedNodeHeap OpenSet;
+    TArray<int32> PlanScratch;
+};
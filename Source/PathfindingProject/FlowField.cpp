@@ -0,0 +1,260 @@
+#include "FlowField.h"
+#include "GridNodeStore.h"
+#include "Algo/Reverse.h"
+
+// Distance of tiles that cannot reach the goal
+static constexpr float UnreachableDistance = TNumericLimits<float>::Max();
+
+static int32 GetOppositeDirection(int32 Direction)
+{
+    return (Direction + FGridNodeStore::NumDirections / 2) % FGridNodeStore::NumDirections;
+}
+
+void FFlowField::Build(const FGridNodeStore& InNodes, int32 InGoalIndex)
+{
+    Initialize(InNodes, InGoalIndex, false);
+}
+
+void FFlowField::BuildFromSource(const FGridNodeStore& InNodes, int32 SourceIndex)
+{
+    Initialize(InNodes, SourceIndex, true);
+}
+
+void FFlowField::Initialize(const FGridNodeStore& InNodes, int32 InGoalIndex, bool bInFromSource)
+{
+    Reset();
+    if (!InNodes.IsValidIndex(InGoalIndex))
+    {
+        return;
+    }
+
+    Nodes = &InNodes;
+    GoalIndex = InGoalIndex;
+    bFromSource = bInFromSource;
+
+    const int32 NumNodes = Nodes->Num();
+    Distances.Init(UnreachableDistance, NumNodes);
+    Directions.Init(NoDirection, NumNodes);
+    ChangedFlags.Init(false, NumNodes);
+    OpenSet.Reserve(NumNodes);
+
+    // An obstacle goal cannot be entered, so it only reaches itself, the same as a FindPath query from the goal to
+    // itself. An obstacle source can still be left, like the start of a FindPath query.
+    Relax(GoalIndex, 0.0f, NoDirection);
+    Propagate();
+}
+
+void FFlowField::Reset()
+{
+    Nodes = nullptr;
+    GoalIndex = INDEX_NONE;
+    bFromSource = false;
+    OpenSet.Clear();
+    ChangedNodes.Reset();
+    bNeedsRebuild = false;
+    NumExpanded = 0;
+}
+
+void FFlowField::NotifyNodeChanged(int32 Index)
+{
+    if (Nodes && Nodes->IsValidIndex(Index) && !ChangedFlags[Index])
+    {
+        ChangedFlags[Index] = true;
+        ChangedNodes.Add(Index);
+    }
+}
+
+void FFlowField::NotifyAllChanged()
+{
+    bNeedsRebuild = Nodes != nullptr;
+}
+
+void FFlowField::Update()
+{
+    if (!NeedsUpdate())
+    {
+        return;
+    }
+
+    // Past a certain number of edits the repairs overlap so much that a clean pass is cheaper. An edit of the
+    // goal itself changes where every path ends, so that one always rebuilds too.
+    if (bNeedsRebuild || ChangedFlags[GoalIndex] || ChangedNodes.Num() > Nodes->Num() / 8)
+    {
+        Initialize(*Nodes, GoalIndex, bFromSource);
+        return;
+    }
+
+    NumExpanded = 0;
+
+    // Edits only change the cost of stepping onto the edited tiles. Towards a goal, that is the step from a
+    // neighbor onto the edited tile; from a source, it is the step that reached the edited tile itself. Every
+    // tile whose cheapest path took such a step loses its distance, along with every tile whose path ran
+    // through those, all the way down the tree.
+    OrphanedNodes.Reset();
+    auto Orphan = [this](int32 Index)
+    {
+        Distances[Index] = UnreachableDistance;
+        Directions[Index] = NoDirection;
+        OrphanedNodes.Add(Index);
+    };
+    auto OrphanChildren = [this, &Orphan](int32 Parent)
+    {
+        for (int32 Direction = 0; Direction < FGridNodeStore::NumDirections; Direction++)
+        {
+            const int32 Child = Nodes->GetNeighbor(Parent, Direction);
+            if (Child != INDEX_NONE && Directions[Child] == GetOppositeDirection(Direction))
+            {
+                Orphan(Child);
+            }
+        }
+    };
+    for (int32 ChangedNode : ChangedNodes)
+    {
+        if (bFromSource)
+        {
+            Orphan(ChangedNode);
+        }
+        else
+        {
+            OrphanChildren(ChangedNode);
+        }
+    }
+    for (int32 i = 0; i < OrphanedNodes.Num(); i++)
+    {
+        OrphanChildren(OrphanedNodes[i]);
+    }
+
+    // Orphans take the best offer from the neighbors that kept their distance...
+    for (int32 OrphanedNode : OrphanedNodes)
+    {
+        for (int32 Direction = 0; Direction < FGridNodeStore::NumDirections; Direction++)
+        {
+            RelaxThrough(OrphanedNode, Direction);
+        }
+    }
+
+    // ...and an edited tile that got cheaper, or stopped being an obstacle, may now be the better way for its neighbors
+    for (int32 ChangedNode : ChangedNodes)
+    {
+        for (int32 Direction = 0; Direction < FGridNodeStore::NumDirections; Direction++)
+        {
+            const int32 Neighbor = Nodes->GetNeighbor(ChangedNode, Direction);
+            if (Neighbor != INDEX_NONE)
+            {
+                RelaxThrough(Neighbor, GetOppositeDirection(Direction));
+            }
+        }
+        ChangedFlags[ChangedNode] = false;
+    }
+    ChangedNodes.Reset();
+
+    Propagate();
+}
+
+int32 FFlowField::GetNextNode(int32 Index) const
+{
+    const uint8 Direction = Directions[Index];
+    return Direction == NoDirection ? INDEX_NONE : Nodes->GetNeighbor(Index, Direction);
+}
+
+bool FFlowField::GetPath(int32 StartIndex, TArray<int32>& OutPath) const
+{
+    OutPath.Reset();
+    if (!Nodes || !Nodes->IsValidIndex(StartIndex) || Distances[StartIndex] == UnreachableDistance)
+    {
+        return false;
+    }
+
+    // Distances strictly drop along the way, so the walk cannot loop; the step limit only guards against a corrupted field
+    OutPath.Add(StartIndex);
+    for (int32 Current = StartIndex; Current != GoalIndex;)
+    {
+        Current = GetNextNode(Current);
+        if (Current == INDEX_NONE || OutPath.Num() > Nodes->Num())
+        {
+            OutPath.Reset();
+            return false;
+        }
+        OutPath.Add(Current);
+    }
+
+    // A field from a source was walked back to the source
+    if (bFromSource)
+    {
+        Algo::Reverse(OutPath);
+    }
+    return true;
+}
+
+SIZE_T FFlowField::GetAllocatedSize() const
+{
+    return Distances.GetAllocatedSize() + Directions.GetAllocatedSize() + OpenSet.GetAllocatedSize()
+        + ChangedNodes.GetAllocatedSize() + ChangedFlags.GetAllocatedSize() + OrphanedNodes.GetAllocatedSize();
+}
+
+void FFlowField::Propagate()
+{
+    auto IsCloser = [this](int32 A, int32 B)
+    {
+        return Distances[A] < Distances[B];
+    };
+
+    while (!OpenSet.IsEmpty())
+    {
+        const int32 Current = OpenSet.Pop(IsCloser);
+        NumExpanded++;
+
+        for (int32 Direction = 0; Direction < FGridNodeStore::NumDirections; Direction++)
+        {
+            const int32 Neighbor = Nodes->GetNeighbor(Current, Direction);
+            if (Neighbor != INDEX_NONE)
+            {
+                RelaxThrough(Neighbor, GetOppositeDirection(Direction));
+            }
+        }
+    }
+}
+
+void FFlowField::RelaxThrough(int32 Index, int32 Direction)
+{
+    const int32 Neighbor = Nodes->GetNeighbor(Index, Direction);
+    if (Neighbor == INDEX_NONE || Distances[Neighbor] == UnreachableDistance)
+    {
+        return;
+    }
+
+    // A path may start on an obstacle but never step onto one. Towards a goal, Index steps onto the neighbor;
+    // from a source, the neighbor steps onto Index. Either way the step costs the weight of the tile stepped onto.
+    const int32 SteppedOnto = bFromSource ? Index : Neighbor;
+    if (Nodes->Obstacles[SteppedOnto])
+    {
+        return;
+    }
+
+    const float StepCost = FVector::Dist(Nodes->Positions[Index], Nodes->Positions[Neighbor]) * Nodes->Weights[SteppedOnto];
+    Relax(Index, Distances[Neighbor] + StepCost, (uint8)Direction);
+}
+
+void FFlowField::Relax(int32 Index, float Distance, uint8 Direction)
+{
+    if (Distance >= Distances[Index])
+    {
+        return;
+    }
+
+    auto IsCloser = [this](int32 A, int32 B)
+    {
+        return Distances[A] < Distances[B];
+    };
+
+    Distances[Index] = Distance;
+    Directions[Index] = Direction;
+    if (OpenSet.Contains(Index))
+    {
+        OpenSet.DecreaseKey(Index, IsCloser);
+    }
+    else
+    {
+        OpenSet.Push(Index, IsCloser);
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IndexedNodeHeap.h"
+
+struct FGridNodeStore;
+
+/*
+ * Cost to reach one goal from every tile of the grid, and the direction of the first step of a cheapest path.
+ * One backward Dijkstra pass from the goal fills both, after which any number of units heading to that goal
+ * read their next step in O(1) instead of running a search each. Steps are charged like FGridNodeStore::FindPath,
+ * so following the field costs the same as the path A* would find.
+ *
+ * A field can also be built the other way around, from a source tile outwards: then it holds the cost of the
+ * cheapest path from the source to every tile, and each tile's direction points back towards the source.
+ *
+ * Tile edits are queued and repaired by the next Update: only the tiles whose cheapest path ran through an
+ * edited tile are recomputed, plus whatever an edit made cheaper.
+ */
+class PATHFINDINGPROJECT_API FFlowField
+{
+public:
+    // Direction of tiles without a next step: the goal, and tiles that cannot reach it
+    static constexpr uint8 NoDirection = 0xFF;
+
+    // Computes the field towards GoalIndex. The store has to stay alive until the field is reset.
+    void Build(const FGridNodeStore& InNodes, int32 InGoalIndex);
+
+    // Computes the field outwards from SourceIndex instead. GetGoalIndex then returns the source.
+    void BuildFromSource(const FGridNodeStore& InNodes, int32 SourceIndex);
+
+    // Drops the field, for example because the grid was regenerated
+    void Reset();
+
+    // Whether Build has run since the last reset
+    bool IsBuilt() const { return Nodes != nullptr; }
+
+    int32 GetGoalIndex() const { return GoalIndex; }
+
+    // Whether the field was built outwards from its tile rather than towards it
+    bool IsFromSource() const { return bFromSource; }
+
+    // Queues a tile whose weight or obstacle state changed. The field is not repaired until Update.
+    void NotifyNodeChanged(int32 Index);
+
+    // Queues a rebuild of the whole field, for edits that touch most of the grid
+    void NotifyAllChanged();
+
+    // Whether edits are waiting for Update
+    bool NeedsUpdate() const { return bNeedsRebuild || ChangedNodes.Num() > 0; }
+
+    // Repairs the field after the queued edits, or rebuilds it when that is cheaper
+    void Update();
+
+    // Cost of the cheapest path from the tile to the goal (or from the source to the tile), the max float if there is none
+    float GetDistance(int32 Index) const { return Distances[Index]; }
+
+    // Direction of the tile's first step towards the goal (or its last step back towards the source, see
+    // FGridNodeStore::NumDirections), or NoDirection
+    uint8 GetDirection(int32 Index) const { return Directions[Index]; }
+
+    // Tile to step onto next from Index, or INDEX_NONE at the goal and on tiles that cannot reach it
+    int32 GetNextNode(int32 Index) const;
+
+    // Follows the field from StartIndex to the goal. Same contract as FGridNodeStore::FindPath. For a field
+    // built from a source, returns the path from the source to StartIndex instead.
+    bool GetPath(int32 StartIndex, TArray<int32>& OutPath) const;
+
+    // Bytes used by the field, including its repair scratch
+    SIZE_T GetAllocatedSize() const;
+
+    // Number of tiles the last Build or Update settled
+    int32 NumExpanded = 0;
+
+private:
+    // Settles queued tiles in order of distance and passes improvements on to their neighbors
+    void Propagate();
+
+    // Offers a tile a cost and first step, queueing it if that beats what it has
+    void Relax(int32 Index, float Distance, uint8 Direction);
+
+    // Offers Index the way through its neighbor in Direction, if that neighbor has a distance and the step is allowed
+    void RelaxThrough(int32 Index, int32 Direction);
+
+    // Computes every distance from scratch
+    void Initialize(const FGridNodeStore& InNodes, int32 InGoalIndex, bool bInFromSource);
+
+    const FGridNodeStore* Nodes = nullptr;
+    int32 GoalIndex = INDEX_NONE;
+    bool bFromSource = false;
+
+    TArray<float> Distances;
+    TArray<uint8> Directions;
+
+    // Tiles that still have to pass on a lowered distance
+    FIndexedNodeHeap OpenSet;
+
+    // Edits since the last Update, and a flag per tile so each is only queued once
+    TArray<int32> ChangedNodes;
+    TBitArray<> ChangedFlags;
+    bool bNeedsRebuild = false;
+
+    // Scratch list of tiles whose path ran through an edited tile
+    TArray<int32> OrphanedNodes;
+};
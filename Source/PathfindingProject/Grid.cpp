@@ -1,15 +1,30 @@
 #include "Grid.h"
 #include "Components/InstancedStaticMeshComponent.h"
 #include "Components/TextRenderComponent.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialInterface.h"
+#include "UObject/ConstructorHelpers.h"
 #include "UGridNode.h"
 #include "Math/UnrealMathUtility.h"
-#include "GridPlayerController.h"
 #include "Engine/World.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+#include "Misc/FileHelper.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+#include "PathfindingStats.h"
+#include "WeightLabelMaterial.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
 
 AGrid::AGrid()
 {
     PrimaryActorTick.bCanEverTick = true;
 
+    // Tile edits made by input and gameplay during the frame are uploaded once, after everything else has ticked
+    PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
     //Creates the root and instanced static mesh component
     RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootComponent"));
     InstancedMesh = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("InstancedMesh"));
@@ -20,7 +35,32 @@ AGrid::AGrid()
     // Reserve one custom data float for each instance, allowing for setting weights or obstacle states
     InstancedMesh->NumCustomDataFloats = 1;
 
+    // Weight labels are a second instanced mesh with the digit to show as custom data, so the whole grid's labels are one component
+    WeightLabels = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("WeightLabels"));
+    WeightLabels->SetupAttachment(RootComponent);
+    WeightLabels->NumCustomDataFloats = 1;
+    WeightLabels->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    WeightLabels->SetCastShadow(false);
+
+    // Any flat quad does for the labels; the digit comes from the label material
+    static ConstructorHelpers::FObjectFinder<UStaticMesh> PlaneMesh(TEXT("/Engine/BasicShapes/Plane.Plane"));
+    LabelMesh = PlaneMesh.Object;
+    LabelMaterial = nullptr;
+    bTextLabelFallback = false;
+    DefaultLabelMaterial = nullptr;
+
+    PathVisualizer = CreateDefaultSubobject<UPathVisualizerComponent>(TEXT("PathVisualizer"));
+    PathVisualizer->SetupAttachment(RootComponent);
+
     GridCount = 10; // Default grid size.
+    RandomSeed = 0;
+    PathCacheSize = 64;
+    SearchMode = EPathSearchMode::AStar;
+    HierarchicalClusterSize = 16;
+    NumLandmarks = 8;
+    CooperativeWindow = 16;
+    CooperativeGoalAreaSize = 8;
+    LabelCullDistance = 5000;
 }
 
 void AGrid::BeginPlay()
@@ -31,279 +71,848 @@ void AGrid::BeginPlay()
 void AGrid::OnConstruction(const FTransform& Transform)
 {
     Super::OnConstruction(Transform);
+    RandomStream.Initialize(RandomSeed != 0 ? RandomSeed : FMath::Rand());
     GenerateGrid(); // Runs whenever the grid is placed in the scene and modified before runtime
 }
 
 void AGrid::Tick(float DeltaTime)
 {
     Super::Tick(DeltaTime);
+    FlushTileChanges();
 }
 
 
+void AGrid::GenerateWeightLabels()
+{
+    ClearTextComponents();
+    WeightLabels->ClearInstances();
+
+    // Without a label material the instances would show blank quads, so there are no labels, or text if asked for
+    UMaterialInterface* Material = GetLabelMaterial();
+    if (!LabelMesh || !Material)
+    {
+        if (!bTextLabelFallback)
+        {
+            UE_LOG(LogPathfinding, Warning, TEXT("AGrid: No label mesh or label material, so weight labels are hidden. Run Pathfinding.CreateLabelMaterial in the editor, or enable bTextLabelFallback."));
+            return;
+        }
+        NodeTextComponents.Reserve(Nodes.Num());
+        for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); NodeIndex++)
+        {
+            if (UTextRenderComponent* TextComp = CreateTextComponentForNode(NodeIndex))
+            {
+                NodeTextComponents.Add(TextComp);
+            }
+        }
+        return;
+    }
+
+    WeightLabels->SetStaticMesh(LabelMesh);
+    WeightLabels->SetMaterial(0, Material);
+    WeightLabels->SetCullDistances(0, LabelCullDistance);
+
+    // Each label floats slightly above its tile's center, at the size the old text labels had
+    TArray<FTransform> LabelTransforms;
+    LabelTransforms.SetNumUninitialized(Nodes.Num());
+    ParallelFor(Nodes.Num(), [this, &LabelTransforms](int32 NodeIndex)
+    {
+        LabelTransforms[NodeIndex] = FTransform(FRotator::ZeroRotator, Nodes.Positions[NodeIndex] + FVector(0.0f, 0.0f, 50.0f), FVector(0.5f));
+    });
+    WeightLabels->AddInstances(LabelTransforms, false);
+    TileChanges.MarkAllDirty(FTileStateBuffer::Label);
+}
+
+UMaterialInterface* AGrid::GetLabelMaterial()
+{
+    if (LabelMaterial)
+    {
+        return LabelMaterial;
+    }
+    if (!DefaultLabelMaterial)
+    {
+        DefaultLabelMaterial = LoadObject<UMaterialInterface>(nullptr, WeightLabelMaterial::AssetPath, nullptr, LOAD_NoWarn | LOAD_Quiet);
+    }
+#if WITH_EDITOR
+    // Until the material has been saved, the editor builds its own copy so the labels show anyway
+    if (!DefaultLabelMaterial)
+    {
+        DefaultLabelMaterial = WeightLabelMaterial::Create(GetTransientPackage(), NAME_None, RF_Transient);
+    }
+#endif
+    return DefaultLabelMaterial;
+}
+
 void AGrid::ClearTextComponents()
 {
-    //Loop through each text component pointer stored in the array
     for (UTextRenderComponent* TextComp : NodeTextComponents)
     {
         if (TextComp)
         {
-            TextComp->DestroyComponent(); // If the text component exists, destroy it
+            TextComp->DestroyComponent();
         }
     }
-    NodeTextComponents.Empty(); // Clear the array
+    NodeTextComponents.Empty();
 }
 
-/// 
-/// @param Node The node to attach the text component to
-/// @return The UTextRenderComponent with the weight value and position
-UTextRenderComponent* AGrid::CreateTextComponentForNode(UGridNode* Node)
+UTextRenderComponent* AGrid::CreateTextComponentForNode(int32 NodeIndex)
 {
     UTextRenderComponent* TextComp = NewObject<UTextRenderComponent>(this);
-    if (TextComp && Node)
+    if (TextComp && Nodes.IsValidIndex(NodeIndex))
     {
-        // Convert weight to integer string
-        FString WeightString = FString::Printf(TEXT("%d"), FMath::RoundToInt(Node->Weight));
-        TextComp->SetText(FText::FromString(WeightString));
-
-        // Set properties for readability.
+        TextComp->SetText(FText::AsNumber(FMath::RoundToInt(Nodes.Weights[NodeIndex])));
         TextComp->SetHorizontalAlignment(EHTA_Center);
         TextComp->SetVerticalAlignment(EVRTA_TextCenter);
         TextComp->SetTextRenderColor(FColor::Red);
         TextComp->SetWorldSize(50.f);
 
-        // Position text at the node's center, with a slight upward offset.
-        FVector TextLocation = Node->WorldPosition;
-        TextLocation.Z += 50.f;
-        TextComp->SetWorldLocation(TextLocation);
-
-        // Rotate text so it lies flat on the tile
-        FRotator TextRotation = FRotator(90.f, 180.f, 0.f);
-        TextComp->SetWorldRotation(TextRotation);
+        // Lies flat on the tile, slightly above its center
+        TextComp->SetWorldLocation(Nodes.Positions[NodeIndex] + FVector(0.0f, 0.0f, 50.0f));
+        TextComp->SetWorldRotation(FRotator(90.f, 180.f, 0.f));
+        TextComp->SetCullDistance(LabelCullDistance);
 
-        // Attach to the grid's root and register, allowing it to appear during runtime
-        TextComp->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
+        TextComp->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepWorldTransform);
         TextComp->RegisterComponent();
-
-        
     }
     return TextComp;
 }
 
+float AGrid::GetTileAppearance(int32 InstanceIndex) const
+{
+    // The start and goal stay visible even on an obstacle
+    if (InstanceIndex == StartTileIndex)
+    {
+        return 1.0f;
+    }
+    if (InstanceIndex == GoalTileIndex)
+    {
+        return 2.0f;
+    }
+    return Nodes.Obstacles[InstanceIndex] ? 3.0f : 0.0f;
+}
+
+void AGrid::FlushTileChanges()
+{
+    if (!TileChanges.HasChanges() || !InstancedMesh || !WeightLabels)
+    {
+        return;
+    }
+
+    // Both meshes hold one instance per tile, except while a regeneration is half done
+    const bool bTilesMatch = InstancedMesh->GetInstanceCount() == Nodes.Num();
+    const bool bLabelsMatch = WeightLabels->GetInstanceCount() == Nodes.Num();
+    bool bTilesChanged = false;
+    bool bLabelsChanged = false;
+
+    // The values are read from the grid's state as it is now, so a tile edited several times this frame is written once.
+    // Nothing is marked dirty per tile; each mesh gets a single render state update for the whole batch.
+    TileChanges.Flush([this, bTilesMatch, bLabelsMatch, &bTilesChanged, &bLabelsChanged](int32 FirstIndex, int32 Count, uint8 Change)
+    {
+        for (int32 Index = FirstIndex; Index < FirstIndex + Count; Index++)
+        {
+            if ((Change & FTileStateBuffer::Appearance) && bTilesMatch)
+            {
+                InstancedMesh->SetCustomDataValue(Index, 0, GetTileAppearance(Index), false);
+                bTilesChanged = true;
+            }
+            if ((Change & FTileStateBuffer::Label) && bLabelsMatch)
+            {
+                // The label material draws the digit of the rounded weight
+                WeightLabels->SetCustomDataValue(Index, 0, (float)FMath::RoundToInt(Nodes.Weights[Index]), false);
+                bLabelsChanged = true;
+            }
+            else if ((Change & FTileStateBuffer::Label) && NodeTextComponents.IsValidIndex(Index))
+            {
+                NodeTextComponents[Index]->SetText(FText::AsNumber(FMath::RoundToInt(Nodes.Weights[Index])));
+            }
+        }
+    });
+
+    if (bTilesChanged)
+    {
+        InstancedMesh->MarkRenderStateDirty();
+    }
+    if (bLabelsChanged)
+    {
+        WeightLabels->MarkRenderStateDirty();
+    }
+}
 
-void AGrid::BuildNeighbors()
+void AGrid::ClearNodeViews()
 {
-    //Loop through the grid array, and run the FindNeighbors function for each node
-    for (int32 x = 0; x < GridNodes.Num(); x++)
+    // Views may still be referenced from Blueprint, so detach them rather than let them read the new grid
+    for (TPair<int32, TObjectPtr<UGridNode>>& View : NodeViews)
     {
-        for (int32 y = 0; y < GridNodes[x].Num(); y++)
+        if (View.Value)
         {
-            GridNodes[x][y]->FindNeighbors(GridNodes, GridCount, GridCount);
+            View.Value->Invalidate();
         }
     }
+    NodeViews.Empty();
 }
 
+UGridNode* AGrid::GetNodeView(int32 InstanceIndex)
+{
+    if (!Nodes.IsValidIndex(InstanceIndex))
+    {
+        return nullptr;
+    }
+
+    TObjectPtr<UGridNode>& View = NodeViews.FindOrAdd(InstanceIndex);
+    if (!View)
+    {
+        View = NewObject<UGridNode>(this);
+        View->Initialize(this, InstanceIndex);
+    }
+    return View;
+}
 
 void AGrid::GenerateGrid()
 {
-    if (!InstancedMesh)
+    if (!InstancedMesh || !WeightLabels)
     {
-        return; // If the grid's instanced static mesh component does not exist, exit early
+        return; // If the grid's instanced static mesh components do not exist, exit early
     }
 
-    // Clear previous text components and grid data
-    ClearTextComponents();
+    // An authored map replaces the generated tiles
+    if (!GridFile.FilePath.IsEmpty() && LoadGridFile(GridFile.FilePath))
+    {
+        return;
+    }
+
+    // Lay out the node data and adjacency for every tile in parallel, reusing the previous grid's arrays
+    const double StartTime = FPlatformTime::Seconds();
+    NodeSeed = RandomStream.RandHelper(MAX_int32);
+    NodeSnapshot.Reset();
+    Nodes.Build(GridCount, NodeSeed);
+    ApplyNodes(StartTime);
+}
+
+bool AGrid::LoadGridFile(const FString& Filename)
+{
+    if (!InstancedMesh || !WeightLabels)
+    {
+        return false;
+    }
+
+    // A path database stored with the tiles is used as soon as the grid is up, with no background build
+    const double StartTime = FPlatformTime::Seconds();
+    FCompressedPathDatabase LoadedDatabase;
+    NodeSnapshot.Reset();
+    if (!FGridFile::Load(Filename, Nodes, &LoadedDatabase))
+    {
+        UE_LOG(LogPathfinding, Warning, TEXT("AGrid: Could not load grid file %s"), *Filename);
+        return false;
+    }
+    GridCount = Nodes.GetGridCount();
+    NodeSeed = 0;
+    ApplyNodes(StartTime);
+
+    if (LoadedDatabase.IsBuiltFor(Nodes))
+    {
+        if (PathDatabaseBuildCancelFlag.IsValid())
+        {
+            PathDatabaseBuildCancelFlag->store(true);
+            PathDatabaseBuildCancelFlag.Reset();
+        }
+        PathDatabase = MoveTemp(LoadedDatabase);
+        PathDatabaseCheckedVersion = GridVersion;
+        bPathDatabaseMatchesGrid = true;
+    }
+    return true;
+}
+
+bool AGrid::SaveGridFile(const FString& Filename, bool bWithNeighbors, bool bWithPathDatabase)
+{
+    // The file holds rounded weights, so a stored path database has to be the one for the rounded tiles
+    FCompressedPathDatabase QuantizedDatabase;
+    const FCompressedPathDatabase* SavedDatabase = nullptr;
+    if (bWithPathDatabase)
+    {
+        FGridNodeStore Quantized = Nodes;
+        FGridFile::QuantizeWeights(Quantized);
+        if (PathDatabase.IsBuiltFor(Quantized))
+        {
+            SavedDatabase = &PathDatabase;
+        }
+        else
+        {
+            QuantizedDatabase.Build(Quantized);
+            SavedDatabase = &QuantizedDatabase;
+        }
+    }
+
+    const uint32 Sections = (bWithNeighbors ? FGridFile::WithNeighbors : 0) | (bWithPathDatabase ? FGridFile::WithPathDatabase : 0);
+    return FGridFile::Save(Filename, Nodes, Sections, SavedDatabase);
+}
+
+void AGrid::ApplyNodes(double StartTime)
+{
+    // Clear previous grid data
+    ClearNodeViews();
+    if (PathVisualizer)
+    {
+        PathVisualizer->ClearAllPaths();
+    }
+    StartTileIndex = INDEX_NONE;
+    GoalTileIndex = INDEX_NONE;
     InstancedMesh->ClearInstances();
-    GridNodes.Empty();
-    NodeMap.Empty();
+    TileChanges.Reset(Nodes.Num());
+    if (WorkloadRecording)
+    {
+        WorkloadRecording->AddSnapshot(Nodes, NodeSeed);
+    }
 
-    // Hex grid parameters for placing the tiles
-    float HexRadius = 100.0f;
-    float HorizontalShift = HexRadius * FMath::Sqrt(3.);
-    float VerticalShift = HexRadius * 1.5f;
+    // Size the search scratch now so the first query does not have to
+    SearchContext.Reserve(Nodes.Num());
+    IncrementalPlanner.Reset();
+    HierarchicalPathfinder.Reset();
+    LandmarkHeuristic.Reset();
+    ConnectedComponents.Build(Nodes);
+    CooperativePlanner.Reset();
+    for (TPair<int32, TUniquePtr<FFlowField>>& FlowField : FlowFields)
+    {
+        FlowField.Value->NotifyAllChanged();
+    }
 
-    // Bounding box initialization
-    FVector MinPos(FLT_MAX, FLT_MAX, FLT_MAX);
-    FVector MaxPos(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    // Every cached path belongs to the previous grid
+    MarkGridChanged();
+    PathCache.Empty(FMath::Max(PathCacheSize, 1));
 
-    // Create grid nodes
-    for (int32 x = 0; x < GridCount; x++) // each column
+    // Tile transforms with the proper location and zero rotation
+    TArray<FTransform> TileTransforms;
+    TileTransforms.SetNumUninitialized(Nodes.Num());
+    ParallelFor(Nodes.Num(), [this, &TileTransforms](int32 NodeIndex)
     {
-        TArray<UGridNode*> RowNodes;
-        for (int32 y = 0; y < GridCount; y++) // each row
+        TileTransforms[NodeIndex] = FTransform(FRotator::ZeroRotator, Nodes.Positions[NodeIndex]);
+    });
+    const double LayoutTime = FPlatformTime::Seconds();
+
+    // All tiles go to the component in one call, so its render state is rebuilt once rather than once per tile.
+    // Instances are added in node order, so a tile's instance index is its node index. New instances start with
+    // zeroed custom data, which is the neutral tile color, so the custom data is uploaded along with them.
+    InstancedMesh->AddInstances(TileTransforms, false);
+    check(InstancedMesh->GetInstanceCount() == Nodes.Num());
+    const double UploadTime = FPlatformTime::Seconds();
+
+    // Generated tiles start open, but a loaded map can already have obstacles, which go up with the labels
+    for (int32 Index = 0; Index < Nodes.Num(); Index++)
+    {
+        if (Nodes.Obstacles[Index])
         {
-            FVector TileLocation;
-            if (y % 2 == 0) // if even numbered row, place tile without offset
-                TileLocation = FVector(HorizontalShift * x, VerticalShift * y, 0.0f);
-            else // otherwise, apply a horizontal shift 
-                TileLocation = FVector(HorizontalShift * x + HorizontalShift / 2.0f, VerticalShift * y, 0.0f);
-
-            //Stores the transform of the tile with the proper location and zero rotation
-            FTransform TileTransform(FRotator::ZeroRotator, TileLocation);
-
-            //Creates a new instance of the tile mesh and applies a neutral color
-            int32 InstanceIndex = InstancedMesh->AddInstance(TileTransform); // returns the index of the new tile
-            InstancedMesh->SetCustomDataValue(InstanceIndex, 0, 0.0f, true);
-
-            //Updates MinPos to find the smallest coordinates of the grid
-            MinPos.X = FMath::Min(MinPos.X, TileLocation.X);
-            MinPos.Y = FMath::Min(MinPos.Y, TileLocation.Y);
-            MinPos.Z = FMath::Min(MinPos.Z, TileLocation.Z);
-
-            //Updates MaxPos to find the largest coordinates of the grid
-            MaxPos.X = FMath::Max(MaxPos.X, TileLocation.X);
-            MaxPos.Y = FMath::Max(MaxPos.Y, TileLocation.Y);
-            MaxPos.Z = FMath::Max(MaxPos.Z, TileLocation.Z);
-
-            //Generates a new instance of UGridNode at runtime and initialize its values
-            UGridNode* NewNode = NewObject<UGridNode>(this);
-            NewNode->GridX = x;
-            NewNode->GridY = y;
-            NewNode->WorldPosition = TileLocation;
-            NewNode->InstanceIndex = InstanceIndex;
-
-            //Adds the new node to the array and maps its index
-            RowNodes.Add(NewNode);
-            NodeMap.Add(InstanceIndex, NewNode);
-
-            // Create and attach a text component to display the node's weight
-            if (UTextRenderComponent* TextComp = CreateTextComponentForNode(NewNode))
-            {
-                NodeTextComponents.Add(TextComp);
-            }
+            TileChanges.MarkDirty(Index, FTileStateBuffer::Appearance);
         }
-        //Stores the row of UGridNode objects in this array, forming the 2D grid structure
-        GridNodes.Add(RowNodes);
     }
 
-    // Compute the grid center from bounding box
-    GridCenter = (MinPos + MaxPos) * 0.5f;
-    UE_LOG(LogTemp, Log, TEXT("AGrid::GenerateGrid: Computed GridCenter = %s"), *GridCenter.ToString());
+    // Show each node's weight above its tile. The grid is also generated in the editor, where nothing ticks, so the labels go up right away.
+    GenerateWeightLabels();
+    FlushTileChanges();
+    const double LabelTime = FPlatformTime::Seconds();
 
-    // Calls the function to link adjacent tiles
-    BuildNeighbors();
+    // Compute the grid center from bounding box
+    GridCenter = FBox(Nodes.Positions.GetData(), Nodes.Num()).GetCenter();
+    UE_LOG(LogPathfinding, Verbose, TEXT("AGrid::GenerateGrid: %d tiles, layout %.2f ms, instance upload %.2f ms, labels %.2f ms. Computed GridCenter = %s"),
+        Nodes.Num(), (LayoutTime - StartTime) * 1000.0, (UploadTime - LayoutTime) * 1000.0, (LabelTime - UploadTime) * 1000.0, *GridCenter.ToString());
+
+    // With a label material the grid's component count stays the same at any size; the text fallback adds one per tile
+    const SIZE_T LabelBytes = WeightLabels->PerInstanceSMData.GetAllocatedSize() + WeightLabels->PerInstanceSMCustomData.GetAllocatedSize();
+    UE_LOG(LogPathfinding, Verbose, TEXT("AGrid::GenerateGrid: %d components, weight labels %s, %.1f KB of instances"), GetComponents().Num(),
+        NodeTextComponents.Num() > 0 ? TEXT("as text components") : TEXT("instanced"), LabelBytes / 1024.0);
 }
 
-TArray<UGridNode*> AGrid::FindPath(int32 StartInstanceIndex, int32 GoalInstanceIndex)
+bool AGrid::FindPath(int32 StartInstanceIndex, int32 GoalInstanceIndex, TArray<int32>& OutPath)
 {
-    // Stores the tiles that lead to the goal node
-    TArray<UGridNode*> Path;
+    return FindPath(StartInstanceIndex, GoalInstanceIndex, SearchContext, OutPath);
+}
 
-    // Look up the index of the start and goal node, returning a pointer-to-pointer
-    UGridNode** StartNodePtr = NodeMap.Find(StartInstanceIndex);
-    UGridNode** GoalNodePtr = NodeMap.Find(GoalInstanceIndex);
-    if (!StartNodePtr || !GoalNodePtr)
+bool AGrid::FindPath(int32 StartInstanceIndex, int32 GoalInstanceIndex, FPathSearchContext& Context, TArray<int32>& OutPath)
+{
+    OutPath.Reset();
+    if (!Nodes.IsValidIndex(StartInstanceIndex) || !Nodes.IsValidIndex(GoalInstanceIndex))
     {
         // If either node not found, exit early
-        UE_LOG(LogTemp, Warning, TEXT("FindPath: Could not find Start or Goal node."));
-        return Path;
+        UE_LOG(LogPathfinding, Verbose, TEXT("FindPath: Could not find Start or Goal node."));
+        return false;
     }
 
-    //Dereference the start/goal pointers to get the actual nodes
-    UGridNode* StartNode = *StartNodePtr;
-    UGridNode* GoalNode = *GoalNodePtr;
+    // Nothing has changed since this query last ran, so its result still holds
+    const FPathCacheKey CacheKey = { StartInstanceIndex, GoalInstanceIndex, GridVersion, SearchMode };
+    if (const TArray<int32>* CachedPath = PathCache.FindAndTouch(CacheKey))
+    {
+        PathCacheHits++;
+        OutPath.Append(*CachedPath);
+        if (WorkloadRecording)
+        {
+            WorkloadRecording->AddQuery(StartInstanceIndex, GoalInstanceIndex, SearchMode,
+                FPathWorkload::CacheHit | (OutPath.Num() > 0 ? FPathWorkload::Found : 0), 0.0f);
+        }
+        return OutPath.Num() > 0;
+    }
+    PathCacheMisses++;
 
     // Log the start and goal node's world position
-    UE_LOG(LogTemp, Log, TEXT("FindPath: StartNode at (%.2f, %.2f, %.2f), GoalNode at (%.2f, %.2f, %.2f)"),
-        StartNode->WorldPosition.X, StartNode->WorldPosition.Y, StartNode->WorldPosition.Z,
-        GoalNode->WorldPosition.X, GoalNode->WorldPosition.Y, GoalNode->WorldPosition.Z);
+    const FVector& StartPosition = Nodes.Positions[StartInstanceIndex];
+    const FVector& GoalPosition = Nodes.Positions[GoalInstanceIndex];
+    UE_LOG(LogPathfinding, Verbose, TEXT("FindPath: StartNode at (%.2f, %.2f, %.2f), GoalNode at (%.2f, %.2f, %.2f)"),
+        StartPosition.X, StartPosition.Y, StartPosition.Z,
+        GoalPosition.X, GoalPosition.Y, GoalPosition.Z);
+
+    // A goal outside the start's region would make the search flood everything reachable before giving up
+    const double SearchStartTime = FPlatformTime::Seconds();
+    const bool bFoundPath = ConnectedComponents.AreConnected(StartInstanceIndex, GoalInstanceIndex)
+        && RunSearch(StartInstanceIndex, GoalInstanceIndex, Context, OutPath);
+    PathCache.Add(CacheKey, OutPath);
+    if (WorkloadRecording)
+    {
+        WorkloadRecording->AddQuery(StartInstanceIndex, GoalInstanceIndex, SearchMode, bFoundPath ? FPathWorkload::Found : 0,
+            (float)((FPlatformTime::Seconds() - SearchStartTime) * 1.e6));
+    }
+    if (!bFoundPath)
+    {
+        UE_LOG(LogPathfinding, Verbose, TEXT("FindPath: No valid path found."));
+        return false;
+    }
+
+    UE_LOG(LogPathfinding, Verbose, TEXT("FindPath: Goal reached, reconstructing path."));
+    return true;
+}
 
-    // Reset costs and parent pointers
-    for (int32 x = 0; x < GridNodes.Num(); x++)
+bool AGrid::RunSearch(int32 StartInstanceIndex, int32 GoalInstanceIndex, FPathSearchContext& Context, TArray<int32>& OutPath)
+{
+    switch (SearchMode)
     {
-        for (int32 y = 0; y < GridNodes[x].Num(); y++)
-        {
-            UGridNode* Node = GridNodes[x][y];
+    case EPathSearchMode::Incremental:
+        return FindPathIncremental(StartInstanceIndex, GoalInstanceIndex, OutPath);
+    case EPathSearchMode::Hierarchical:
+        return FindPathHierarchical(StartInstanceIndex, GoalInstanceIndex, OutPath);
+    case EPathSearchMode::JumpPoint:
+        return Nodes.FindPathJumpPoint(StartInstanceIndex, GoalInstanceIndex, Context, OutPath);
+    case EPathSearchMode::Bidirectional:
+        return Nodes.FindPathBidirectional(StartInstanceIndex, GoalInstanceIndex, Context, ReverseSearchContext, OutPath);
+    case EPathSearchMode::FixedPoint:
+        return Nodes.FindPathFixedPoint(StartInstanceIndex, GoalInstanceIndex, Context, OutPath);
+    case EPathSearchMode::Landmarks:
+        return FindPathLandmarks(StartInstanceIndex, GoalInstanceIndex, Context, OutPath);
+    case EPathSearchMode::PathDatabase:
+        return FindPathDatabase(StartInstanceIndex, GoalInstanceIndex, Context, OutPath);
+    default:
+        return Nodes.FindPath(StartInstanceIndex, GoalInstanceIndex, Context, OutPath);
+    }
+}
 
-            //G and HCost are set to infinity so that the nodes being searched will be updated
-            Node->GCost = TNumericLimits<float>::Max(); 
-            Node->HCost = TNumericLimits<float>::Max();
-            Node->ParentNode = nullptr;
-        }
+bool AGrid::FindPathIncremental(int32 StartInstanceIndex, int32 GoalInstanceIndex, TArray<int32>& OutPath)
+{
+    // A different start or goal invalidates the whole tree, so only then is it planned from scratch
+    if (!IncrementalPlanner.IsPlanning(StartInstanceIndex, GoalInstanceIndex))
+    {
+        IncrementalPlanner.Initialize(Nodes, StartInstanceIndex, GoalInstanceIndex);
     }
+    return IncrementalPlanner.FindPath(OutPath);
+}
 
-    // No movement cost since we start from this node
-    StartNode->GCost = 0;
+bool AGrid::FindPathHierarchical(int32 StartInstanceIndex, int32 GoalInstanceIndex, TArray<int32>& OutPath)
+{
+    const int32 ClusterSize = FMath::Max(HierarchicalClusterSize, 2);
+    if (!HierarchicalPathfinder.IsBuilt() || HierarchicalPathfinder.GetClusterSize() != ClusterSize)
+    {
+        HierarchicalPathfinder.Build(Nodes, ClusterSize);
+    }
+    return HierarchicalPathfinder.FindPath(StartInstanceIndex, GoalInstanceIndex, OutPath);
+}
 
-    // Calculates the HCost as the Euclidean distance from the start to the goal node
-    StartNode->HCost = FVector::Dist(StartNode->WorldPosition, GoalNode->WorldPosition);
+bool AGrid::FindPathLandmarks(int32 StartInstanceIndex, int32 GoalInstanceIndex, FPathSearchContext& Context, TArray<int32>& OutPath)
+{
+    const int32 LandmarkCount = FMath::Max(NumLandmarks, 1);
+    if (!LandmarkHeuristic.IsBuilt() || LandmarkHeuristic.GetRequestedLandmarks() != LandmarkCount)
+    {
+        LandmarkHeuristic.Build(Nodes, LandmarkCount);
+        UE_LOG(LogPathfinding, Verbose, TEXT("AGrid: Placed %d landmarks in %.2f ms, %.1f KB per landmark"), LandmarkHeuristic.GetLandmarks().Num(),
+            LandmarkHeuristic.BuildSeconds * 1000.0, LandmarkHeuristic.GetAllocatedSizePerLandmark() / 1024.0);
+    }
+    else
+    {
+        LandmarkHeuristic.Update();
+    }
+    return Nodes.FindPath(StartInstanceIndex, GoalInstanceIndex, Context, OutPath, &LandmarkHeuristic);
+}
 
-    
-    TArray<UGridNode*> OpenSet; // Stores nodes that will have their FCosts compared
-    TSet<UGridNode*> ClosedSet; // Stores nodes that 
-    OpenSet.Add(StartNode); // Adds the start node to be examined first
+bool AGrid::FindPathDatabase(int32 StartInstanceIndex, int32 GoalInstanceIndex, FPathSearchContext& Context, TArray<int32>& OutPath)
+{
+    if (IsPathDatabaseReady())
+    {
+        return PathDatabase.FindPath(Nodes, StartInstanceIndex, GoalInstanceIndex, OutPath);
+    }
+
+    // Only one build per grid version, however many queries arrive while it runs
+    if (!PathDatabaseBuildCancelFlag.IsValid() || PathDatabaseBuildVersion != GridVersion)
+    {
+        BuildPathDatabaseAsync();
+    }
+    return Nodes.FindPath(StartInstanceIndex, GoalInstanceIndex, Context, OutPath);
+}
+
+bool AGrid::IsPathDatabaseReady()
+{
+    // Hashing the tiles is a pass over the whole grid, so it is done once per version rather than per query
+    if (PathDatabaseCheckedVersion != GridVersion)
+    {
+        bPathDatabaseMatchesGrid = PathDatabase.IsBuiltFor(Nodes);
+        PathDatabaseCheckedVersion = GridVersion;
+    }
+    return bPathDatabaseMatchesGrid;
+}
+
+void AGrid::BuildPathDatabaseAsync()
+{
+    if (PathDatabaseBuildCancelFlag.IsValid())
+    {
+        PathDatabaseBuildCancelFlag->store(true);
+    }
+    TSharedRef<std::atomic<bool>> CancelFlag = MakeShared<std::atomic<bool>>(false);
+    PathDatabaseBuildCancelFlag = CancelFlag;
+    PathDatabaseBuildVersion = GridVersion;
 
-    // Main A* loop.
-    while (OpenSet.Num() > 0) // while there remain nodes to be examined 
+    UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakGrid = TWeakObjectPtr<AGrid>(this), Snapshot = GetNodeSnapshot(), CancelFlag, Version = GridVersion]()
     {
-        UGridNode* CurrentNode = OpenSet[0]; // Current node is the first element in the array, starts with start node
-        for (UGridNode* Node : OpenSet)
+        TSharedRef<FCompressedPathDatabase> Database = MakeShared<FCompressedPathDatabase>();
+        if (!Database->Build(*Snapshot, 0, &CancelFlag.Get()))
         {
-            //Checks for lowest FCost among nodes, and if there is a tie, choose the lowest HCost
-            if (Node->FCost() < CurrentNode->FCost() ||
-                (FMath::IsNearlyEqual(Node->FCost(), CurrentNode->FCost()) && Node->HCost < CurrentNode->HCost))
-            {
-                CurrentNode = Node; // Best node is chosen
-            }
+            return;
         }
-        
-        if (CurrentNode == GoalNode)
+
+        AsyncTask(ENamedThreads::GameThread, [WeakGrid, CancelFlag, Version, Database]()
         {
-            UE_LOG(LogTemp, Log, TEXT("FindPath: Goal reached, reconstructing path."));
-            UGridNode* PathNode = GoalNode;
+            // A newer build replaced this one, or the grid is gone
+            AGrid* Grid = WeakGrid.Get();
+            if (!Grid || CancelFlag->load() || Grid->PathDatabaseBuildCancelFlag.Get() != &CancelFlag.Get())
+            {
+                return;
+            }
+            Grid->PathDatabaseBuildCancelFlag.Reset();
 
-            //If goal node found, reconstruct path by inserting each node and its parent node backwards
-            while (PathNode != nullptr)
+            // Tiles edited while the build ran leave the next query to start another one
+            if (Grid->GridVersion != Version)
             {
-                Path.Insert(PathNode, 0);
-                PathNode = PathNode->ParentNode;
+                return;
             }
-            
-            return Path;
-        }
+            Grid->PathDatabase = MoveTemp(*Database);
+            Grid->bPathDatabaseMatchesGrid = true;
+            Grid->PathDatabaseCheckedVersion = Version;
+            UE_LOG(LogPathfinding, Verbose, TEXT("AGrid: Built the path database in %.2f s, %d runs, %.1f KB"), Grid->PathDatabase.BuildSeconds,
+                Grid->PathDatabase.GetNumRuns(), Grid->PathDatabase.GetAllocatedSize() / 1024.0);
+        });
+    });
+}
+
+bool AGrid::SavePathDatabase(const FString& Filename) const
+{
+    if (!PathDatabase.IsBuilt())
+    {
+        return false;
+    }
+
+    TArray<uint8> Blob;
+    PathDatabase.SaveToBlob(Blob);
+    return FFileHelper::SaveArrayToFile(Blob, *Filename);
+}
 
-        // Remove the examined node from the open set and mark it as closed
-        OpenSet.Remove(CurrentNode);
-        ClosedSet.Add(CurrentNode);
+bool AGrid::LoadPathDatabase(const FString& Filename)
+{
+    TArray<uint8> Blob;
+    FCompressedPathDatabase Loaded;
+    if (!FFileHelper::LoadFileToArray(Blob, *Filename) || !Loaded.LoadFromBlob(Blob) || !Loaded.IsBuiltFor(Nodes))
+    {
+        UE_LOG(LogPathfinding, Warning, TEXT("AGrid: %s does not hold a path database for this grid"), *Filename);
+        return false;
+    }
+
+    PathDatabase = MoveTemp(Loaded);
+    bPathDatabaseMatchesGrid = true;
+    PathDatabaseCheckedVersion = GridVersion;
+    return true;
+}
+
+TSharedRef<const FGridNodeStore> AGrid::GetNodeSnapshot()
+{
+    if (!NodeSnapshot.IsValid() || NodeSnapshotVersion != GridVersion)
+    {
+        // About 9 bytes per tile: the positions and the neighbor table are shared, not copied
+        NodeSnapshot = MakeShared<FGridNodeStore>(Nodes);
+        NodeSnapshotVersion = GridVersion;
+    }
+    return NodeSnapshot.ToSharedRef();
+}
 
-        // Loop through the current node's neighbors
-        for (UGridNode* Neighbor : CurrentNode->Neighbors)
+FPathQueryHandle AGrid::FindPathAsync(int32 StartInstanceIndex, int32 GoalInstanceIndex, FOnPathQueryComplete OnComplete)
+{
+    TSharedRef<std::atomic<bool>> CancelFlag = MakeShared<std::atomic<bool>>(false);
+    FPathQueryHandle Handle(CancelFlag);
+
+    FPathQueryResult Result;
+    Result.StartIndex = StartInstanceIndex;
+    Result.GoalIndex = GoalInstanceIndex;
+    Result.GridVersion = GridVersion;
+
+    // Hands the result to the caller on the game thread, unless the query was cancelled in the meantime
+    auto Deliver = [WeakGrid = TWeakObjectPtr<AGrid>(this), WeakRecording = TWeakPtr<FPathWorkload>(WorkloadRecording), CancelFlag,
+        Mode = SearchMode, OnComplete = MoveTemp(OnComplete)](FPathQueryResult&& FinishedResult)
+    {
+        AsyncTask(ENamedThreads::GameThread, [WeakGrid, WeakRecording, CancelFlag, Mode, OnComplete, FinishedResult = MoveTemp(FinishedResult)]()
         {
-            // If the neighbor is an obstacle, or has been moved to closed set, skip this iteration (this node)
-            if (Neighbor->bIsObstacle || ClosedSet.Contains(Neighbor))
+            if (CancelFlag->load())
             {
-                continue;
+                return;
             }
 
-            // Calculate the base cost of moving to a node, determined by position
-            float moveCost = FVector::Dist(CurrentNode->WorldPosition, Neighbor->WorldPosition);
-
-            // Cost to reach the neighbor given the current GCost, the distance, and weight
-            float TentativeGCost = CurrentNode->GCost + (moveCost * Neighbor->Weight);
+            // A worker query was recorded when it was requested, in order with the edits around it; now its time is known
+            if (TSharedPtr<FPathWorkload> Recording = WeakRecording.Pin())
+            {
+                Recording->SetQueryResult(FinishedResult.WorkloadEvent, FinishedResult.bFoundPath, (float)(FinishedResult.SearchSeconds * 1.e6));
+            }
 
-            // This check passes for all nodes that are set to infinity. After that, we may update previously assigned GCosts
-            if (TentativeGCost < Neighbor->GCost)
+            // Let later synchronous queries reuse the result while the grid has not changed
+            AGrid* Grid = WeakGrid.Get();
+            if (Grid && Grid->GridVersion == FinishedResult.GridVersion)
             {
+                Grid->PathCache.Add(FPathCacheKey{ FinishedResult.StartIndex, FinishedResult.GoalIndex, FinishedResult.GridVersion, Mode }, FinishedResult.Path);
+            }
+            if (OnComplete)
+            {
+                OnComplete(FinishedResult);
+            }
+        });
+    };
+
+    // Invalid endpoints and cached results don't need a worker
+    const FPathCacheKey CacheKey = { StartInstanceIndex, GoalInstanceIndex, GridVersion, SearchMode };
+    if (!Nodes.IsValidIndex(StartInstanceIndex) || !Nodes.IsValidIndex(GoalInstanceIndex))
+    {
+        Deliver(MoveTemp(Result));
+        return Handle;
+    }
+    if (const TArray<int32>* CachedPath = PathCache.FindAndTouch(CacheKey))
+    {
+        PathCacheHits++;
+        Result.Path = *CachedPath;
+        Result.bFoundPath = Result.Path.Num() > 0;
+        if (WorkloadRecording)
+        {
+            WorkloadRecording->AddQuery(StartInstanceIndex, GoalInstanceIndex, SearchMode,
+                FPathWorkload::Async | FPathWorkload::CacheHit | (Result.bFoundPath ? FPathWorkload::Found : 0), 0.0f);
+        }
+        Deliver(MoveTemp(Result));
+        return Handle;
+    }
+    PathCacheMisses++;
+
+    // So does a goal that cannot be reached, which the region labels tell right away
+    if (!ConnectedComponents.AreConnected(StartInstanceIndex, GoalInstanceIndex))
+    {
+        if (WorkloadRecording)
+        {
+            WorkloadRecording->AddQuery(StartInstanceIndex, GoalInstanceIndex, SearchMode, FPathWorkload::Async, 0.0f);
+        }
+        Deliver(MoveTemp(Result));
+        return Handle;
+    }
 
-                // Update the neighbor's values, overriding its default (infinity) values
-                Neighbor->GCost = TentativeGCost;
-                Neighbor->HCost = FVector::Dist(Neighbor->WorldPosition, GoalNode->WorldPosition);
-                Neighbor->ParentNode = CurrentNode;
+    // The incremental tree, the clusters, the landmark tables and the path database belong to the game thread, and searching them rarely takes long
+    if (SearchMode == EPathSearchMode::Incremental || SearchMode == EPathSearchMode::Hierarchical || SearchMode == EPathSearchMode::Landmarks
+        || SearchMode == EPathSearchMode::PathDatabase)
+    {
+        const double SearchStartTime = FPlatformTime::Seconds();
+        Result.bFoundPath = RunSearch(StartInstanceIndex, GoalInstanceIndex, SearchContext, Result.Path);
+        if (WorkloadRecording)
+        {
+            WorkloadRecording->AddQuery(StartInstanceIndex, GoalInstanceIndex, SearchMode, FPathWorkload::Async | (Result.bFoundPath ? FPathWorkload::Found : 0),
+                (float)((FPlatformTime::Seconds() - SearchStartTime) * 1.e6));
+        }
+        Deliver(MoveTemp(Result));
+        return Handle;
+    }
 
-                // If the neighbor is not already in the open set, add it
-                if (!OpenSet.Contains(Neighbor))
+    if (WorkloadRecording)
+    {
+        Result.WorkloadEvent = WorkloadRecording->AddQuery(StartInstanceIndex, GoalInstanceIndex, SearchMode, FPathWorkload::Async);
+    }
+
+    UE::Tasks::Launch(UE_SOURCE_LOCATION,
+        [Snapshot = GetNodeSnapshot(), ContextPool = AsyncContextPool, CancelFlag, Mode = SearchMode, Deliver = MoveTemp(Deliver), Result = MoveTemp(Result)]() mutable
+        {
+            if (!CancelFlag->load())
+            {
+                TUniquePtr<FPathSearchContext> Context = ContextPool->Acquire();
+                Context->CancelFlag = &CancelFlag.Get();
+                const double SearchStartTime = FPlatformTime::Seconds();
+                switch (Mode)
                 {
-                    OpenSet.Add(Neighbor);
+                case EPathSearchMode::JumpPoint:
+                    Result.bFoundPath = Snapshot->FindPathJumpPoint(Result.StartIndex, Result.GoalIndex, *Context, Result.Path);
+                    break;
+                case EPathSearchMode::Bidirectional:
+                {
+                    TUniquePtr<FPathSearchContext> ReverseContext = ContextPool->Acquire();
+                    ReverseContext->CancelFlag = &CancelFlag.Get();
+                    Result.bFoundPath = Snapshot->FindPathBidirectional(Result.StartIndex, Result.GoalIndex, *Context, *ReverseContext, Result.Path);
+                    ContextPool->Release(MoveTemp(ReverseContext));
+                    break;
+                }
+                case EPathSearchMode::FixedPoint:
+                    Result.bFoundPath = Snapshot->FindPathFixedPoint(Result.StartIndex, Result.GoalIndex, *Context, Result.Path);
+                    break;
+                default:
+                    Result.bFoundPath = Snapshot->FindPath(Result.StartIndex, Result.GoalIndex, *Context, Result.Path);
+                    break;
                 }
+                Result.SearchSeconds = FPlatformTime::Seconds() - SearchStartTime;
+                ContextPool->Release(MoveTemp(Context));
             }
+            Deliver(MoveTemp(Result));
+        });
+
+    return Handle;
+}
+
+const FFlowField* AGrid::BuildFlowField(int32 GoalIndex)
+{
+    if (!Nodes.IsValidIndex(GoalIndex))
+    {
+        return nullptr;
+    }
+
+    TUniquePtr<FFlowField>& FlowField = FlowFields.FindOrAdd(GoalIndex);
+    if (!FlowField)
+    {
+        FlowField = MakeUnique<FFlowField>();
+    }
+
+    // A field that lost its goal to a smaller grid comes back once the goal exists again
+    if (FlowField->IsBuilt())
+    {
+        FlowField->Update();
+    }
+    if (!FlowField->IsBuilt())
+    {
+        FlowField->Build(Nodes, GoalIndex);
+    }
+    return FlowField.Get();
+}
+
+void AGrid::ReleaseFlowField(int32 GoalIndex)
+{
+    FlowFields.Remove(GoalIndex);
+}
+
+void AGrid::FindPathsBatch(TArrayView<FPathRequest> Requests, TArray<int32>& OutPaths, int32 MaxWorkers)
+{
+    BatchSearcher.Run(Nodes, Requests, OutPaths, MaxWorkers);
+}
+
+void AGrid::FindPathsCooperative(TArrayView<FPathRequest> Requests, TArray<int32>& OutPaths)
+{
+    OutPaths.Reset();
+
+    // Units whose goals lie in the same area and region share the field towards the first of those goals, like the
+    // squads of Pathfinding.BenchmarkCooperative. A shared field is a looser heuristic for the others, never a wrong one.
+    const int32 AreaSize = FMath::Max(CooperativeGoalAreaSize, 1);
+    TMap<FIntVector, int32> AreaFieldTiles;
+    TArray<FCooperativeAgent> Agents;
+    Agents.Reserve(Requests.Num());
+    for (const FPathRequest& Request : Requests)
+    {
+        FCooperativeAgent& Agent = Agents.AddDefaulted_GetRef();
+        Agent.StartIndex = Request.StartIndex;
+        Agent.GoalIndex = Request.GoalIndex;
+        if (Nodes.IsValidIndex(Request.GoalIndex) && ConnectedComponents.GetComponent(Request.GoalIndex) != INDEX_NONE)
+        {
+            const FIntVector Area(Nodes.GetGridX(Request.GoalIndex) / AreaSize, Nodes.GetGridY(Request.GoalIndex) / AreaSize,
+                ConnectedComponents.GetComponent(Request.GoalIndex));
+            Agent.HeuristicTile = AreaFieldTiles.FindOrAdd(Area, Request.GoalIndex);
+        }
+    }
+
+    // Units are done long before this unless they are stuck behind each other for good
+    const int32 Window = FMath::Max(CooperativeWindow, 2);
+    CooperativePlanner.Initialize(Nodes, Agents, Window, Window / 2);
+    const int32 NumSteps = CooperativePlanner.Run(8 * GridCount + Window);
+
+    int32 NumArrived = 0;
+    const TArray<TArray<int32>>& Trajectories = CooperativePlanner.GetTrajectories();
+    for (int32 RequestIndex = 0; RequestIndex < Requests.Num(); RequestIndex++)
+    {
+        FPathRequest& Request = Requests[RequestIndex];
+        Request.PathOffset = OutPaths.Num();
+        Request.PathLength = 0;
+        if (!CooperativePlanner.HasArrived(RequestIndex))
+        {
+            continue;
         }
+
+        // The steps spent standing on the goal at the end are left out
+        const TArray<int32>& Trajectory = Trajectories[RequestIndex];
+        int32 Length = Trajectory.Num();
+        while (Length > 1 && Trajectory[Length - 2] == Request.GoalIndex)
+        {
+            Length--;
+        }
+        OutPaths.Append(Trajectory.GetData(), Length);
+        Request.PathLength = Length;
+        NumArrived++;
     }
 
-    // Return an empty path 
-    UE_LOG(LogTemp, Warning, TEXT("FindPath: No valid path found."));
+    UE_LOG(LogPathfinding, Verbose, TEXT("FindPathsCooperative: %d of %d units arrived in %d steps, planning %.2f ms, %d distance fields, %d partial plans"),
+        NumArrived, Requests.Num(), NumSteps, (CooperativePlanner.PlanSeconds + CooperativePlanner.HeuristicSeconds) * 1000.0, AreaFieldTiles.Num(),
+        CooperativePlanner.NumFallbacks);
+}
+
+TArray<UGridNode*> AGrid::FindPath(int32 StartInstanceIndex, int32 GoalInstanceIndex)
+{
+    TArray<UGridNode*> Path;
+    TArray<int32> PathIndices;
+    if (FindPath(StartInstanceIndex, GoalInstanceIndex, PathIndices))
+    {
+        Path.Reserve(PathIndices.Num());
+        for (int32 NodeIndex : PathIndices)
+        {
+            Path.Add(GetNodeView(NodeIndex));
+        }
+    }
     return Path;
 }
 
-// Regenerates the grid
+void AGrid::ResetPathCacheStats()
+{
+    PathCacheHits = 0;
+    PathCacheMisses = 0;
+}
+
+void AGrid::StartWorkloadRecording()
+{
+    // The recording starts from the tiles as they are now; everything after is recorded as it happens
+    WorkloadRecording = MakeShared<FPathWorkload>();
+    WorkloadRecording->AddSnapshot(Nodes, NodeSeed);
+    UE_LOG(LogPathfinding, Log, TEXT("AGrid: Recording pathfinding workload on %d tiles"), Nodes.Num());
+}
+
+bool AGrid::StopWorkloadRecording(const FString& Filename)
+{
+    if (!WorkloadRecording)
+    {
+        return false;
+    }
+
+    TArray<uint8> Blob;
+    WorkloadRecording->SaveToBlob(Blob);
+    const int32 NumEvents = WorkloadRecording->GetEvents().Num();
+    const int32 NumQueries = WorkloadRecording->GetNumQueries();
+    WorkloadRecording.Reset();
+
+    const bool bSaved = FFileHelper::SaveArrayToFile(Blob, *Filename);
+    UE_LOG(LogPathfinding, Log, TEXT("AGrid: Recorded %d events, %d of them queries, %.1f KB to %s%s"), NumEvents, NumQueries, Blob.Num() / 1024.0,
+        *Filename, bSaved ? TEXT("") : TEXT(" (write failed)"));
+    return bSaved;
+}
+
+// Regenerates the grid, which also moves the grid version forward
 void AGrid::UpdateGrid()
 {
     GenerateGrid();
@@ -311,20 +920,61 @@ void AGrid::UpdateGrid()
 
 void AGrid::SetNodeObstacle(int32 InstanceIndex, bool bObstacle)
 {
-    if (UGridNode** NodePtr = NodeMap.Find(InstanceIndex)) // Search for the node 
+    // Make sure the node exists and its state actually changes
+    if (Nodes.IsValidIndex(InstanceIndex) && Nodes.Obstacles[InstanceIndex] != bObstacle)
     {
-        (*NodePtr)->SetObstacle(bObstacle); // Update it's obstacle status
+        Nodes.Obstacles[InstanceIndex] = bObstacle; // Update it's obstacle status
+        if (WorkloadRecording)
+        {
+            WorkloadRecording->AddObstacleEdit(InstanceIndex, bObstacle);
+        }
+        TileChanges.MarkDirty(InstanceIndex, FTileStateBuffer::Appearance);
+        IncrementalPlanner.NotifyNodeChanged(InstanceIndex);
+        HierarchicalPathfinder.NotifyNodeChanged(InstanceIndex);
+        LandmarkHeuristic.NotifyNodeChanged(InstanceIndex);
+        ConnectedComponents.NotifyNodeChanged(InstanceIndex);
+        CooperativePlanner.NotifyNodeChanged(InstanceIndex);
+        for (TPair<int32, TUniquePtr<FFlowField>>& FlowField : FlowFields)
+        {
+            FlowField.Value->NotifyNodeChanged(InstanceIndex);
+        }
+        MarkGridChanged();
     }
 }
 
-void AGrid::RandomizeObstacles(float ObstacleChance, int32 ExcludeIndex1, int32 ExcludeIndex2)
+void AGrid::SetStartTile(int32 InstanceIndex)
+{
+    const int32 NewIndex = Nodes.IsValidIndex(InstanceIndex) ? InstanceIndex : INDEX_NONE;
+    TileChanges.MarkDirty(StartTileIndex, FTileStateBuffer::Appearance);
+    TileChanges.MarkDirty(NewIndex, FTileStateBuffer::Appearance);
+    StartTileIndex = NewIndex;
+}
+
+void AGrid::SetGoalTile(int32 InstanceIndex)
 {
-    if (!InstancedMesh)
+    const int32 NewIndex = Nodes.IsValidIndex(InstanceIndex) ? InstanceIndex : INDEX_NONE;
+    TileChanges.MarkDirty(GoalTileIndex, FTileStateBuffer::Appearance);
+    TileChanges.MarkDirty(NewIndex, FTileStateBuffer::Appearance);
+    GoalTileIndex = NewIndex;
+}
+
+void AGrid::ClearObstacles()
+{
+    bool bAnyObstacle = false;
+    for (int32 i = 0; i < Nodes.Num(); i++)
     {
-        return;
+        bAnyObstacle |= Nodes.Obstacles[i];
+        Nodes.Obstacles[i] = false;
     }
+    if (bAnyObstacle)
+    {
+        NotifyObstaclesRewritten();
+    }
+}
 
-    int32 TotalNodes = InstancedMesh->GetInstanceCount();
+void AGrid::RandomizeObstacles(float ObstacleChance, int32 ExcludeIndex1, int32 ExcludeIndex2)
+{
+    int32 TotalNodes = Nodes.Num();
     for (int32 i = 0; i < TotalNodes; i++)
     {
         if (i == ExcludeIndex1 || i == ExcludeIndex2) // Ensures that the start and goal nodes do not become obstacles
@@ -332,82 +982,127 @@ void AGrid::RandomizeObstacles(float ObstacleChance, int32 ExcludeIndex1, int32
             continue;
         }
 
-        // Generate a random chance for a tile to become an obstacle. If it does, change its appearance
-        bool bIsObstacle = (FMath::FRand() < ObstacleChance);
-        SetNodeObstacle(i, bIsObstacle);
-        float NewValue = bIsObstacle ? 3.0f : 0.0f;
-        InstancedMesh->SetCustomDataValue(i, 0, NewValue, true);
+        // Generate a random chance for a tile to become an obstacle. Its appearance follows at the end of the frame
+        Nodes.Obstacles[i] = (RandomStream.FRand() < ObstacleChance);
+    }
+
+    // Randomizing always counts as an edit, even when every tile kept its state
+    NotifyObstaclesRewritten();
+}
+
+void AGrid::NotifyObstaclesRewritten()
+{
+    TileChanges.MarkAllDirty(FTileStateBuffer::Appearance);
+
+    // Repairing the incremental tree, the clusters, the landmark tables, the regions or the fields one tile at a
+    // time would cost more than starting over. Landmarks that became obstacles are moved on their next update.
+    IncrementalPlanner.Reset();
+    HierarchicalPathfinder.Reset();
+    LandmarkHeuristic.NotifyAllChanged();
+    ConnectedComponents.NotifyAllChanged();
+    ConnectedComponents.Update();
+    for (TPair<int32, TUniquePtr<FFlowField>>& FlowField : FlowFields)
+    {
+        FlowField.Value->NotifyAllChanged();
+    }
+    CooperativePlanner.Reset();
+    MarkGridChanged();
+    if (WorkloadRecording)
+    {
+        WorkloadRecording->AddSnapshot(Nodes, NodeSeed);
     }
 }
 
 void AGrid::RandomizeWeights()
 {
-    int32 TotalNodes = InstancedMesh->GetInstanceCount();
+    int32 TotalNodes = Nodes.Num();
 
     for (int32 i = 0; i < TotalNodes; i++)
     {
-        if (UGridNode** NodePtr = NodeMap.Find(i)) // Find the corresponding UGridNode
-        {
-            UGridNode* Node = *NodePtr;
-            Node->Weight = FMath::RandRange(1.0f, 5.0f); // Assign it a random weight
-            if (NodeTextComponents.IsValidIndex(i))
-            {
-                FString WeightString = FString::Printf(TEXT("%d"), FMath::RoundToInt(Node->Weight));
-                NodeTextComponents[i]->SetText(FText::FromString(WeightString)); // Set the text to represent the weight
-            }
-        }
+        Nodes.Weights[i] = RandomStream.FRandRange(1.0f, 5.0f); // Assign it a random weight
+    }
+    Nodes.UpdateStepCosts();
+    TileChanges.MarkAllDirty(FTileStateBuffer::Label);
+
+    // Every tile changed, so repairing the incremental tree, the clusters, the landmark tables or the flow fields
+    // would cost more than starting over. The landmarks keep their tiles.
+    IncrementalPlanner.Reset();
+    HierarchicalPathfinder.Reset();
+    LandmarkHeuristic.NotifyAllChanged();
+    for (TPair<int32, TUniquePtr<FFlowField>>& FlowField : FlowFields)
+    {
+        FlowField.Value->NotifyAllChanged();
+    }
+    CooperativePlanner.Reset();
+    MarkGridChanged();
+    if (WorkloadRecording)
+    {
+        WorkloadRecording->AddSnapshot(Nodes, NodeSeed);
     }
-    UE_LOG(LogTemp, Log, TEXT("Randomized weights for %d nodes"), TotalNodes);
+    UE_LOG(LogPathfinding, Verbose, TEXT("Randomized weights for %d nodes"), TotalNodes);
 }
 
 void AGrid::RandomizeGrid()
 {
-    GridCount = FMath::RandRange(4, 10); //Random grid size
+    GridCount = RandomStream.RandRange(4, 10); //Random grid size
     UpdateGrid();
 
     int32 TotalNodes = GridCount * GridCount;
     if (TotalNodes < 2)
     {
-        UE_LOG(LogTemp, Warning, TEXT("AGrid: Not enough nodes for random start/goal selection."));
+        UE_LOG(LogPathfinding, Warning, TEXT("AGrid: Not enough nodes for random start/goal selection."));
         return;
     }
 
     // Select a random tile and set it to be the start goal
-    int32 StartIndex = FMath::RandRange(0, TotalNodes - 1);
+    int32 StartIndex = RandomStream.RandRange(0, TotalNodes - 1);
     int32 GoalIndex;
 
     // Select a random tile and set it to be the goal node while the tile selected is not the start node
     do
     {
-        GoalIndex = FMath::RandRange(0, TotalNodes - 1);
+        GoalIndex = RandomStream.RandRange(0, TotalNodes - 1);
     } while (GoalIndex == StartIndex);
 
-    // Set the proper appearances for the start, goal, and neutral tiles
-    if (InstancedMesh)
-    {
-        for (int32 i = 0; i < TotalNodes; i++)
-        {
-            InstancedMesh->SetCustomDataValue(i, 0, 0.0f, true);
-        }
-        InstancedMesh->SetCustomDataValue(StartIndex, 0, 1.0f, true);
-        InstancedMesh->SetCustomDataValue(GoalIndex, 0, 2.0f, true);
-    }
-    else
-    {
-        UE_LOG(LogTemp, Warning, TEXT("AGrid: InstancedMesh not found."));
-    }
+    // The regenerated tiles are all neutral, so only the start and goal need a new appearance
+    SetStartTile(StartIndex);
+    SetGoalTile(GoalIndex);
 
     // Randomize the obstacles in the grid
     float ObstacleChance = 0.3f;
     RandomizeObstacles(ObstacleChance, StartIndex, GoalIndex);
 
-    UE_LOG(LogTemp, Log, TEXT("AGrid: Randomized grid with grid count %d, start index %d, goal index %d."), GridCount, StartIndex, GoalIndex);
+    UE_LOG(LogPathfinding, Verbose, TEXT("AGrid: Randomized grid with grid count %d, start index %d, goal index %d."), GridCount, StartIndex, GoalIndex);
+}
+
+
+// Pathfinding.RecordWorkload [Filename]: starts recording every grid in the world, or stops and saves the recordings
+static void ToggleWorkloadRecording(const TArray<FString>& Args, UWorld* World)
+{
+    if (!World)
+    {
+        return;
+    }
 
-    if (AGridPlayerController* PC = Cast<AGridPlayerController>(GetWorld()->GetFirstPlayerController()))
+    int32 GridNumber = 0;
+    for (TActorIterator<AGrid> It(World); It; ++It, ++GridNumber)
     {
-        // Update the player's Start and Goal node indices to reflect the new grid, allowing for pathfinding to begin
-        PC->StartNodeIndex = StartIndex;
-        PC->GoalNodeIndex = GoalIndex;
+        if (!It->IsRecordingWorkload())
+        {
+            It->StartWorkloadRecording();
+            continue;
+        }
+
+        FString Filename = Args.Num() > 0 ? Args[0] : FPaths::ProjectSavedDir() / TEXT("Workloads") / FString::Printf(TEXT("Pathfinding-%s.pfw"), *FDateTime::Now().ToString());
+        if (GridNumber > 0)
+        {
+            Filename = FPaths::GetBaseFilename(Filename, false) + FString::Printf(TEXT("-%d"), GridNumber) + TEXT(".pfw");
+        }
+        It->StopWorkloadRecording(Filename);
     }
 }
 
+static FAutoConsoleCommandWithWorldAndArgs RecordWorkloadCommand(
+    TEXT("Pathfinding.RecordWorkload"),
+    TEXT("Starts recording the tiles, edits and path queries of every grid, or stops and saves them for replay with -run=PathfindingBenchmark -Replay=<file>. Usage: Pathfinding.RecordWorkload [Filename]"),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ToggleWorkloadRecording));
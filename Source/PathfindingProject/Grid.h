@@ -2,14 +2,89 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
-#include "Components/TextRenderComponent.h"
+#include "Containers/LruCache.h"
+#include "GridNodeStore.h"
+#include "PathSearchContext.h"
+#include "PathQuery.h"
+#include "PathBatch.h"
+#include "IncrementalPathPlanner.h"
+#include "HierarchicalPathfinder.h"
+#include "FlowField.h"
+#include "LandmarkHeuristic.h"
+#include "CompressedPathDatabase.h"
+#include "ConnectedComponents.h"
+#include "CooperativePlanner.h"
+#include "TileStateBuffer.h"
+#include "PathVisualizerComponent.h"
+#include "PathWorkload.h"
+#include "GridFile.h"
 #include "Grid.generated.h"
 
 // Forward declarations.
 class UGridNode;
 class UInstancedStaticMeshComponent;
 class UStaticMesh;
-class UTextRenderComponent; 
+class UMaterialInterface;
+class UTextRenderComponent;
+
+// Which search the synchronous FindPath calls run
+UENUM(BlueprintType)
+enum class EPathSearchMode : uint8
+{
+    // Fresh A* search on every call
+    AStar UMETA(DisplayName = "A*"),
+
+    // Keeps the search tree between calls and only repairs what tile edits invalidated. Best when the
+    // same start and goal are queried again and again while a few tiles change in between.
+    Incremental,
+
+    // Searches a graph of cluster entrances and fills in the tiles afterwards. Much faster on very large
+    // grids, at the price of paths that are a few percent longer than optimal.
+    Hierarchical,
+
+    // A* that crosses open stretches of equally weighted tiles in one step. Same path cost as A*, with far
+    // fewer expansions on maps with large uniform areas. Every border between two weights is a place where
+    // the search has to stop, so on maps with many small weighted patches it only adds scanning overhead.
+    JumpPoint UMETA(DisplayName = "Jump Point"),
+
+    // A* from both ends at once, joined where the two searches meet. Same path cost as A*; on long queries
+    // the two smaller frontiers expand fewer nodes than one search fanning out all the way to the goal.
+    Bidirectional,
+
+    // A* on integer costs with the exact hex-step distance as heuristic. No square roots and exact ties; weights
+    // are rounded to 1/256, so path costs can differ from A* by that rounding.
+    FixedPoint UMETA(DisplayName = "Fixed Point"),
+
+    // A* guided by precomputed costs to and from a few landmark tiles (ALT). Same path cost as A*, with fewer
+    // expansions on weighted maps and mazes. The tables are built on the first query and take about 26 bytes per
+    // tile per landmark; tile edits are repaired before the next query.
+    Landmarks UMETA(DisplayName = "Landmarks (ALT)"),
+
+    // Reads every step from a precomputed table of first moves, with no search at all. Same path cost as A*. Meant
+    // for maps that no longer change: the table is built on a worker thread (or loaded with LoadPathDatabase), takes
+    // one Dijkstra search per tile, and any tile edit retires it. Queries use A* until a table for the grid is ready.
+    PathDatabase UMETA(DisplayName = "Path Database")
+};
+
+// Identifies a cached path: the query's endpoints, the search that answered it and the grid version it was computed
+// against. Modes differ in what they return (Hierarchical paths are not optimal), so one mode's result never stands in for another's.
+struct FPathCacheKey
+{
+    int32 StartIndex;
+    int32 GoalIndex;
+    uint32 GridVersion;
+    EPathSearchMode SearchMode;
+
+    bool operator==(const FPathCacheKey& Other) const
+    {
+        return StartIndex == Other.StartIndex && GoalIndex == Other.GoalIndex && GridVersion == Other.GridVersion && SearchMode == Other.SearchMode;
+    }
+
+    friend uint32 GetTypeHash(const FPathCacheKey& Key)
+    {
+        return HashCombine(HashCombine(HashCombine(GetTypeHash(Key.StartIndex), GetTypeHash(Key.GoalIndex)), GetTypeHash(Key.GridVersion)), GetTypeHash((uint8)Key.SearchMode));
+    }
+};
 
 UCLASS()
 class PATHFINDINGPROJECT_API AGrid : public AActor
@@ -23,6 +98,44 @@ public:
     UPROPERTY(EditAnywhere, Category = "Grid")
     int GridCount;
 
+    // Seed for the random weights, obstacles and start/goal picks, so a level can be replayed exactly. Zero picks
+    // a new seed every time the grid is constructed.
+    UPROPERTY(EditAnywhere, Category = "Grid")
+    int32 RandomSeed;
+
+    // Grid file (see FGridFile) to load the tiles from instead of generating them. GridCount and RandomSeed are then
+    // ignored for the layout and weights; a file that does not load falls back to generating.
+    UPROPERTY(EditAnywhere, Category = "Grid", meta = (FilePathFilter = "hexgrid"))
+    FFilePath GridFile;
+
+    // Number of recent FindPath results kept for repeated queries
+    UPROPERTY(EditAnywhere, Category = "Grid", meta = (ClampMin = "1"))
+    int32 PathCacheSize;
+
+    // Search used by FindPath. In Incremental, Hierarchical, Landmarks and PathDatabase mode FindPathAsync also searches on the
+    // game thread, since their precomputed state lives there and a query is usually cheaper than handing it to a worker.
+    UPROPERTY(EditAnywhere, Category = "Grid")
+    EPathSearchMode SearchMode;
+
+    // Width and height in tiles of the clusters used by the Hierarchical search mode
+    UPROPERTY(EditAnywhere, Category = "Grid", meta = (ClampMin = "2"))
+    int32 HierarchicalClusterSize;
+
+    // Number of landmark tiles used by the Landmarks search mode. More landmarks give a tighter heuristic but
+    // cost more memory, preprocessing and time per expansion.
+    UPROPERTY(EditAnywhere, Category = "Grid", meta = (ClampMin = "1"))
+    int32 NumLandmarks;
+
+    // Number of steps each unit looks ahead in FindPathsCooperative. Longer windows avoid more deadlocks between
+    // units but make every plan more expensive; plans are redone every half window.
+    UPROPERTY(EditAnywhere, Category = "Grid", meta = (ClampMin = "2"))
+    int32 CooperativeWindow;
+
+    // Width and height in tiles of the areas whose goals share one distance field in FindPathsCooperative, so the
+    // fields built follow the number of goal areas rather than units. One gives every goal its own, exact field.
+    UPROPERTY(EditAnywhere, Category = "Grid", meta = (ClampMin = "1"))
+    int32 CooperativeGoalAreaSize;
+
     // Instanced mesh reference to represent tile meshes
     UPROPERTY(EditAnywhere, Category = "Grid")
     UInstancedStaticMeshComponent* InstancedMesh;
@@ -31,18 +144,163 @@ public:
     UPROPERTY(EditAnywhere, Category = "Grid")
     UStaticMesh* TileMesh;
 
+    // One instance per tile showing its weight. Custom data 0 of each instance is the weight rounded to a whole
+    // number, which the label material draws.
+    UPROPERTY(EditAnywhere, Category = "Grid")
+    UInstancedStaticMeshComponent* WeightLabels;
+
+    // Flat quad drawn for every weight label, textured by the label material. Defaults to the engine's plane.
+    UPROPERTY(EditAnywhere, Category = "Grid")
+    UStaticMesh* LabelMesh;
+
+    // Material that draws the digit in custom data 0. Without one the labels use the project's default label
+    // material (see WeightLabelMaterial).
+    UPROPERTY(EditAnywhere, Category = "Grid")
+    UMaterialInterface* LabelMaterial;
+
+    // Shows the weights as a text component per tile when no label material can be found, at the cost of a
+    // component and a draw call per tile. Off by default, so a missing material hides the labels instead.
+    UPROPERTY(EditAnywhere, Category = "Grid")
+    bool bTextLabelFallback;
+
+    // Labels farther than this from the camera are not drawn. Zero draws them at any distance.
+    UPROPERTY(EditAnywhere, Category = "Grid", meta = (ClampMin = "0"))
+    int32 LabelCullDistance;
+
+    // Draws the paths of every agent on this grid, each under its own id. Cleared when the grid is regenerated.
+    UPROPERTY(VisibleAnywhere, Category = "Grid")
+    UPathVisualizerComponent* PathVisualizer;
+
     // Returns the center of the grid.
     FVector GetGridCenter() const { return GridCenter; }
 
-    // A* Pathfinding function that finds the path between a start and goal tile
+    // A* Pathfinding function that finds the path between a start and goal tile, as instance indices from start to goal
+    bool FindPath(int32 StartInstanceIndex, int32 GoalInstanceIndex, TArray<int32>& OutPath);
+
+    // Same search using a context owned by the caller. Reusing the context and the path buffer across
+    // queries means a search does not allocate once both have grown to the size of the grid. A cache miss
+    // still allocates once, to keep a copy of the result in the path cache.
+    // The Incremental and Hierarchical modes use the grid's own search state instead of the context, and the
+    // Bidirectional mode runs its backward search in a context of the grid's.
+    bool FindPath(int32 StartInstanceIndex, int32 GoalInstanceIndex, FPathSearchContext& Context, TArray<int32>& OutPath);
+
+    /* Runs the search on a worker thread against a snapshot of the current tiles, and calls OnComplete on
+       the game thread with the result. Edits made while the query runs do not affect it; the result's
+       GridVersion says which grid it belongs to. Cancel the returned handle when the result is no longer
+       wanted, for example because the player picked a new goal. */
+    FPathQueryHandle FindPathAsync(int32 StartInstanceIndex, int32 GoalInstanceIndex, FOnPathQueryComplete OnComplete);
+
+    /* Solves many independent queries at once, spread over the task graph workers, and packs every path into
+       OutPaths (see FPathRequest for where each one lands). Runs to completion before returning, so the grid
+       cannot change while the batch reads it. MaxWorkers of zero uses every worker thread. */
+    void FindPathsBatch(TArrayView<FPathRequest> Requests, TArray<int32>& OutPaths, int32 MaxWorkers = 0);
+
+    /* Moves the unit of every request from its start to its goal at the same time, so that no two units stand on the
+       same tile or swap tiles at the same step (see FCooperativePlanner). OutPaths is packed like FindPathsBatch, but
+       each path holds the unit's tile at every step, repeated while it waits, and units that arrive early are meant to
+       stay on their goal. PathLength is zero for units that did not reach their goal. */
+    void FindPathsCooperative(TArrayView<FPathRequest> Requests, TArray<int32>& OutPaths);
+
+    /* Returns the flow field towards GoalIndex, for many units heading to the same tile: each one reads its next
+       step from the field instead of searching. The first call for a goal builds the field, later calls repair
+       it after the tile edits made since. The field stays owned by the grid until ReleaseFlowField, and is only
+       brought up to date by calling this again. Null if GoalIndex is not part of the grid. */
+    const FFlowField* BuildFlowField(int32 GoalIndex);
+
+    // Frees the flow field towards GoalIndex once no unit is heading there anymore
+    void ReleaseFlowField(int32 GoalIndex);
+
+    /* Starts building the path database for the current tiles on a worker thread, dropping any build still running
+       for an older grid. The PathDatabase search mode starts one on its own; calling this early, right after the map
+       is loaded, has the table ready by the first query. The result is thrown away if the tiles change before it is done. */
+    void BuildPathDatabaseAsync();
+
+    // Whether the path database matches the current tiles, so PathDatabase queries are answered from it
+    bool IsPathDatabaseReady();
+
+    // Writes the path database to a file, for loading it again instead of building it. False if there is none or the write fails.
+    bool SavePathDatabase(const FString& Filename) const;
+
+    // Reads a path database saved by SavePathDatabase. False if the file is missing or damaged, or was saved for other tiles.
+    bool LoadPathDatabase(const FString& Filename);
+
+    /* Starts recording the tiles, every obstacle edit and every FindPath and FindPathAsync request into a workload
+       that can be replayed headless against any search mode (see FPathWorkload). Replaces a recording in progress. */
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    void StartWorkloadRecording();
+
+    // Stops recording and writes the workload to Filename. False if nothing was being recorded or the write fails.
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    bool StopWorkloadRecording(const FString& Filename);
+
+    UFUNCTION(BlueprintPure, Category = "Grid")
+    bool IsRecordingWorkload() const { return WorkloadRecording.IsValid(); }
+
+    /* Writes the current tiles to a grid file that GridFile or LoadGridFile can load. Weights are rounded to the
+       1/256 steps the file stores. bWithNeighbors stores the neighbor table so loading can copy it instead of
+       computing it; bWithPathDatabase stores a path database for the tiles, building one first if needed. */
+    bool SaveGridFile(const FString& Filename, bool bWithNeighbors = false, bool bWithPathDatabase = false);
+
+    // Replaces the grid with the tiles in a grid file. False, keeping the current grid, if the file does not load.
+    bool LoadGridFile(const FString& Filename);
+
+    /* Whether FindPath would find a path between the two tiles, answered from region labels that follow every obstacle
+       edit, without a search. FindPath and FindPathAsync use it to turn down unreachable goals before searching. */
+    UFUNCTION(BlueprintPure, Category = "Grid")
+    bool AreConnected(int32 StartInstanceIndex, int32 GoalInstanceIndex) const { return ConnectedComponents.AreConnected(StartInstanceIndex, GoalInstanceIndex); }
+
+    // Same search, returning node views for code that still works with UGridNode
     TArray<UGridNode*> FindPath(int32 StartInstanceIndex, int32 GoalInstanceIndex);
 
+    // Goes up every time the tiles change, so results computed against an older grid can be told apart
+    uint32 GetGridVersion() const { return GridVersion; }
+
+    // Number of FindPath calls answered from the path cache, and the number that had to search
+    UFUNCTION(BlueprintPure, Category = "Grid")
+    int32 GetPathCacheHits() const { return PathCacheHits; }
+
+    UFUNCTION(BlueprintPure, Category = "Grid")
+    int32 GetPathCacheMisses() const { return PathCacheMisses; }
+
+    // Sets the hit and miss counters back to zero
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    void ResetPathCacheStats();
+
+    // Read access to the tile data of the grid
+    const FGridNodeStore& GetNodeStore() const { return Nodes; }
+
+    // Returns the UGridNode view of a tile, creating it on first use. Null if the index is not part of the grid.
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    UGridNode* GetNodeView(int32 InstanceIndex);
+
     // Regenerates the grid when changes are made
     void UpdateGrid();
 
     // Toggles a node’s obstacle state.
     void SetNodeObstacle(int32 InstanceIndex, bool bObstacle);
 
+    // Opens every obstacle tile at once, with one update of the search state instead of one per tile
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    void ClearObstacles();
+
+    // Start and goal tiles of the path shown on the grid, INDEX_NONE when unset. Setting one clears the previous
+    // tile with that role; regenerating the grid clears both.
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    void SetStartTile(int32 InstanceIndex);
+
+    UFUNCTION(BlueprintCallable, Category = "Grid")
+    void SetGoalTile(int32 InstanceIndex);
+
+    UFUNCTION(BlueprintPure, Category = "Grid")
+    int32 GetStartTile() const { return StartTileIndex; }
+
+    UFUNCTION(BlueprintPure, Category = "Grid")
+    int32 GetGoalTile() const { return GoalTileIndex; }
+
+    // Sends the tiles edited since the last flush to the instanced meshes. Runs at the end of every frame;
+    // call it directly only when the new look has to be visible before then.
+    void FlushTileChanges();
+
     // Randomly assigns an obstacle state to tiles in the grid
     void RandomizeObstacles(float ObstacleChance, int32 ExcludeIndex1 = -1, int32 ExcludeIndex2 = -1);
 
@@ -60,29 +318,142 @@ protected:
     virtual void OnConstruction(const FTransform& Transform) override;
     virtual void Tick(float DeltaTime) override;
 
-    // Generates the base grid by placing the tiles and initializing their data
+    // Generates the base grid by placing the tiles and initializing their data, or loads them from GridFile if set
     void GenerateGrid();
+
+    // Rebuilds the instances, labels and search state from Nodes after its tiles were generated or loaded.
+    // StartTime is when that began, for the timing log.
+    void ApplyNodes(double StartTime);
     
-    // Deletes all text components (weight values) currently attached to the grid
+    // Places one weight label above every tile, as instances of LabelMesh or, without a label material, as text components
+    void GenerateWeightLabels();
+
+    // Deletes the fallback text labels
     void ClearTextComponents();
 
-    // Generates a text component for a specific tile to display its weight
-    UTextRenderComponent* CreateTextComponentForNode(UGridNode* Node);
-    
-    // Connects tiles to their adjacent neighbors
-    void BuildNeighbors();
+    // Creates the fallback text label for a tile, showing its weight
+    UTextRenderComponent* CreateTextComponentForNode(int32 NodeIndex);
+
+    // Tile color stored in the tile's custom data for its current state: 0 neutral, 1 start, 2 goal, 3 obstacle
+    float GetTileAppearance(int32 InstanceIndex) const;
+
+    // Detaches and forgets every node view handed out for the previous grid
+    void ClearNodeViews();
 
 private:
-    // A 2D array of UGridNode pointers, each corresponding to a tile in the grid
-    TArray<TArray<UGridNode*>> GridNodes;
+    // Flat per-tile data for the whole grid, indexed by instance index
+    FGridNodeStore Nodes;
+
+    // Increments the grid version, which retires every cached path
+    void MarkGridChanged() { GridVersion++; }
+
+    // Passes an edit of the obstacles of most of the grid on at once: the search state starts over rather than
+    // repairing tile by tile, and every tile is redrawn
+    void NotifyObstaclesRewritten();
+
+    // Runs the search selected by SearchMode, without the cache
+    bool RunSearch(int32 StartInstanceIndex, int32 GoalInstanceIndex, FPathSearchContext& Context, TArray<int32>& OutPath);
+
+    // Runs the incremental planner, starting a new search tree if the endpoints differ from the last call
+    bool FindPathIncremental(int32 StartInstanceIndex, int32 GoalInstanceIndex, TArray<int32>& OutPath);
+
+    // Runs the hierarchical search, building the clusters first if the grid or the cluster size changed
+    bool FindPathHierarchical(int32 StartInstanceIndex, int32 GoalInstanceIndex, TArray<int32>& OutPath);
 
-    /*A hash map that maps the index of each tile in the Instanced Static Mesh Component
-      to its corresponding UGridNode*/
-    TMap<int32, UGridNode*> NodeMap;
+    // Runs A* with the landmark heuristic, placing the landmarks first if there are none or their number changed
+    bool FindPathLandmarks(int32 StartInstanceIndex, int32 GoalInstanceIndex, FPathSearchContext& Context, TArray<int32>& OutPath);
+
+    // Looks the path up in the path database if it matches the grid, and otherwise starts building one and runs A*
+    bool FindPathDatabase(int32 StartInstanceIndex, int32 GoalInstanceIndex, FPathSearchContext& Context, TArray<int32>& OutPath);
+
+    // Version of the tile data, bumped by every edit
+    uint32 GridVersion = 0;
+
+    // Recent FindPath results keyed on start, goal, search mode and grid version. An empty path records an unreachable goal.
+    TLruCache<FPathCacheKey, TArray<int32>> PathCache;
+
+    int32 PathCacheHits = 0;
+    int32 PathCacheMisses = 0;
+
+    // Returns an immutable copy of the tiles for worker threads, made again only after the grid has changed. Only the
+    // weights, obstacles and step costs are copied; positions and neighbors are shared with the grid.
+    TSharedRef<const FGridNodeStore> GetNodeSnapshot();
+
+    /* Copy of the tiles shared with asynchronous queries, and the grid version it was taken at. Dropped before the
+       grid is rebuilt or loaded, so the grid's positions and neighbors are not shared and are rewritten in place. */
+    TSharedPtr<const FGridNodeStore> NodeSnapshot;
+    uint32 NodeSnapshotVersion = 0;
+
+    // Warm search contexts for asynchronous queries. Shared with the tasks, so it outlives the grid if a query does.
+    TSharedRef<FPathSearchContextPool> AsyncContextPool = MakeShared<FPathSearchContextPool>();
+
+    // Per-worker search state for FindPathsBatch, kept warm between batches
+    FPathBatchSearcher BatchSearcher;
+
+    // Reservations and distance fields for FindPathsCooperative. The fields are kept between calls and follow tile edits.
+    FCooperativePlanner CooperativePlanner;
+
+    // Scratch state reused by every FindPath call that does not bring its own context
+    FPathSearchContext SearchContext;
+
+    // Scratch state for the backward half of Bidirectional searches on the game thread
+    FPathSearchContext ReverseSearchContext;
+
+    // Flow fields handed out by BuildFlowField, by goal. Tile edits are queued on each of them as they happen.
+    TMap<int32, TUniquePtr<FFlowField>> FlowFields;
+
+    // Search tree kept between calls in Incremental mode. Tile edits are passed on to it as they happen.
+    FIncrementalPathPlanner IncrementalPlanner;
+
+    // Clusters for Hierarchical mode, built on the first hierarchical query. Edited tiles mark their clusters for rebuilding.
+    FHierarchicalPathfinder HierarchicalPathfinder;
+
+    // Landmark tables for Landmarks mode, built on the first landmark query. Tile edits are queued on them as they happen.
+    FLandmarkHeuristic LandmarkHeuristic;
+
+    // Region label of every open tile, built with the grid and updated on every obstacle edit
+    FConnectedComponents ConnectedComponents;
+
+    // First-move table for PathDatabase mode. It does not follow edits, so whether it matches the tiles is checked
+    // once per grid version, against the grid it was built for.
+    FCompressedPathDatabase PathDatabase;
+    uint32 PathDatabaseCheckedVersion = 0;
+    bool bPathDatabaseMatchesGrid = false;
+
+    // Cancel flag of the background build in flight, if any, and the grid version it builds for
+    TSharedPtr<std::atomic<bool>> PathDatabaseBuildCancelFlag;
+    uint32 PathDatabaseBuildVersion = 0;
+
+    // Node views created by GetNodeView, kept so repeated lookups return the same object
+    UPROPERTY(Transient)
+    TMap<int32, TObjectPtr<UGridNode>> NodeViews;
 
     // Stores the center point of the grid 
     FVector GridCenter;
 
-    // Stores an array of Text Render Components for the tiles
+    // Tiles holding the start and goal roles, INDEX_NONE when unset
+    int32 StartTileIndex = INDEX_NONE;
+    int32 GoalTileIndex = INDEX_NONE;
+
+    // Tiles whose color or label changed since the last frame, uploaded by FlushTileChanges
+    FTileStateBuffer TileChanges;
+
+    // Fallback weight labels, one per tile, used while no label material is set
     TArray<UTextRenderComponent*> NodeTextComponents;
+
+    // LabelMaterial, or the default label material when it is unset. Null if neither can be found.
+    UMaterialInterface* GetLabelMaterial();
+
+    // The default label material, loaded or built on first use
+    UPROPERTY(Transient)
+    UMaterialInterface* DefaultLabelMaterial;
+
+    // Source of every random choice the grid makes, seeded from RandomSeed when the grid is constructed
+    FRandomStream RandomStream;
+
+    // Seed the node store was last built with, kept for workload snapshots
+    int32 NodeSeed = 0;
+
+    // Workload being recorded, if any. Asynchronous queries hold it weakly to fill in their time when they finish.
+    TSharedPtr<FPathWorkload> WorkloadRecording;
 };
@@ -0,0 +1,659 @@
+#include "GridChunkWorld.h"
+#include "GridFile.h"
+#include "PathfindingStats.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+
+// Open stretches of border at least this many edges long get a transition at each end instead of one in the middle,
+// like FHierarchicalPathfinder does
+static constexpr int32 MinLongEntranceLength = 6;
+
+FGridChunkWorld::FChunkLoader FGridChunkWorld::MakeProceduralLoader(int32 Seed, float ObstacleDensity)
+{
+    return [Seed, ObstacleDensity](FIntPoint Chunk, int32 ChunkSize, FGridNodeStore& OutNodes)
+    {
+        // Each chunk draws from its own seed, so it comes out the same whenever and however often it is loaded
+        const int32 ChunkSeed = (int32)HashCombine(HashCombine((uint32)Seed, (uint32)Chunk.X), (uint32)Chunk.Y);
+        OutNodes.Build(ChunkSize, ChunkSeed);
+        FRandomStream Random(ChunkSeed);
+        for (int32 Index = 0; Index < OutNodes.Num(); Index++)
+        {
+            OutNodes.Obstacles[Index] = Random.FRand() < ObstacleDensity;
+        }
+    };
+}
+
+FGridChunkWorld::FChunkLoader FGridChunkWorld::MakeFileLoader(const FString& Directory)
+{
+    return [Directory](FIntPoint Chunk, int32 ChunkSize, FGridNodeStore& OutNodes)
+    {
+        const FString Filename = GetChunkFilename(Directory, Chunk);
+        if (FGridFile::Load(Filename, OutNodes) && OutNodes.GetGridCount() == ChunkSize)
+        {
+            return;
+        }
+
+        // A hole in the world is walled off rather than left open, so no path runs through tiles nobody authored
+        UE_LOG(LogPathfinding, Warning, TEXT("FGridChunkWorld: %s is missing or not %d x %d tiles, treating chunk %d,%d as solid"),
+            *Filename, ChunkSize, ChunkSize, Chunk.X, Chunk.Y);
+        OutNodes.Build(ChunkSize, 0);
+        for (int32 Index = 0; Index < OutNodes.Num(); Index++)
+        {
+            OutNodes.Obstacles[Index] = true;
+        }
+    };
+}
+
+FString FGridChunkWorld::GetChunkFilename(const FString& Directory, FIntPoint Chunk)
+{
+    return Directory / FString::Printf(TEXT("Chunk_%d_%d.hexgrid"), Chunk.X, Chunk.Y);
+}
+
+void FGridChunkWorld::Initialize(int32 InNumChunks, int32 InChunkSize, FChunkLoader InLoader, SIZE_T InMemoryBudget)
+{
+    Reset();
+    NumChunks = FMath::Max(InNumChunks, 1);
+
+    // Odd rows are shifted, so a chunk has to start on an even row for its local neighbors to be the world's
+    ChunkSize = FMath::Max(Align(InChunkSize, 2), 2);
+    Loader = MoveTemp(InLoader);
+    MemoryBudget = InMemoryBudget;
+
+    const double StartTime = FPlatformTime::Seconds();
+    BuildPortalGraph();
+    BuildSeconds = FPlatformTime::Seconds() - StartTime;
+
+    // The chunks the build left resident stay warm for the first queries, but its traffic is reported on its own
+    Stats.NumBuildLoads = Stats.NumLoads;
+    Stats.NumLoads = 0;
+    Stats.NumEvictions = 0;
+    Stats.NumHits = 0;
+
+    UE_LOG(LogPathfinding, Log, TEXT("FGridChunkWorld: %d x %d chunks of %d tiles, %d portals, portal graph %.1f KB, built in %.1f ms with %d chunk loads"),
+        NumChunks, NumChunks, ChunkSize, Portals.Num(), GetPortalGraphSize() / 1024.0, BuildSeconds * 1000.0, Stats.NumBuildLoads);
+}
+
+void FGridChunkWorld::Reset()
+{
+    Resident.Reset();
+    Summaries.Reset();
+    Portals.Reset();
+    NumChunks = 0;
+    ChunkSize = 0;
+    ChunkBytes = 0;
+    UseCounter = 0;
+    Stats = FGridChunkWorldStats();
+    UpdateStats();
+}
+
+void FGridChunkWorld::SetMemoryBudget(SIZE_T InMemoryBudget)
+{
+    MemoryBudget = InMemoryBudget;
+    EvictToBudget(0);
+    UpdateStats();
+}
+
+void FGridChunkWorld::SetAreasOfInterest(TArrayView<const FIntPoint> Tiles, int32 RadiusInChunks)
+{
+    TSet<int32> Wanted;
+    for (const FIntPoint& Tile : Tiles)
+    {
+        if (!IsValidTile(Tile))
+        {
+            continue;
+        }
+        const FIntPoint Center = GetChunkOf(Tile);
+        for (int32 X = FMath::Max(Center.X - RadiusInChunks, 0); X <= FMath::Min(Center.X + RadiusInChunks, NumChunks - 1); X++)
+        {
+            for (int32 Y = FMath::Max(Center.Y - RadiusInChunks, 0); Y <= FMath::Min(Center.Y + RadiusInChunks, NumChunks - 1); Y++)
+            {
+                Wanted.Add(GetChunkIndex(FIntPoint(X, Y)));
+            }
+        }
+    }
+
+    // Release the chunks that are no longer wanted first, so they are the ones evicted to make room for the new ones
+    for (TPair<int32, TUniquePtr<FResidentChunk>>& Pair : Resident)
+    {
+        Pair.Value->bPinned = Wanted.Contains(Pair.Key);
+    }
+    for (int32 ChunkIndex : Wanted)
+    {
+        AcquireChunk(FIntPoint(ChunkIndex / NumChunks, ChunkIndex % NumChunks)).bPinned = true;
+    }
+}
+
+bool FGridChunkWorld::FindPath(FIntPoint Start, FIntPoint Goal, TArray<FIntPoint>& OutPath)
+{
+    SCOPE_CYCLE_COUNTER(STAT_PathfindingSearch);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FGridChunkWorld_FindPath, PathfindingChannel);
+    INC_DWORD_STAT(STAT_PathfindingQueries);
+
+    OutPath.Reset();
+    NumExpanded = 0;
+    if (!IsValidTile(Start) || !IsValidTile(Goal))
+    {
+        return false;
+    }
+    if (Start == Goal)
+    {
+        OutPath.Add(Start);
+        return true;
+    }
+
+    // Connect the goal to the portals of its chunk. The search runs backwards, so the costs are from each portal to the goal.
+    const FIntPoint StartChunk = GetChunkOf(Start);
+    const FIntPoint GoalChunk = GetChunkOf(Goal);
+    {
+        const FResidentChunk& Chunk = AcquireChunk(GoalChunk);
+        if (Chunk.Nodes.Obstacles[GetLocalIndex(Goal)])
+        {
+            return false;
+        }
+        RunChunkSearch(Chunk.Nodes, GetLocalIndex(Goal), true);
+    }
+    GoalPortalCosts.Reset();
+    for (int32 Portal : Summaries[GetChunkIndex(GoalChunk)].Portals)
+    {
+        const float Cost = ChunkCosts[GetLocalIndex(Portals[Portal].Tile)];
+        if (Cost != TNumericLimits<float>::Max())
+        {
+            GoalPortalCosts.Add(Portal, Cost);
+        }
+    }
+
+    // And the start to the portals of its own, and to the goal directly when they share a chunk
+    float DirectCost = TNumericLimits<float>::Max();
+    {
+        const FResidentChunk& Chunk = AcquireChunk(StartChunk);
+        RunChunkSearch(Chunk.Nodes, GetLocalIndex(Start), false);
+    }
+    StartPortalCosts.Reset();
+    for (int32 Portal : Summaries[GetChunkIndex(StartChunk)].Portals)
+    {
+        const float Cost = ChunkCosts[GetLocalIndex(Portals[Portal].Tile)];
+        if (Cost != TNumericLimits<float>::Max())
+        {
+            StartPortalCosts.Add(Portal, Cost);
+        }
+    }
+    if (StartChunk == GoalChunk)
+    {
+        DirectCost = ChunkCosts[GetLocalIndex(Goal)];
+    }
+
+    // A* over the portals, with the start and goal as two extra nodes after them
+    const int32 StartNode = Portals.Num();
+    const int32 GoalNode = Portals.Num() + 1;
+    auto GetNodeTile = [this, StartNode, &Start, &Goal](int32 Node)
+    {
+        return Node == StartNode ? Start : Node < StartNode ? Portals[Node].Tile : Goal;
+    };
+
+    AbstractContext.BeginQuery(Portals.Num() + 2);
+    auto IsBetterNode = [this](int32 A, int32 B)
+    {
+        return AbstractContext.IsBetterNode(A, B);
+    };
+
+    const FVector GoalPosition = FGridNodeStore::GetTileLocation(Goal.X, Goal.Y);
+    auto Relax = [this, &IsBetterNode, &GetNodeTile, &GoalPosition](int32 From, float FromCost, int32 To, float StepCost)
+    {
+        if (StepCost == TNumericLimits<float>::Max())
+        {
+            return;
+        }
+
+        FPathSearchContext::FNodeState& ToState = AbstractContext.GetNode(To);
+        const float TentativeGCost = FromCost + StepCost;
+        if (!ToState.bClosed && TentativeGCost < ToState.GCost)
+        {
+            const FIntPoint Tile = GetNodeTile(To);
+            ToState.GCost = TentativeGCost;
+            ToState.HCost = FVector::Dist(FGridNodeStore::GetTileLocation(Tile.X, Tile.Y), GoalPosition);
+            ToState.Parent = From;
+            if (AbstractContext.OpenSet.Contains(To))
+            {
+                AbstractContext.OpenSet.DecreaseKey(To, IsBetterNode);
+            }
+            else
+            {
+                AbstractContext.OpenSet.Push(To, IsBetterNode);
+            }
+        }
+    };
+
+    FPathSearchContext::FNodeState& StartState = AbstractContext.GetNode(StartNode);
+    StartState.GCost = 0.0f;
+    StartState.HCost = FVector::Dist(FGridNodeStore::GetTileLocation(Start.X, Start.Y), GoalPosition);
+    AbstractContext.OpenSet.Push(StartNode, IsBetterNode);
+
+    bool bReachedGoal = false;
+    while (!AbstractContext.OpenSet.IsEmpty())
+    {
+        const int32 Current = AbstractContext.OpenSet.Pop(IsBetterNode);
+        FPathSearchContext::FNodeState& CurrentState = AbstractContext.GetNode(Current);
+        CurrentState.bClosed = true;
+        NumExpanded++;
+
+        if (Current == GoalNode)
+        {
+            bReachedGoal = true;
+            break;
+        }
+
+        const float CurrentCost = CurrentState.GCost;
+        if (Current == StartNode)
+        {
+            for (const TPair<int32, float>& Pair : StartPortalCosts)
+            {
+                Relax(Current, CurrentCost, Pair.Key, Pair.Value);
+            }
+            Relax(Current, CurrentCost, GoalNode, DirectCost);
+            continue;
+        }
+
+        for (const FPortalEdge& Edge : Portals[Current].Edges)
+        {
+            Relax(Current, CurrentCost, Edge.ToPortal, Edge.Cost);
+        }
+        if (const float* GoalCost = GoalPortalCosts.Find(Current))
+        {
+            Relax(Current, CurrentCost, GoalNode, *GoalCost);
+        }
+    }
+    INC_DWORD_STAT_BY(STAT_PathfindingNodesExpanded, NumExpanded);
+
+    if (!bReachedGoal)
+    {
+        return false;
+    }
+
+    // Fill in the tiles chunk by chunk. Steps between chunks are single border crossings, and a start that is
+    // itself a portal shows up twice in a row.
+    AbstractContext.BuildPath(GoalNode, AbstractPath);
+    OutPath.Add(Start);
+    for (int32 i = 1; i < AbstractPath.Num(); i++)
+    {
+        const FIntPoint From = GetNodeTile(AbstractPath[i - 1]);
+        const FIntPoint To = GetNodeTile(AbstractPath[i]);
+        if (From == To)
+        {
+            continue;
+        }
+        if (GetChunkOf(From) != GetChunkOf(To))
+        {
+            OutPath.Add(To);
+        }
+        else if (!RefineSegment(From, To, OutPath))
+        {
+            OutPath.Reset();
+            return false;
+        }
+    }
+    SET_DWORD_STAT(STAT_PathfindingPathLength, OutPath.Num());
+    return true;
+}
+
+double FGridChunkWorld::GetPathCost(TArrayView<const FIntPoint> Path)
+{
+    double Cost = 0.0;
+    for (int32 i = 1; i < Path.Num(); i++)
+    {
+        const float Weight = AcquireChunk(GetChunkOf(Path[i])).Nodes.Weights[GetLocalIndex(Path[i])];
+        Cost += FVector::Dist(FGridNodeStore::GetTileLocation(Path[i - 1].X, Path[i - 1].Y), FGridNodeStore::GetTileLocation(Path[i].X, Path[i].Y)) * Weight;
+    }
+    return Cost;
+}
+
+SIZE_T FGridChunkWorld::GetPortalGraphSize() const
+{
+    SIZE_T Size = Summaries.GetAllocatedSize() + Portals.GetAllocatedSize();
+    for (const FChunkSummary& Summary : Summaries)
+    {
+        Size += Summary.Left.GetAllocatedSize() + Summary.Right.GetAllocatedSize() + Summary.Bottom.GetAllocatedSize() + Summary.Top.GetAllocatedSize()
+            + Summary.Portals.GetAllocatedSize();
+    }
+    for (const FPortal& Portal : Portals)
+    {
+        Size += Portal.Edges.GetAllocatedSize();
+    }
+    return Size;
+}
+
+FGridChunkWorld::FResidentChunk& FGridChunkWorld::AcquireChunk(FIntPoint Chunk)
+{
+    const int32 ChunkIndex = GetChunkIndex(Chunk);
+    if (TUniquePtr<FResidentChunk>* Found = Resident.Find(ChunkIndex))
+    {
+        (*Found)->LastUsed = ++UseCounter;
+        Stats.NumHits++;
+        return **Found;
+    }
+
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FGridChunkWorld_LoadChunk, PathfindingChannel);
+    EvictToBudget(ChunkBytes);
+
+    TUniquePtr<FResidentChunk> NewChunk = MakeUnique<FResidentChunk>();
+    Loader(Chunk, ChunkSize, NewChunk->Nodes);
+    NewChunk->Bytes = sizeof(FResidentChunk) + NewChunk->Nodes.GetAllocatedSize();
+    NewChunk->LastUsed = ++UseCounter;
+    ChunkBytes = NewChunk->Bytes;
+
+    Stats.NumLoads++;
+    Stats.ResidentBytes += NewChunk->Bytes;
+    Stats.PeakResidentBytes = FMath::Max(Stats.PeakResidentBytes, Stats.ResidentBytes);
+    INC_DWORD_STAT(STAT_PathfindingChunkLoads);
+
+    FResidentChunk& Loaded = *Resident.Add(ChunkIndex, MoveTemp(NewChunk));
+    UpdateStats();
+    return Loaded;
+}
+
+void FGridChunkWorld::EvictToBudget(SIZE_T IncomingBytes)
+{
+    while (Resident.Num() > 0 && Stats.ResidentBytes + IncomingBytes > MemoryBudget)
+    {
+        // A linear scan is fine: a budget holds tens of chunks, and loading one costs far more
+        int32 Oldest = INDEX_NONE;
+        uint64 OldestUse = MAX_uint64;
+        for (const TPair<int32, TUniquePtr<FResidentChunk>>& Pair : Resident)
+        {
+            if (!Pair.Value->bPinned && Pair.Value->LastUsed < OldestUse)
+            {
+                Oldest = Pair.Key;
+                OldestUse = Pair.Value->LastUsed;
+            }
+        }
+
+        // Everything left is around an area of interest, so the budget is exceeded rather than dropping those
+        if (Oldest == INDEX_NONE)
+        {
+            break;
+        }
+
+        Stats.ResidentBytes -= Resident[Oldest]->Bytes;
+        Stats.NumEvictions++;
+        INC_DWORD_STAT(STAT_PathfindingChunkEvictions);
+        Resident.Remove(Oldest);
+    }
+    UpdateStats();
+}
+
+float FGridChunkWorld::GetBorderWeight(FIntPoint Tile) const
+{
+    const FChunkSummary& Summary = Summaries[GetChunkIndex(GetChunkOf(Tile))];
+    const int32 LocalX = Tile.X % ChunkSize;
+    const int32 LocalY = Tile.Y % ChunkSize;
+    if (LocalX == 0)
+    {
+        return Summary.Left[LocalY];
+    }
+    if (LocalX == ChunkSize - 1)
+    {
+        return Summary.Right[LocalY];
+    }
+    if (LocalY == 0)
+    {
+        return Summary.Bottom[LocalX];
+    }
+    if (ensure(LocalY == ChunkSize - 1))
+    {
+        return Summary.Top[LocalX];
+    }
+    return -1.0f;
+}
+
+void FGridChunkWorld::BuildPortalGraph()
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FGridChunkWorld_BuildPortalGraph, PathfindingChannel);
+
+    // One pass over the chunks in index order. Each chunk is summarized when it loads, and the transitions to the
+    // touching chunks before it are placed from the summaries. Every chunk touching one comes at most NumChunks + 1
+    // after it, so by then its portals are final and the costs between them can be searched. Chunks go through the
+    // resident set like any other load: a budget of NumChunks + 2 chunks still holds the chunk by then, and a smaller
+    // one reloads it rather than going over.
+    Summaries.SetNum(NumChunks * NumChunks);
+    TMap<FIntPoint, int32> PortalOfTile;
+    TArray<TPair<FIntPoint, FIntPoint>> Candidates;
+    for (int32 ChunkIndex = 0; ChunkIndex < Summaries.Num(); ChunkIndex++)
+    {
+        const FIntPoint Chunk(ChunkIndex / NumChunks, ChunkIndex % NumChunks);
+        {
+            const FGridNodeStore& Nodes = AcquireChunk(Chunk).Nodes;
+            auto GetWeight = [&Nodes](int32 X, int32 Y)
+            {
+                const int32 Index = Nodes.GetIndex(X, Y);
+                return Nodes.Obstacles[Index] ? -1.0f : Nodes.Weights[Index];
+            };
+
+            FChunkSummary& Summary = Summaries[ChunkIndex];
+            Summary.Left.SetNumUninitialized(ChunkSize);
+            Summary.Right.SetNumUninitialized(ChunkSize);
+            Summary.Bottom.SetNumUninitialized(ChunkSize);
+            Summary.Top.SetNumUninitialized(ChunkSize);
+            for (int32 i = 0; i < ChunkSize; i++)
+            {
+                Summary.Left[i] = GetWeight(0, i);
+                Summary.Right[i] = GetWeight(ChunkSize - 1, i);
+                Summary.Bottom[i] = GetWeight(i, 0);
+                Summary.Top[i] = GetWeight(i, ChunkSize - 1);
+            }
+        }
+
+        // Borders can touch all eight surrounding chunks, since odd rows reach diagonally into the next column
+        for (int32 OffsetX = -1; OffsetX <= 1; OffsetX++)
+        {
+            for (int32 OffsetY = -1; OffsetY <= 1; OffsetY++)
+            {
+                const FIntPoint Earlier(Chunk.X + OffsetX, Chunk.Y + OffsetY);
+                if (Earlier.X >= 0 && Earlier.Y >= 0 && Earlier.X < NumChunks && Earlier.Y < NumChunks && GetChunkIndex(Earlier) < ChunkIndex)
+                {
+                    AddTransitions(Earlier, Chunk, PortalOfTile, Candidates);
+                }
+            }
+        }
+
+        if (ChunkIndex > NumChunks)
+        {
+            AddChunkEdges(ChunkIndex - NumChunks - 1);
+        }
+    }
+    for (int32 ChunkIndex = FMath::Max(Summaries.Num() - NumChunks - 1, 0); ChunkIndex < Summaries.Num(); ChunkIndex++)
+    {
+        AddChunkEdges(ChunkIndex);
+    }
+
+    for (FPortal& Portal : Portals)
+    {
+        Portal.Edges.Shrink();
+    }
+}
+
+void FGridChunkWorld::AddTransitions(FIntPoint Chunk, FIntPoint Other, TMap<FIntPoint, int32>& PortalOfTile, TArray<TPair<FIntPoint, FIntPoint>>& Candidates)
+{
+    const int32 WorldSize = GetWorldSize();
+    auto GetTileIndex = [WorldSize](FIntPoint Tile)
+    {
+        return Tile.X * WorldSize + Tile.Y;
+    };
+    auto IsSameOrAdjacent = [](FIntPoint A, FIntPoint B)
+    {
+        for (int32 Direction = 0; Direction < FGridNodeStore::NumDirections; Direction++)
+        {
+            if (FGridNodeStore::GetNeighborCoords(A.X, A.Y, Direction) == B)
+            {
+                return true;
+            }
+        }
+        return A == B;
+    };
+
+    // Every open edge from a border tile of Chunk into Other, walking the border in tile order
+    Candidates.Reset();
+    for (int32 X = Chunk.X * ChunkSize; X < (Chunk.X + 1) * ChunkSize; X++)
+    {
+        const bool bSideColumn = X == Chunk.X * ChunkSize || X == (Chunk.X + 1) * ChunkSize - 1;
+        for (int32 Y = Chunk.Y * ChunkSize; Y < (Chunk.Y + 1) * ChunkSize; Y += bSideColumn ? 1 : ChunkSize - 1)
+        {
+            const FIntPoint Inside(X, Y);
+            if (GetBorderWeight(Inside) < 0.0f)
+            {
+                continue;
+            }
+            for (int32 Direction = 0; Direction < FGridNodeStore::NumDirections; Direction++)
+            {
+                const FIntPoint Outside = FGridNodeStore::GetNeighborCoords(X, Y, Direction);
+                if (IsValidTile(Outside) && GetChunkOf(Outside) == Other && GetBorderWeight(Outside) >= 0.0f)
+                {
+                    Candidates.Emplace(Inside, Outside);
+                }
+            }
+        }
+    }
+    Candidates.Sort([&GetTileIndex](const TPair<FIntPoint, FIntPoint>& A, const TPair<FIntPoint, FIntPoint>& B)
+    {
+        return A.Key != B.Key ? GetTileIndex(A.Key) < GetTileIndex(B.Key) : GetTileIndex(A.Value) < GetTileIndex(B.Value);
+    });
+
+    // Split the edges into unbroken stretches and place the transitions of each one
+    auto AddTransition = [this, &PortalOfTile](const TPair<FIntPoint, FIntPoint>& Transition)
+    {
+        const int32 Inside = AddPortal(Transition.Key, PortalOfTile);
+        const int32 Outside = AddPortal(Transition.Value, PortalOfTile);
+        const float Distance = FVector::Dist(FGridNodeStore::GetTileLocation(Transition.Key.X, Transition.Key.Y),
+            FGridNodeStore::GetTileLocation(Transition.Value.X, Transition.Value.Y));
+        Portals[Inside].Edges.Add({ Outside, Distance * GetBorderWeight(Transition.Value) });
+        Portals[Outside].Edges.Add({ Inside, Distance * GetBorderWeight(Transition.Key) });
+    };
+    int32 RunStart = 0;
+    for (int32 i = 1; i <= Candidates.Num(); i++)
+    {
+        const bool bRunEnds = i == Candidates.Num()
+            || !IsSameOrAdjacent(Candidates[i - 1].Key, Candidates[i].Key)
+            || !IsSameOrAdjacent(Candidates[i - 1].Value, Candidates[i].Value);
+        if (!bRunEnds)
+        {
+            continue;
+        }
+
+        const int32 RunLength = i - RunStart;
+        if (RunLength >= MinLongEntranceLength)
+        {
+            AddTransition(Candidates[RunStart]);
+            AddTransition(Candidates[i - 1]);
+        }
+        else
+        {
+            AddTransition(Candidates[RunStart + RunLength / 2]);
+        }
+        RunStart = i;
+    }
+}
+
+void FGridChunkWorld::AddChunkEdges(int32 ChunkIndex)
+{
+    const TArray<int32>& ChunkPortals = Summaries[ChunkIndex].Portals;
+    if (ChunkPortals.Num() < 2)
+    {
+        return;
+    }
+
+    // One search from every portal gives its costs to the other portals of the chunk
+    const FGridNodeStore& Nodes = AcquireChunk(FIntPoint(ChunkIndex / NumChunks, ChunkIndex % NumChunks)).Nodes;
+    for (int32 From : ChunkPortals)
+    {
+        RunChunkSearch(Nodes, GetLocalIndex(Portals[From].Tile), false);
+        for (int32 To : ChunkPortals)
+        {
+            const float Cost = ChunkCosts[GetLocalIndex(Portals[To].Tile)];
+            if (To != From && Cost != TNumericLimits<float>::Max())
+            {
+                Portals[From].Edges.Add({ To, Cost });
+            }
+        }
+    }
+}
+
+int32 FGridChunkWorld::AddPortal(FIntPoint Tile, TMap<FIntPoint, int32>& PortalOfTile)
+{
+    if (const int32* Found = PortalOfTile.Find(Tile))
+    {
+        return *Found;
+    }
+    const int32 Portal = Portals.Add({ Tile, {} });
+    PortalOfTile.Add(Tile, Portal);
+    Summaries[GetChunkIndex(GetChunkOf(Tile))].Portals.Add(Portal);
+    return Portal;
+}
+
+void FGridChunkWorld::RunChunkSearch(const FGridNodeStore& Nodes, int32 Source, bool bReverse)
+{
+    const int32 NumLocal = Nodes.Num();
+    ChunkCosts.SetNumUninitialized(NumLocal, false);
+    for (int32 Local = 0; Local < NumLocal; Local++)
+    {
+        ChunkCosts[Local] = TNumericLimits<float>::Max();
+    }
+    ChunkOpenSet.Reserve(NumLocal);
+    ChunkOpenSet.Clear();
+
+    auto IsCheaper = [this](int32 A, int32 B)
+    {
+        return ChunkCosts[A] < ChunkCosts[B];
+    };
+
+    ChunkCosts[Source] = 0.0f;
+    ChunkOpenSet.Push(Source, IsCheaper);
+    while (!ChunkOpenSet.IsEmpty())
+    {
+        const int32 Current = ChunkOpenSet.Pop(IsCheaper);
+        for (int32 Neighbor : Nodes.GetNeighbors(Current))
+        {
+            if (Neighbor == INDEX_NONE || Nodes.Obstacles[Neighbor])
+            {
+                continue;
+            }
+
+            // Entering a tile is charged its weight, so walking backwards charges the tile being left
+            const float StepCost = FVector::Dist(Nodes.Positions[Current], Nodes.Positions[Neighbor]) * Nodes.Weights[bReverse ? Current : Neighbor];
+            const float NewCost = ChunkCosts[Current] + StepCost;
+            if (NewCost < ChunkCosts[Neighbor])
+            {
+                ChunkCosts[Neighbor] = NewCost;
+                if (ChunkOpenSet.Contains(Neighbor))
+                {
+                    ChunkOpenSet.DecreaseKey(Neighbor, IsCheaper);
+                }
+                else
+                {
+                    ChunkOpenSet.Push(Neighbor, IsCheaper);
+                }
+            }
+        }
+    }
+}
+
+bool FGridChunkWorld::RefineSegment(FIntPoint From, FIntPoint To, TArray<FIntPoint>& OutPath)
+{
+    const FGridNodeStore& Nodes = AcquireChunk(GetChunkOf(From)).Nodes;
+    if (!Nodes.FindPath(GetLocalIndex(From), GetLocalIndex(To), LocalContext, LocalPath))
+    {
+        return false;
+    }
+
+    // The local path starts at From, which is already on OutPath
+    const FIntPoint Origin = GetChunkOf(From) * ChunkSize;
+    for (int32 i = 1; i < LocalPath.Num(); i++)
+    {
+        OutPath.Add(Origin + FIntPoint(Nodes.GetGridX(LocalPath[i]), Nodes.GetGridY(LocalPath[i])));
+    }
+    return true;
+}
+
+void FGridChunkWorld::UpdateStats()
+{
+    Stats.NumResident = Resident.Num();
+    SET_DWORD_STAT(STAT_PathfindingResidentChunks, Stats.NumResident);
+    SET_MEMORY_STAT(STAT_PathfindingResidentChunkMemory, Stats.ResidentBytes);
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GridNodeStore.h"
+#include "IndexedNodeHeap.h"
+#include "PathSearchContext.h"
+
+// Residency counters of a FGridChunkWorld, since it was initialized
+struct FGridChunkWorldStats
+{
+    // Chunks held in memory now, the bytes they take, and the most they ever took
+    int32 NumResident = 0;
+    SIZE_T ResidentBytes = 0;
+    SIZE_T PeakResidentBytes = 0;
+
+    // Chunks read while building the portal graph: one per chunk when the budget holds NumChunks + 2 of them
+    int32 NumBuildLoads = 0;
+
+    // After the build: chunks read through the loader, chunks dropped to stay within the budget, and lookups that
+    // found the chunk resident
+    int32 NumLoads = 0;
+    int32 NumEvictions = 0;
+    int32 NumHits = 0;
+};
+
+/*
+ * A hex world too large to hold at once, cut into square chunks of ChunkSize x ChunkSize tiles that are loaded
+ * on demand and dropped again, least recently used first, to stay within a memory budget. Chunks around the
+ * areas of interest (players, cameras) are kept resident regardless.
+ *
+ * Only a portal graph is kept for the whole world: where two chunks touch, every open stretch of border gets a
+ * transition whose two tiles become portals, and each chunk stores the cost between every pair of its portals.
+ * It is built in one pass that streams every chunk through, and takes a few KB per chunk. A query connects its
+ * start and goal to the portals of their chunks, searches the portal graph, and fills in the tiles chunk by chunk,
+ * so only the chunks the path runs through are ever loaded. Like FHierarchicalPathfinder, paths are usually within
+ * a few percent of optimal.
+ *
+ * Tiles are addressed by world column and row. A resident chunk is an ordinary FGridNodeStore in chunk-local
+ * coordinates; ChunkSize is kept even so local rows have the same parity, and so the same neighbors, as world rows.
+ * The world does not follow edits: the loader is the source of truth for every tile.
+ */
+class PATHFINDINGPROJECT_API FGridChunkWorld
+{
+public:
+    // Fills OutNodes with the ChunkSize x ChunkSize tiles of a chunk, reusing its arrays
+    typedef TFunction<void(FIntPoint Chunk, int32 ChunkSize, FGridNodeStore& OutNodes)> FChunkLoader;
+
+    // Generates every chunk from Seed: random weights like FGridNodeStore::Build, and obstacles with the given density
+    static FChunkLoader MakeProceduralLoader(int32 Seed, float ObstacleDensity);
+
+    // Reads every chunk from a grid file in Directory named by GetChunkFilename. Missing chunks are solid obstacle.
+    static FChunkLoader MakeFileLoader(const FString& Directory);
+    static FString GetChunkFilename(const FString& Directory, FIntPoint Chunk);
+
+    /* Sets up a world of NumChunks x NumChunks chunks and builds its portal graph, loading every chunk once along the
+       way if the budget allows. MemoryBudget is the most the resident chunks may take, during the build too; at least
+       one chunk is always allowed. */
+    void Initialize(int32 InNumChunks, int32 InChunkSize, FChunkLoader InLoader, SIZE_T InMemoryBudget);
+
+    // Drops every chunk and the portal graph
+    void Reset();
+
+    // Changes the budget, evicting chunks right away if they no longer fit
+    void SetMemoryBudget(SIZE_T InMemoryBudget);
+    SIZE_T GetMemoryBudget() const { return MemoryBudget; }
+
+    /* Keeps the chunks within RadiusInChunks of each tile resident, loading the ones that are not, and releases the
+       chunks kept for the previous call to normal eviction. Pinned chunks may exceed the budget. */
+    void SetAreasOfInterest(TArrayView<const FIntPoint> Tiles, int32 RadiusInChunks);
+
+    // Finds a path as world tiles from Start to Goal, or returns false with an empty OutPath, loading chunks as needed
+    bool FindPath(FIntPoint Start, FIntPoint Goal, TArray<FIntPoint>& OutPath);
+
+    // Total cost of a path found by FindPath, charged like the other searches. Loads the chunks the path runs through.
+    double GetPathCost(TArrayView<const FIntPoint> Path);
+
+    bool IsResident(FIntPoint Chunk) const { return Resident.Contains(GetChunkIndex(Chunk)); }
+    bool IsValidTile(FIntPoint Tile) const { return Tile.X >= 0 && Tile.Y >= 0 && Tile.X < GetWorldSize() && Tile.Y < GetWorldSize(); }
+    FIntPoint GetChunkOf(FIntPoint Tile) const { return FIntPoint(Tile.X / ChunkSize, Tile.Y / ChunkSize); }
+
+    int32 GetNumChunks() const { return NumChunks; }
+    int32 GetChunkSize() const { return ChunkSize; }
+
+    // Tiles per side of the whole world
+    int32 GetWorldSize() const { return NumChunks * ChunkSize; }
+
+    int32 GetNumPortals() const { return Portals.Num(); }
+
+    // Bytes used by the portal graph and the chunk border summaries, which stay in memory for the whole world
+    SIZE_T GetPortalGraphSize() const;
+
+    const FGridChunkWorldStats& GetStats() const { return Stats; }
+
+    // Time the portal graph took to build, in seconds
+    double BuildSeconds = 0.0;
+
+    // Number of portal graph nodes the last FindPath call expanded
+    int32 NumExpanded = 0;
+
+private:
+    struct FPortalEdge
+    {
+        int32 ToPortal;
+        float Cost;
+    };
+
+    // A tile next to a chunk border with its edges to the other portals of its chunk and across the border
+    struct FPortal
+    {
+        FIntPoint Tile;
+        TArray<FPortalEdge> Edges;
+    };
+
+    // What the portal graph needs to know about a chunk without loading it
+    struct FChunkSummary
+    {
+        // Weight of each tile along the four borders, in column or row order, negative for obstacles
+        TArray<float> Left;
+        TArray<float> Right;
+        TArray<float> Bottom;
+        TArray<float> Top;
+
+        TArray<int32> Portals;
+    };
+
+    struct FResidentChunk
+    {
+        FGridNodeStore Nodes;
+
+        // Bytes counted against the budget while the chunk is resident
+        SIZE_T Bytes = 0;
+
+        uint64 LastUsed = 0;
+        bool bPinned = false;
+    };
+
+    int32 GetChunkIndex(FIntPoint Chunk) const { return Chunk.X * NumChunks + Chunk.Y; }
+
+    // Index of a world tile in its chunk's node store
+    int32 GetLocalIndex(FIntPoint Tile) const { return (Tile.X % ChunkSize) * ChunkSize + Tile.Y % ChunkSize; }
+
+    // Returns the chunk, loading it and evicting others to make room if it is not resident. The reference is only
+    // good until the next call, which may evict it.
+    FResidentChunk& AcquireChunk(FIntPoint Chunk);
+
+    // Evicts least recently used chunks that are not pinned until IncomingBytes more fit in the budget
+    void EvictToBudget(SIZE_T IncomingBytes);
+
+    // Weight of a tile on a chunk border from the summaries, negative for obstacles
+    float GetBorderWeight(FIntPoint Tile) const;
+
+    // Streams every chunk through once, summarizing its borders, placing its transitions and searching its portal costs
+    void BuildPortalGraph();
+
+    // Places the transitions between two touching chunks from their border summaries, walking Chunk's border
+    void AddTransitions(FIntPoint Chunk, FIntPoint Other, TMap<FIntPoint, int32>& PortalOfTile, TArray<TPair<FIntPoint, FIntPoint>>& Candidates);
+
+    // Adds the costs between every pair of portals of a chunk, loading it if it is not resident
+    void AddChunkEdges(int32 ChunkIndex);
+
+    // Returns the portal on Tile, adding one to its chunk if there is none yet
+    int32 AddPortal(FIntPoint Tile, TMap<FIntPoint, int32>& PortalOfTile);
+
+    // Dijkstra inside one chunk from Source to every tile, or with bReverse from every tile to Source, into ChunkCosts
+    void RunChunkSearch(const FGridNodeStore& Nodes, int32 Source, bool bReverse);
+
+    // Appends the tiles after From up to and including To, searching inside their shared chunk
+    bool RefineSegment(FIntPoint From, FIntPoint To, TArray<FIntPoint>& OutPath);
+
+    void UpdateStats();
+
+    int32 NumChunks = 0;
+    int32 ChunkSize = 0;
+    SIZE_T MemoryBudget = 0;
+    FChunkLoader Loader;
+
+    TArray<FChunkSummary> Summaries;
+    TArray<FPortal> Portals;
+
+    // Chunks in memory by chunk index. Each is allocated on its own so eviction does not move the others.
+    TMap<int32, TUniquePtr<FResidentChunk>> Resident;
+    uint64 UseCounter = 0;
+
+    // Size of the last chunk loaded, which is what the next one is expected to take
+    SIZE_T ChunkBytes = 0;
+
+    FGridChunkWorldStats Stats;
+
+    // Scratch state for chunk searches and queries
+    TArray<float> ChunkCosts;
+    FIndexedNodeHeap ChunkOpenSet;
+    FPathSearchContext AbstractContext;
+    FPathSearchContext LocalContext;
+    TArray<int32> AbstractPath;
+    TArray<int32> LocalPath;
+    TMap<int32, float> StartPortalCosts;
+    TMap<int32, float> GoalPortalCosts;
+};
@@ -0,0 +1,261 @@
+#include "GridFile.h"
+#include "GridNodeStore.h"
+#include "CompressedPathDatabase.h"
+#include "PathfindingStats.h"
+#include "Async/MappedFileHandle.h"
+#include <atomic>
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+
+// Identifies a grid file, and the layout it was saved with
+static constexpr uint32 FileMagic = 0x47584548; // "HEXG"
+static constexpr uint32 FileVersion = 1;
+
+// Sections start at multiples of this, so each one can be read in place at its natural alignment
+static constexpr uint64 SectionAlignment = 64;
+
+// Where a section lies in the file. A section the file does not have is all zero.
+struct FGridFileSection
+{
+    uint64 Offset;
+    uint64 Size;
+};
+
+// Start of every grid file, stored as it is in memory
+struct FGridFileHeader
+{
+    uint32 Magic;
+    uint32 Version;
+    int32 GridCount;
+
+    // FGridFile::ESections present in the file
+    uint32 Sections;
+
+    FGridFileSection Obstacles;
+    FGridFileSection Weights;
+    FGridFileSection Neighbors;
+    FGridFileSection PathDatabase;
+};
+static_assert(sizeof(FGridFileHeader) == 80, "The grid file header is stored as it is in memory, so its layout must not change within a version");
+
+bool FGridFile::Save(const FString& Filename, const FGridNodeStore& Nodes, uint32 Sections, const FCompressedPathDatabase* PathDatabase)
+{
+    const int32 NumTiles = Nodes.Num();
+    TArray<uint8> PathDatabaseBlob;
+    if ((Sections & WithPathDatabase) && PathDatabase && PathDatabase->IsBuilt())
+    {
+        PathDatabase->SaveToBlob(PathDatabaseBlob);
+    }
+
+    // Lay out the sections one after the other
+    FGridFileHeader Header;
+    FMemory::Memzero(Header);
+    Header.Magic = FileMagic;
+    Header.Version = FileVersion;
+    Header.GridCount = Nodes.GetGridCount();
+    uint64 FileSize = Align(sizeof(FGridFileHeader), SectionAlignment);
+    auto PlaceSection = [&FileSize](FGridFileSection& Section, uint64 Size)
+    {
+        Section.Offset = FileSize;
+        Section.Size = Size;
+        FileSize = Align(FileSize + Size, SectionAlignment);
+    };
+    PlaceSection(Header.Obstacles, ((uint64)NumTiles + 7) / 8);
+    PlaceSection(Header.Weights, (uint64)NumTiles * sizeof(uint16));
+    if (Sections & WithNeighbors)
+    {
+        Header.Sections |= WithNeighbors;
+        PlaceSection(Header.Neighbors, (uint64)Nodes.Neighbors.Num() * sizeof(int32));
+    }
+    if (PathDatabaseBlob.Num() > 0)
+    {
+        Header.Sections |= WithPathDatabase;
+        PlaceSection(Header.PathDatabase, PathDatabaseBlob.Num());
+    }
+
+    TArray<uint8> Data;
+    Data.SetNumZeroed(FileSize);
+    FMemory::Memcpy(Data.GetData(), &Header, sizeof(Header));
+
+    uint8* ObstacleBits = Data.GetData() + Header.Obstacles.Offset;
+    uint16* Weights = reinterpret_cast<uint16*>(Data.GetData() + Header.Weights.Offset);
+    for (int32 Index = 0; Index < NumTiles; Index++)
+    {
+        ObstacleBits[Index >> 3] |= Nodes.Obstacles[Index] ? (uint8)(1 << (Index & 7)) : 0;
+        Weights[Index] = (uint16)FMath::Min(Nodes.StepCosts[Index], (uint32)MAX_uint16);
+    }
+    if (Header.Sections & WithNeighbors)
+    {
+        FMemory::Memcpy(Data.GetData() + Header.Neighbors.Offset, Nodes.Neighbors.GetData(), Header.Neighbors.Size);
+    }
+    if (Header.Sections & WithPathDatabase)
+    {
+        FMemory::Memcpy(Data.GetData() + Header.PathDatabase.Offset, PathDatabaseBlob.GetData(), PathDatabaseBlob.Num());
+    }
+
+    return FFileHelper::SaveArrayToFile(Data, *Filename);
+}
+
+bool FGridFile::Load(const FString& Filename, FGridNodeStore& OutNodes, FCompressedPathDatabase* OutPathDatabase)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FGridFile_Load, PathfindingChannel);
+    const double StartTime = FPlatformTime::Seconds();
+
+    // Map the file, so only the pages the decode touches are read, and only when it touches them. Platforms
+    // without mapped files read the whole file instead.
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*Filename));
+    TUniquePtr<IMappedFileRegion> MappedRegion;
+    TArray<uint8> FileData;
+    const uint8* Data = nullptr;
+    uint64 FileSize = 0;
+    if (MappedFile && MappedFile->GetFileSize() > 0)
+    {
+        MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+    }
+    if (MappedRegion)
+    {
+        Data = MappedRegion->GetMappedPtr();
+        FileSize = MappedRegion->GetMappedSize();
+    }
+    else if (FFileHelper::LoadFileToArray(FileData, *Filename))
+    {
+        Data = FileData.GetData();
+        FileSize = FileData.Num();
+    }
+
+    // Check the header and that every section it names lies inside the file
+    FGridFileHeader Header;
+    if (!Data || FileSize < sizeof(Header))
+    {
+        return false;
+    }
+    FMemory::Memcpy(&Header, Data, sizeof(Header));
+
+    const int64 NumTiles = (int64)Header.GridCount * Header.GridCount;
+    auto IsValidSection = [FileSize](const FGridFileSection& Section, uint64 ExpectedSize)
+    {
+        return Section.Size == ExpectedSize && Section.Offset % SectionAlignment == 0 && Section.Offset <= FileSize && Section.Size <= FileSize - Section.Offset;
+    };
+    const bool bValid = Header.Magic == FileMagic && Header.Version == FileVersion && Header.GridCount > 0
+        && NumTiles <= MAX_int32 / FGridNodeStore::NumDirections
+        && IsValidSection(Header.Obstacles, ((uint64)NumTiles + 7) / 8)
+        && IsValidSection(Header.Weights, (uint64)NumTiles * sizeof(uint16))
+        && (!(Header.Sections & WithNeighbors) || IsValidSection(Header.Neighbors, (uint64)NumTiles * FGridNodeStore::NumDirections * sizeof(int32)))
+        && (!(Header.Sections & WithPathDatabase) || IsValidSection(Header.PathDatabase, Header.PathDatabase.Size));
+    if (!bValid)
+    {
+        UE_LOG(LogPathfinding, Warning, TEXT("FGridFile: %s is not a grid file of version %u"), *Filename, FileVersion);
+        return false;
+    }
+
+    // Every search takes the straight-line distance as a lower bound on the cost, which only holds if no tile costs
+    // less than one per unit, so a lighter weight makes the file as corrupt as a bad header. Checked before anything
+    // is written, so a rejected file leaves OutNodes as it was.
+    const uint16* Weights = reinterpret_cast<const uint16*>(Data + Header.Weights.Offset);
+    std::atomic<bool> bWeightsValid = true;
+    ParallelFor(Header.GridCount, [&](int32 Chunk)
+    {
+        const int64 First = (int64)Chunk * Header.GridCount;
+        for (int64 Index = First; Index < First + Header.GridCount; Index++)
+        {
+            if (Weights[Index] < FGridNodeStore::FixedPointScale)
+            {
+                bWeightsValid = false;
+                return;
+            }
+        }
+    });
+    if (!bWeightsValid)
+    {
+        UE_LOG(LogPathfinding, Warning, TEXT("FGridFile: %s holds a tile weight below one"), *Filename);
+        return false;
+    }
+
+    // Size the arrays once, keeping the allocations of the grid they replace
+    const int32 GridCount = Header.GridCount;
+    OutNodes.GridCount = GridCount;
+    OutNodes.Positions.SetNumUninitialized(NumTiles);
+    OutNodes.Weights.SetNumUninitialized(NumTiles);
+    OutNodes.Obstacles.SetNumUninitialized(NumTiles);
+    OutNodes.Neighbors.SetNumUninitialized(NumTiles * FGridNodeStore::NumDirections);
+    OutNodes.StepCosts.SetNumUninitialized(NumTiles);
+    FVector* PositionData = OutNodes.Positions.GetMutableData();
+    int32* NeighborData = OutNodes.Neighbors.GetMutableData();
+
+    const uint8* ObstacleBits = Data + Header.Obstacles.Offset;
+    const int32* Neighbors = (Header.Sections & WithNeighbors) ? reinterpret_cast<const int32*>(Data + Header.Neighbors.Offset) : nullptr;
+
+    // Columns are contiguous in every section, so each worker reads its own stretch of the mapping
+    TArray<uint32> ColumnMinStepCosts;
+    ColumnMinStepCosts.SetNumUninitialized(GridCount);
+    std::atomic<int32> NumRebuiltColumns = 0;
+    ParallelFor(GridCount, [&](int32 X)
+    {
+        uint32 ColumnMinStepCost = MAX_uint32;
+        for (int32 Y = 0; Y < GridCount; Y++)
+        {
+            const int32 Index = OutNodes.GetIndex(X, Y);
+            PositionData[Index] = FGridNodeStore::GetTileLocation(X, Y);
+            OutNodes.StepCosts[Index] = Weights[Index];
+            OutNodes.Weights[Index] = (float)Weights[Index] / FGridNodeStore::FixedPointScale;
+            OutNodes.Obstacles[Index] = (ObstacleBits[Index >> 3] >> (Index & 7)) & 1;
+            ColumnMinStepCost = FMath::Min(ColumnMinStepCost, OutNodes.StepCosts[Index]);
+        }
+        ColumnMinStepCosts[X] = ColumnMinStepCost;
+
+        // A stored neighbor table is copied as is, but a column pointing outside the grid is rebuilt rather than trusted
+        const int32 ColumnStart = OutNodes.GetIndex(X, 0) * FGridNodeStore::NumDirections;
+        const int32 ColumnSize = GridCount * FGridNodeStore::NumDirections;
+        bool bNeighborsValid = Neighbors != nullptr;
+        if (bNeighborsValid)
+        {
+            FMemory::Memcpy(NeighborData + ColumnStart, Neighbors + ColumnStart, ColumnSize * sizeof(int32));
+            for (int32 Slot = ColumnStart; bNeighborsValid && Slot < ColumnStart + ColumnSize; Slot++)
+            {
+                bNeighborsValid = NeighborData[Slot] >= INDEX_NONE && NeighborData[Slot] < NumTiles;
+            }
+            NumRebuiltColumns += bNeighborsValid ? 0 : 1;
+        }
+        if (!bNeighborsValid)
+        {
+            OutNodes.BuildNeighborsForColumn(X, NeighborData);
+        }
+    });
+
+    OutNodes.MinStepCost = MAX_uint32;
+    for (uint32 ColumnMinStepCost : ColumnMinStepCosts)
+    {
+        OutNodes.MinStepCost = FMath::Min(OutNodes.MinStepCost, ColumnMinStepCost);
+    }
+    if (NumRebuiltColumns > 0)
+    {
+        UE_LOG(LogPathfinding, Warning, TEXT("FGridFile: %s has a damaged neighbor table, rebuilt %d columns"), *Filename, NumRebuiltColumns.load());
+    }
+
+    // The path database is an optional extra: one that does not load is dropped, and the tiles are still good
+    if (OutPathDatabase)
+    {
+        OutPathDatabase->Reset();
+        if ((Header.Sections & WithPathDatabase)
+            && !OutPathDatabase->LoadFromBlob(MakeArrayView(Data + Header.PathDatabase.Offset, (int32)FMath::Min<uint64>(Header.PathDatabase.Size, MAX_int32))))
+        {
+            UE_LOG(LogPathfinding, Warning, TEXT("FGridFile: %s has a damaged path database, ignoring it"), *Filename);
+        }
+    }
+
+    UE_LOG(LogPathfinding, Log, TEXT("FGridFile: Loaded %s, %d tiles in %.2f ms (%s%s)"), *Filename, OutNodes.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0,
+        MappedRegion ? TEXT("mapped") : TEXT("read"), Neighbors ? TEXT(", stored neighbors") : TEXT(""));
+    return true;
+}
+
+void FGridFile::QuantizeWeights(FGridNodeStore& Nodes)
+{
+    for (int32 Index = 0; Index < Nodes.Num(); Index++)
+    {
+        Nodes.Weights[Index] = (float)FMath::Min(FGridNodeStore::ToStepCost(Nodes.Weights[Index]), (uint32)MAX_uint16) / FGridNodeStore::FixedPointScale;
+    }
+    Nodes.UpdateStepCosts();
+}
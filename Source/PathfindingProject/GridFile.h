@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FGridNodeStore;
+class FCompressedPathDatabase;
+
+/*
+ * Binary file holding a whole grid, for maps that are authored or exported rather than generated. A fixed header
+ * is followed by sections, each aligned so it can be read in place:
+ *
+ *   Obstacles     one bit per tile, tile Index at bit Index % 8 of byte Index / 8
+ *   Weights       one uint16 per tile, the weight in FGridNodeStore::FixedPointScale units, which is its step cost
+ *   Neighbors     optional, the node store's neighbor table as it is in memory
+ *   PathDatabase  optional, a FCompressedPathDatabase blob for the tiles in the file
+ *
+ * Positions are not stored, since they follow from the grid coordinates. A 2048 x 2048 grid takes about 8.5 MB
+ * without the optional sections, against some 240 MB for the node store it loads into. Weights are capped at 255.99,
+ * and the file is little-endian like every platform the project ships on.
+ *
+ * Load maps the file instead of reading it, and decodes the columns of the grid in parallel straight out of the
+ * mapping, so each page is faulted in by the worker that needs it and there is no intermediate copy or per-tile parse.
+ */
+class PATHFINDINGPROJECT_API FGridFile
+{
+public:
+    // Optional sections, as bit flags
+    enum ESections : uint32
+    {
+        WithNeighbors = 1 << 0,
+        WithPathDatabase = 1 << 1
+    };
+
+    /* Writes Nodes to Filename. Weights are stored rounded to 1/FixedPointScale, the rounding the fixed-point search
+       already uses, so a grid that was not made of such weights loads back slightly different; QuantizeWeights gives
+       the tiles it will load as. With WithPathDatabase, PathDatabase is written too and has to be built for those tiles. */
+    static bool Save(const FString& Filename, const FGridNodeStore& Nodes, uint32 Sections = 0, const FCompressedPathDatabase* PathDatabase = nullptr);
+
+    /* Replaces the tiles of OutNodes with the grid in Filename, reusing its arrays. Fills OutPathDatabase when the
+       file has one and it is asked for. False, leaving OutNodes untouched, if the file is missing, damaged, from
+       another version or holds a tile weight below one. */
+    static bool Load(const FString& Filename, FGridNodeStore& OutNodes, FCompressedPathDatabase* OutPathDatabase = nullptr);
+
+    // Rounds every weight to what Save stores, and updates the step costs
+    static void QuantizeWeights(FGridNodeStore& Nodes);
+};
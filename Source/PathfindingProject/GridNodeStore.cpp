@@ -0,0 +1,684 @@
+#include "GridNodeStore.h"
+#include "PathSearchContext.h"
+#include "LandmarkHeuristic.h"
+#include "Math/UnrealMathUtility.h"
+#include "Math/RandomStream.h"
+#include "PathfindingStats.h"
+
+// Column/row offsets of the six neighbor directions. Odd rows are shifted half a tile to the right,
+// so the tiles above and below them sit one column further right than they do for even rows.
+static const int32 EvenRowOffsets[FGridNodeStore::NumDirections][2] = {
+    { 1,  0}, // Right
+    { 0,  1}, // Next row, right
+    {-1,  1}, // Next row, left
+    {-1,  0}, // Left
+    {-1, -1}, // Previous row, left
+    { 0, -1}  // Previous row, right
+};
+
+static const int32 OddRowOffsets[FGridNodeStore::NumDirections][2] = {
+    { 1,  0}, // Right
+    { 1,  1}, // Next row, right
+    { 0,  1}, // Next row, left
+    {-1,  0}, // Left
+    { 0, -1}, // Previous row, left
+    { 1, -1}  // Previous row, right
+};
+
+FVector FGridNodeStore::GetTileLocation(int32 X, int32 Y)
+{
+    // Hex grid parameters for placing the tiles
+    float HexRadius = 100.0f;
+    float HorizontalShift = HexRadius * FMath::Sqrt(3.);
+    float VerticalShift = HexRadius * 1.5f;
+
+    if (Y % 2 == 0) // if even numbered row, place tile without offset
+        return FVector(HorizontalShift * X, VerticalShift * Y, 0.0f);
+    else // otherwise, apply a horizontal shift 
+        return FVector(HorizontalShift * X + HorizontalShift / 2.0f, VerticalShift * Y, 0.0f);
+}
+
+FIntPoint FGridNodeStore::GetNeighborCoords(int32 X, int32 Y, int32 Direction)
+{
+    const int32 (*Offsets)[2] = (Y % 2 == 0) ? EvenRowOffsets : OddRowOffsets;
+    return FIntPoint(X + Offsets[Direction][0], Y + Offsets[Direction][1]);
+}
+
+void FGridNodeStore::Build(int32 InGridCount, int32 Seed, EParallelForFlags Flags)
+{
+    GridCount = FMath::Max(InGridCount, 0);
+    const int32 NumNodes = GridCount * GridCount;
+
+    // SetNum keeps the existing allocations when the grid is regenerated at the same or a smaller size. Positions and
+    // neighbors still shared with a snapshot get arrays of their own instead, and the snapshot keeps the old grid.
+    Positions.SetNumUninitialized(NumNodes);
+    Weights.SetNum(NumNodes);
+    Obstacles.SetNum(NumNodes);
+    Neighbors.SetNumUninitialized(NumNodes * NumDirections);
+    StepCosts.SetNumUninitialized(NumNodes);
+    FVector* PositionData = Positions.GetMutableData();
+    int32* NeighborData = Neighbors.GetMutableData();
+
+    // FMath::RandRange is not safe to call from several threads, so each column draws from its own stream
+    TArray<uint32> ColumnMinStepCosts;
+    ColumnMinStepCosts.SetNumUninitialized(GridCount);
+
+    // Columns write disjoint slices of every array, so the whole layout, adjacency included, is one parallel pass
+    ParallelFor(GridCount, [this, Seed, PositionData, NeighborData, &ColumnMinStepCosts](int32 x)
+    {
+        FRandomStream Random((int32)HashCombine((uint32)Seed, (uint32)x));
+        uint32 ColumnMinStepCost = MAX_uint32;
+        for (int32 y = 0; y < GridCount; y++)
+        {
+            const int32 Index = GetIndex(x, y);
+            PositionData[Index] = GetTileLocation(x, y);
+            Weights[Index] = Random.FRandRange(1.0f, 5.0f); // Random movement cost
+            Obstacles[Index] = false; // Neutral by default
+            StepCosts[Index] = ToStepCost(Weights[Index]);
+            ColumnMinStepCost = FMath::Min(ColumnMinStepCost, StepCosts[Index]);
+        }
+        BuildNeighborsForColumn(x, NeighborData);
+        ColumnMinStepCosts[x] = ColumnMinStepCost;
+    }, Flags);
+
+    MinStepCost = MAX_uint32;
+    for (uint32 ColumnMinStepCost : ColumnMinStepCosts)
+    {
+        MinStepCost = FMath::Min(MinStepCost, ColumnMinStepCost);
+    }
+}
+
+void FGridNodeStore::BuildNeighbors()
+{
+    Neighbors.SetNumUninitialized(Num() * NumDirections);
+    int32* NeighborData = Neighbors.GetMutableData();
+    ParallelFor(GridCount, [this, NeighborData](int32 x)
+    {
+        BuildNeighborsForColumn(x, NeighborData);
+    });
+}
+
+void FGridNodeStore::BuildNeighborsForColumn(int32 x, int32* NeighborData) const
+{
+    for (int32 y = 0; y < GridCount; y++)
+    {
+        const int32 (*Offsets)[2] = (y % 2 == 0) ? EvenRowOffsets : OddRowOffsets;
+        const int32 Index = GetIndex(x, y);
+
+        for (int32 Direction = 0; Direction < NumDirections; Direction++)
+        {
+            //Applies the offset to find the neighbor
+            const int32 NeighborX = x + Offsets[Direction][0];
+            const int32 NeighborY = y + Offsets[Direction][1];
+
+            // Out of bound neighbors are stored as INDEX_NONE so every node keeps six slots
+            const bool bInBounds = NeighborX >= 0 && NeighborX < GridCount && NeighborY >= 0 && NeighborY < GridCount;
+            NeighborData[Index * NumDirections + Direction] = bInBounds ? GetIndex(NeighborX, NeighborY) : INDEX_NONE;
+        }
+    }
+}
+
+void FGridNodeStore::UpdateStepCosts()
+{
+    StepCosts.SetNumUninitialized(Num());
+    MinStepCost = MAX_uint32;
+    for (int32 Index = 0; Index < Num(); Index++)
+    {
+        StepCosts[Index] = ToStepCost(Weights[Index]);
+        MinStepCost = FMath::Min(MinStepCost, StepCosts[Index]);
+    }
+}
+
+int32 FGridNodeStore::GetHexDistance(int32 IndexA, int32 IndexB) const
+{
+    // Axial coordinates: odd rows are shifted half a tile right, so every second row moves the column origin one to the left
+    const int32 RowA = GetGridY(IndexA);
+    const int32 RowB = GetGridY(IndexB);
+    const int32 Q = (GetGridX(IndexB) - (RowB - (RowB & 1)) / 2) - (GetGridX(IndexA) - (RowA - (RowA & 1)) / 2);
+    const int32 R = RowB - RowA;
+    return (FMath::Abs(Q) + FMath::Abs(R) + FMath::Abs(Q + R)) / 2;
+}
+
+bool FGridNodeStore::FindPath(int32 StartIndex, int32 GoalIndex, FPathSearchContext& Context, TArray<int32>& OutPath, const FLandmarkHeuristic* Landmarks) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_PathfindingSearch);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FGridNodeStore_FindPath, PathfindingChannel);
+    FPathQueryStats QueryStats(OutPath);
+    QueryStats.Track(Context.NumExpanded, &Context.OpenSet);
+
+    OutPath.Reset();
+    if (!IsValidIndex(StartIndex) || !IsValidIndex(GoalIndex))
+    {
+        return false;
+    }
+
+    // Nodes touched by earlier queries read as unvisited from here on, so there is nothing to reset
+    Context.BeginQuery(Num());
+
+    auto IsBetterNode = [&Context](int32 A, int32 B)
+    {
+        return Context.IsBetterNode(A, B);
+    };
+
+    const FVector& GoalPosition = Positions[GoalIndex];
+
+    // Euclidean distance to the goal, raised to the landmark bound when there is one
+    auto GetHeuristic = [this, Landmarks, GoalIndex, &GoalPosition](int32 Index)
+    {
+        const float Distance = FVector::Dist(Positions[Index], GoalPosition);
+        return Landmarks ? FMath::Max(Distance, Landmarks->GetLowerBound(Index, GoalIndex)) : Distance;
+    };
+
+    // No movement cost since we start from this node
+    FPathSearchContext::FNodeState& StartState = Context.GetNode(StartIndex);
+    StartState.GCost = 0.0f;
+    StartState.HCost = GetHeuristic(StartIndex);
+    Context.OpenSet.Push(StartIndex, IsBetterNode);
+
+    // Main A* loop.
+    while (!Context.OpenSet.IsEmpty())
+    {
+        // Remove the best node from the open set and mark it as closed
+        const int32 Current = Context.OpenSet.Pop(IsBetterNode);
+        FPathSearchContext::FNodeState& CurrentState = Context.GetNode(Current);
+        CurrentState.bClosed = true;
+        Context.NumExpanded++;
+
+        if (Current == GoalIndex)
+        {
+            Context.BuildPath(GoalIndex, OutPath);
+            return true;
+        }
+
+        // Poll for cancellation now and then rather than paying for an atomic read on every expansion
+        if ((Context.NumExpanded & 1023) == 0 && Context.IsCancelled())
+        {
+            return false;
+        }
+
+        for (int32 Neighbor : GetNeighbors(Current))
+        {
+            // Skip the edge of the grid and obstacles
+            if (Neighbor == INDEX_NONE || Obstacles[Neighbor])
+            {
+                continue;
+            }
+
+            // Skip nodes that are already final
+            FPathSearchContext::FNodeState& NeighborState = Context.GetNode(Neighbor);
+            if (NeighborState.bClosed)
+            {
+                continue;
+            }
+
+            // Cost to reach the neighbor given the current GCost, the distance, and weight
+            const float MoveCost = FVector::Dist(Positions[Current], Positions[Neighbor]);
+            const float TentativeGCost = CurrentState.GCost + MoveCost * Weights[Neighbor];
+
+            if (TentativeGCost < NeighborState.GCost)
+            {
+                NeighborState.GCost = TentativeGCost;
+                NeighborState.HCost = GetHeuristic(Neighbor);
+                NeighborState.Parent = Current;
+
+                // Queue the neighbor, or move it up the heap if it was already waiting with a worse cost
+                if (Context.OpenSet.Contains(Neighbor))
+                {
+                    Context.OpenSet.DecreaseKey(Neighbor, IsBetterNode);
+                }
+                else
+                {
+                    Context.OpenSet.Push(Neighbor, IsBetterNode);
+                }
+            }
+        }
+    }
+
+    // Empty if the goal was never reached
+    return false;
+}
+
+/*
+ * Jump point search for the hex grid.
+ * Between two tiles in open ground of a single weight, every shortest path only uses two neighboring
+ * directions, D and D + 1, and they all cost the same. The search only follows one of them: a run in D (the
+ * first leg) that may turn once into D + 1 (the second leg) and then goes straight. The tiles along such a
+ * run are never queued; a run only stops at the goal, at a tile whose neighborhood is not uniform, at a tile
+ * with a forced neighbor, or, for a first leg, where its second leg would find one of those.
+ */
+
+bool FGridNodeStore::IsUniform(int32 Index) const
+{
+    const float Weight = Weights[Index];
+    for (int32 Neighbor : GetNeighbors(Index))
+    {
+        if (Neighbor != INDEX_NONE && !Obstacles[Neighbor] && Weights[Neighbor] != Weight)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FGridNodeStore::HasForcedNeighbor(int32 Index, int32 Direction, bool bFirstLeg) const
+{
+    // A side neighbor is normally reached by the run next to this one, which passes through the tile behind it.
+    // If that tile is blocked, the only short way to the side neighbor is through this tile.
+    auto IsForced = [this, Index](int32 Side, int32 Behind)
+    {
+        return !IsBlocked(GetNeighbor(Index, Side)) && IsBlocked(GetNeighbor(Index, Behind));
+    };
+
+    if (IsForced((Direction + 5) % NumDirections, (Direction + 4) % NumDirections))
+    {
+        return true;
+    }
+
+    // The other side of a first leg is where its second legs go, so it is never forced
+    return !bFirstLeg && IsForced((Direction + 1) % NumDirections, (Direction + 2) % NumDirections);
+}
+
+int32 FGridNodeStore::Jump(int32 From, int32 Direction, bool bFirstLeg, int32 GoalIndex, float& InOutCost, bool& bOutExpandAll) const
+{
+    bOutExpandAll = true;
+    for (int32 Current = From;;)
+    {
+        const int32 Next = GetNeighbor(Current, Direction);
+        if (IsBlocked(Next))
+        {
+            return INDEX_NONE;
+        }
+
+        // Same step cost as FindPath, added in the same order, so both searches agree on path costs to the bit
+        InOutCost += FVector::Dist(Positions[Current], Positions[Next]) * Weights[Next];
+        Current = Next;
+
+        if (Current == GoalIndex || !IsUniform(Current) || HasForcedNeighbor(Current, Direction, bFirstLeg))
+        {
+            return Current;
+        }
+
+        if (bFirstLeg)
+        {
+            float SideCost = 0.0f;
+            bool bSideExpandAll = true;
+            if (Jump(Current, (Direction + 1) % NumDirections, false, GoalIndex, SideCost, bSideExpandAll) != INDEX_NONE)
+            {
+                // A turning point: only the two runs leaving it need searching
+                bOutExpandAll = false;
+                return Current;
+            }
+        }
+    }
+}
+
+bool FGridNodeStore::FindPathJumpPoint(int32 StartIndex, int32 GoalIndex, FPathSearchContext& Context, TArray<int32>& OutPath) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_PathfindingSearch);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FGridNodeStore_FindPathJumpPoint, PathfindingChannel);
+    FPathQueryStats QueryStats(OutPath);
+    QueryStats.Track(Context.NumExpanded, &Context.OpenSet);
+
+    OutPath.Reset();
+    if (!IsValidIndex(StartIndex) || !IsValidIndex(GoalIndex))
+    {
+        return false;
+    }
+
+    Context.BeginQuery(Num());
+
+    auto IsBetterNode = [&Context](int32 A, int32 B)
+    {
+        return Context.IsBetterNode(A, B);
+    };
+
+    const FVector& GoalPosition = Positions[GoalIndex];
+
+    // Queues the end of a run, or widens what gets searched from a tile that another run reached at the same cost
+    auto Relax = [this, &Context, &IsBetterNode, &GoalPosition](int32 From, int32 To, float TentativeGCost, int32 Direction, bool bExpandAll)
+    {
+        FPathSearchContext::FNodeState& State = Context.GetNode(To);
+        const bool bSameCost = FMath::IsNearlyEqual(TentativeGCost, State.GCost, FMath::Max(State.GCost * 1.e-5f, 1.e-3f));
+        if (TentativeGCost < State.GCost && !bSameCost)
+        {
+            State.GCost = TentativeGCost;
+            State.HCost = FVector::Dist(Positions[To], GoalPosition);
+            State.Parent = From;
+            State.Direction = (uint8)Direction;
+            State.bExpandAll = bExpandAll;
+            State.bClosed = false;
+
+            if (Context.OpenSet.Contains(To))
+            {
+                Context.OpenSet.DecreaseKey(To, IsBetterNode);
+            }
+            else
+            {
+                Context.OpenSet.Push(To, IsBetterNode);
+            }
+        }
+        else if (bSameCost && !State.bExpandAll && (bExpandAll || State.Direction != Direction))
+        {
+            // Each run only searches its own share of directions, so a tile two runs reach equally well searches them all.
+            // If it was already expanded, it goes back in the queue to cover the rest.
+            State.bExpandAll = true;
+            if (State.bClosed)
+            {
+                State.bClosed = false;
+                Context.OpenSet.Push(To, IsBetterNode);
+            }
+        }
+    };
+
+    FPathSearchContext::FNodeState& StartState = Context.GetNode(StartIndex);
+    StartState.GCost = 0.0f;
+    StartState.HCost = FVector::Dist(Positions[StartIndex], GoalPosition);
+    StartState.bExpandAll = true;
+    Context.OpenSet.Push(StartIndex, IsBetterNode);
+
+    while (!Context.OpenSet.IsEmpty())
+    {
+        const int32 Current = Context.OpenSet.Pop(IsBetterNode);
+        FPathSearchContext::FNodeState& CurrentState = Context.GetNode(Current);
+        CurrentState.bClosed = true;
+        Context.NumExpanded++;
+
+        if (Current == GoalIndex)
+        {
+            SCOPE_CYCLE_COUNTER(STAT_PathfindingReconstruction);
+
+            // Every run is a straight line, so it covers as many tiles as the hex distance back to the tile it started
+            // from. Counting them first sizes the path once, and it is then written back to front.
+            int32 PathLength = 1;
+            for (int32 PathNode = GoalIndex; Context.GetNode(PathNode).Parent != INDEX_NONE; PathNode = Context.GetNode(PathNode).Parent)
+            {
+                PathLength += GetHexDistance(PathNode, Context.GetNode(PathNode).Parent);
+            }
+            OutPath.SetNumUninitialized(PathLength, false);
+
+            // Fill in the tiles each run skipped by walking it backwards to the tile it started from
+            int32 WriteIndex = PathLength - 1;
+            for (int32 PathNode = GoalIndex; PathNode != INDEX_NONE;)
+            {
+                OutPath[WriteIndex--] = PathNode;
+                const FPathSearchContext::FNodeState& PathState = Context.GetNode(PathNode);
+                const int32 Back = (PathState.Direction + NumDirections / 2) % NumDirections;
+                int32 Step = PathState.Parent == INDEX_NONE ? INDEX_NONE : GetNeighbor(PathNode, Back);
+                while (Step != PathState.Parent && Step != INDEX_NONE)
+                {
+                    OutPath[WriteIndex--] = Step;
+                    Step = GetNeighbor(Step, Back);
+                }
+                PathNode = PathState.Parent;
+            }
+            checkSlow(WriteIndex == INDEX_NONE);
+            return true;
+        }
+
+        if ((Context.NumExpanded & 1023) == 0 && Context.IsCancelled())
+        {
+            return false;
+        }
+
+        const float CurrentCost = CurrentState.GCost;
+        const bool bExpandAll = CurrentState.bExpandAll;
+        const int32 CurrentDirection = CurrentState.Direction;
+        for (int32 Direction = 0; Direction < NumDirections; Direction++)
+        {
+            // A turning point continues its first leg and starts the second one; everything else goes every way
+            const bool bFirstLeg = bExpandAll || Direction == CurrentDirection;
+            if (!bFirstLeg && Direction != (CurrentDirection + 1) % NumDirections)
+            {
+                continue;
+            }
+
+            float JumpCost = CurrentCost;
+            bool bJumpExpandAll = true;
+            const int32 JumpNode = Jump(Current, Direction, bFirstLeg, GoalIndex, JumpCost, bJumpExpandAll);
+            if (JumpNode != INDEX_NONE)
+            {
+                Relax(Current, JumpNode, JumpCost, Direction, bJumpExpandAll);
+            }
+        }
+    }
+
+    return false;
+}
+
+bool FGridNodeStore::FindPathBidirectional(int32 StartIndex, int32 GoalIndex, FPathSearchContext& Context, FPathSearchContext& ReverseContext, TArray<int32>& OutPath) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_PathfindingSearch);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FGridNodeStore_FindPathBidirectional, PathfindingChannel);
+    FPathQueryStats QueryStats(OutPath);
+    QueryStats.Track(Context.NumExpanded, &Context.OpenSet);
+    QueryStats.Track(ReverseContext.NumExpanded, &ReverseContext.OpenSet);
+
+    OutPath.Reset();
+    if (!IsValidIndex(StartIndex) || !IsValidIndex(GoalIndex))
+    {
+        return false;
+    }
+
+    Context.BeginQuery(Num());
+    ReverseContext.BeginQuery(Num());
+
+    // The start may sit on an obstacle since the path only leaves it, but nothing can enter an obstacle goal
+    if (StartIndex == GoalIndex)
+    {
+        Context.GetNode(StartIndex).GCost = 0.0f;
+        Context.BuildPath(StartIndex, OutPath);
+        return true;
+    }
+    if (Obstacles[GoalIndex])
+    {
+        return false;
+    }
+
+    // Each direction aims at the other one's origin. The Euclidean distance stays a consistent heuristic in
+    // both directions since every weight is at least one, so a closed node's cost is final on either side.
+    FPathSearchContext::FNodeState& StartState = Context.GetNode(StartIndex);
+    StartState.GCost = 0.0f;
+    StartState.HCost = FVector::Dist(Positions[StartIndex], Positions[GoalIndex]);
+    Context.OpenSet.Push(StartIndex, [&Context](int32 A, int32 B) { return Context.IsBetterNode(A, B); });
+
+    FPathSearchContext::FNodeState& GoalState = ReverseContext.GetNode(GoalIndex);
+    GoalState.GCost = 0.0f;
+    GoalState.HCost = StartState.HCost;
+    ReverseContext.OpenSet.Push(GoalIndex, [&ReverseContext](int32 A, int32 B) { return ReverseContext.IsBetterNode(A, B); });
+
+    // Cheapest complete path seen so far, and the node where its two halves join
+    float BestCost = TNumericLimits<float>::Max();
+    int32 MeetingNode = INDEX_NONE;
+
+    while (!Context.OpenSet.IsEmpty() && !ReverseContext.OpenSet.IsEmpty())
+    {
+        // Every path not found yet still has to pass a node on each frontier, so it costs at least the larger of
+        // the two lowest FCosts. Once that reaches the best path found, nothing cheaper is left to find.
+        const float ForwardBound = Context.GetNode(Context.OpenSet.Top()).FCost();
+        const float ReverseBound = ReverseContext.GetNode(ReverseContext.OpenSet.Top()).FCost();
+        if (FMath::Max(ForwardBound, ReverseBound) >= BestCost)
+        {
+            break;
+        }
+
+        // Either side may carry the query's cancel flag
+        if (((Context.NumExpanded + ReverseContext.NumExpanded) & 1023) == 0 && (Context.IsCancelled() || ReverseContext.IsCancelled()))
+        {
+            return false;
+        }
+
+        // Grow the smaller frontier, so neither side runs far ahead when one end sits in a dead end
+        const bool bForward = Context.OpenSet.Num() <= ReverseContext.OpenSet.Num();
+        FPathSearchContext& ThisSide = bForward ? Context : ReverseContext;
+        FPathSearchContext& OtherSide = bForward ? ReverseContext : Context;
+        const FVector& TargetPosition = Positions[bForward ? GoalIndex : StartIndex];
+
+        auto IsBetterNode = [&ThisSide](int32 A, int32 B)
+        {
+            return ThisSide.IsBetterNode(A, B);
+        };
+
+        const int32 Current = ThisSide.OpenSet.Pop(IsBetterNode);
+        FPathSearchContext::FNodeState& CurrentState = ThisSide.GetNode(Current);
+        CurrentState.bClosed = true;
+        ThisSide.NumExpanded++;
+
+        // Backward, an obstacle start is as far as a path can go, since no path may enter it. A node the other
+        // side has closed needs no expanding either: the best path through it was counted when both reached it.
+        if ((!bForward && Obstacles[Current]) || (OtherSide.IsVisited(Current) && OtherSide.GetNode(Current).bClosed))
+        {
+            continue;
+        }
+
+        for (int32 Neighbor : GetNeighbors(Current))
+        {
+            // Forward, the neighbor is entered and must be open. Backward, the neighbor is the tile the path comes
+            // from, which may only be an obstacle if it is the start.
+            if (Neighbor == INDEX_NONE || (Obstacles[Neighbor] && (bForward || Neighbor != StartIndex)))
+            {
+                continue;
+            }
+
+            FPathSearchContext::FNodeState& NeighborState = ThisSide.GetNode(Neighbor);
+            if (NeighborState.bClosed)
+            {
+                continue;
+            }
+
+            // Entering a tile costs its weight: the neighbor's going forward, the current tile's going backward
+            const float MoveCost = FVector::Dist(Positions[Current], Positions[Neighbor]);
+            const float TentativeGCost = CurrentState.GCost + MoveCost * Weights[bForward ? Neighbor : Current];
+            if (TentativeGCost < NeighborState.GCost)
+            {
+                NeighborState.GCost = TentativeGCost;
+                NeighborState.HCost = FVector::Dist(Positions[Neighbor], TargetPosition);
+                NeighborState.Parent = Current;
+
+                // The other side has already been here, so the two halves form a complete path
+                if (OtherSide.IsVisited(Neighbor))
+                {
+                    const float PathCost = TentativeGCost + OtherSide.GetNode(Neighbor).GCost;
+                    if (PathCost < BestCost)
+                    {
+                        BestCost = PathCost;
+                        MeetingNode = Neighbor;
+                    }
+                }
+
+                // A node that cannot lead to anything cheaper than the best path found is not worth queueing
+                if (ThisSide.OpenSet.Contains(Neighbor))
+                {
+                    ThisSide.OpenSet.DecreaseKey(Neighbor, IsBetterNode);
+                }
+                else if (NeighborState.FCost() < BestCost)
+                {
+                    ThisSide.OpenSet.Push(Neighbor, IsBetterNode);
+                }
+            }
+        }
+    }
+
+    if (MeetingNode == INDEX_NONE)
+    {
+        return false;
+    }
+
+    // The forward half runs from the start to the meeting node, the backward half's parents lead on to the goal
+    Context.BuildPath(MeetingNode, OutPath);
+    for (int32 PathNode = ReverseContext.GetNode(MeetingNode).Parent; PathNode != INDEX_NONE; PathNode = ReverseContext.GetNode(PathNode).Parent)
+    {
+        OutPath.Add(PathNode);
+    }
+    return true;
+}
+
+bool FGridNodeStore::FindPathFixedPoint(int32 StartIndex, int32 GoalIndex, FPathSearchContext& Context, TArray<int32>& OutPath) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_PathfindingSearch);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FGridNodeStore_FindPathFixedPoint, PathfindingChannel);
+    FPathQueryStats QueryStats(OutPath);
+    QueryStats.Track(Context.NumExpanded, &Context.OpenSet);
+
+    OutPath.Reset();
+    if (!IsValidIndex(StartIndex) || !IsValidIndex(GoalIndex))
+    {
+        return false;
+    }
+
+    Context.BeginQuery(Num());
+
+    // Lowest total first, then closest to the goal. Both are integers, so equal really means equal.
+    auto IsBetterNode = [&Context](int32 A, int32 B)
+    {
+        const FPathSearchContext::FNodeState& StateA = Context.GetNode(A);
+        const FPathSearchContext::FNodeState& StateB = Context.GetNode(B);
+        const uint32 FCostA = StateA.FixedGCost + StateA.FixedHCost;
+        const uint32 FCostB = StateB.FixedGCost + StateB.FixedHCost;
+        return FCostA < FCostB || (FCostA == FCostB && StateA.FixedHCost < StateB.FixedHCost);
+    };
+
+    // No step can cost less than the cheapest tile, so the hex distance times that never overestimates
+    auto GetHeuristic = [this, GoalIndex](int32 Node)
+    {
+        return (uint32)GetHexDistance(Node, GoalIndex) * MinStepCost;
+    };
+
+    FPathSearchContext::FNodeState& StartState = Context.GetNode(StartIndex);
+    StartState.FixedGCost = 0;
+    StartState.FixedHCost = GetHeuristic(StartIndex);
+    Context.OpenSet.Push(StartIndex, IsBetterNode);
+
+    while (!Context.OpenSet.IsEmpty())
+    {
+        const int32 Current = Context.OpenSet.Pop(IsBetterNode);
+        FPathSearchContext::FNodeState& CurrentState = Context.GetNode(Current);
+        CurrentState.bClosed = true;
+        Context.NumExpanded++;
+
+        if (Current == GoalIndex)
+        {
+            Context.BuildPath(GoalIndex, OutPath);
+            return true;
+        }
+
+        if ((Context.NumExpanded & 1023) == 0 && Context.IsCancelled())
+        {
+            return false;
+        }
+
+        for (int32 Neighbor : GetNeighbors(Current))
+        {
+            if (Neighbor == INDEX_NONE || Obstacles[Neighbor])
+            {
+                continue;
+            }
+
+            // The shared node state starts out with float costs, so a node seen for the first time takes any cost
+            const bool bFirstVisit = !Context.IsVisited(Neighbor);
+            FPathSearchContext::FNodeState& NeighborState = Context.GetNode(Neighbor);
+            if (NeighborState.bClosed)
+            {
+                continue;
+            }
+
+            const uint32 TentativeGCost = CurrentState.FixedGCost + StepCosts[Neighbor];
+            if (bFirstVisit || TentativeGCost < NeighborState.FixedGCost)
+            {
+                NeighborState.FixedGCost = TentativeGCost;
+                NeighborState.Parent = Current;
+
+                if (bFirstVisit)
+                {
+                    NeighborState.FixedHCost = GetHeuristic(Neighbor);
+                    Context.OpenSet.Push(Neighbor, IsBetterNode);
+                }
+                else
+                {
+                    Context.OpenSet.DecreaseKey(Neighbor, IsBetterNode);
+                }
+            }
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "SharedTileArray.h"
+
+struct FPathSearchContext;
+class FLandmarkHeuristic;
+
+/*
+ * Flat storage for every tile of the hex grid, indexed by the tile's instance index in the grid's
+ * instanced mesh (Index = GridX * GridCount + GridY). Each property lives in its own contiguous array,
+ * and each node's adjacency is a fixed block of six neighbor indices, so a search reads a few dense
+ * arrays instead of chasing UObject pointers, and regenerating the grid reuses the same allocations.
+ */
+struct PATHFINDINGPROJECT_API FGridNodeStore
+{
+    // Number of neighbor slots per node. Slot N always points the same way: 0 is +X, and every following
+    // slot turns a further 60 degrees (1 and 2 are the next row, 3 is -X, 4 and 5 the previous row)
+    static constexpr int32 NumDirections = 6;
+
+    // Fixed-point cost units per step onto a tile of weight one (see StepCosts)
+    static constexpr uint32 FixedPointScale = 256;
+
+    // Lays out GridCount x GridCount tiles, gives them random weights, clears obstacles and links neighbors.
+    // Columns are laid out in parallel; Flags go to that ParallelFor, so ForceSingleThread keeps it on the calling thread.
+    void Build(int32 InGridCount, EParallelForFlags Flags = EParallelForFlags::None) { Build(InGridCount, FMath::Rand(), Flags); }
+
+    // Same, with the weights drawn from Seed, so a seed always gives the same grid however the columns are scheduled
+    void Build(int32 InGridCount, int32 Seed, EParallelForFlags Flags = EParallelForFlags::None);
+
+    // Returns the world location of the tile in column X and row Y
+    static FVector GetTileLocation(int32 X, int32 Y);
+
+    // Column and row of the tile next to column X and row Y in the given direction, on an unbounded grid
+    static FIntPoint GetNeighborCoords(int32 X, int32 Y, int32 Direction);
+
+    // Fills the neighbor table for the current grid size
+    void BuildNeighbors();
+
+    // Recomputes StepCosts and MinStepCost from the weights. Build calls it; call it again after editing Weights.
+    void UpdateStepCosts();
+
+    // A* search from StartIndex to GoalIndex using the caller's scratch context. OutPath receives the node
+    // indices from start to goal, or is left empty if the goal cannot be reached. The store is only read,
+    // so several searches with their own contexts may run at once. With Landmarks, the heuristic is the best of
+    // the straight-line distance and the landmark bound, which finds the same cost with fewer expansions.
+    bool FindPath(int32 StartIndex, int32 GoalIndex, FPathSearchContext& Context, TArray<int32>& OutPath, const FLandmarkHeuristic* Landmarks = nullptr) const;
+
+    /* Jump point search: same result cost as FindPath, but runs of tiles that share one weight and have no
+       obstacles around them are crossed in a single step instead of being queued tile by tile. Tiles next to
+       a different weight, an obstacle or the edge of the grid are expanded in every direction, like A* does. */
+    bool FindPathJumpPoint(int32 StartIndex, int32 GoalIndex, FPathSearchContext& Context, TArray<int32>& OutPath) const;
+
+    /* Bidirectional A*: one search runs forward from the start in Context while a second one runs backward
+       from the goal in ReverseContext, and the path is joined where they meet. Entering a tile costs that
+       tile's weight, so the backward search charges the weight of the tile it leaves rather than the one it
+       enters. Same result cost as FindPath; NumExpanded of each context counts its own direction. */
+    bool FindPathBidirectional(int32 StartIndex, int32 GoalIndex, FPathSearchContext& Context, FPathSearchContext& ReverseContext, TArray<int32>& OutPath) const;
+
+    /* A* on integers: every step onto a tile costs its StepCosts entry and the heuristic is the exact number of
+       hex steps to the goal times MinStepCost, so there is no square root in the loop and ties compare exactly.
+       Weights are rounded to 1/FixedPointScale, so the path found is optimal for the rounded weights and within
+       that rounding of FindPath's cost. */
+    bool FindPathFixedPoint(int32 StartIndex, int32 GoalIndex, FPathSearchContext& Context, TArray<int32>& OutPath) const;
+
+    // Number of steps between two tiles, walking neighbor to neighbor and ignoring weights and obstacles
+    int32 GetHexDistance(int32 IndexA, int32 IndexB) const;
+
+    int32 Num() const { return Positions.Num(); }
+
+    // Bytes used by the tile arrays
+    SIZE_T GetAllocatedSize() const
+    {
+        return Positions.GetAllocatedSize() + Weights.GetAllocatedSize() + Obstacles.GetAllocatedSize() + Neighbors.GetAllocatedSize() + StepCosts.GetAllocatedSize();
+    }
+
+    int32 GetGridCount() const { return GridCount; }
+    bool IsValidIndex(int32 Index) const { return Positions.IsValidIndex(Index); }
+
+    // Converts between grid coordinates and node indices
+    int32 GetIndex(int32 X, int32 Y) const { return X * GridCount + Y; }
+    int32 GetGridX(int32 Index) const { return Index / GridCount; }
+    int32 GetGridY(int32 Index) const { return Index % GridCount; }
+
+    // Returns the neighbor in the given direction, or INDEX_NONE past the edge of the grid
+    int32 GetNeighbor(int32 Index, int32 Direction) const { return Neighbors[Index * NumDirections + Direction]; }
+
+    // Returns all six neighbor slots of a node, including the INDEX_NONE ones
+    TArrayView<const int32> GetNeighbors(int32 Index) const { return MakeArrayView(Neighbors.GetData() + Index * NumDirections, NumDirections); }
+
+    // World location of each tile's center. Only changes when the grid is rebuilt, so copies of the store share it.
+    TSharedTileArray<FVector> Positions;
+
+    // Movement cost multiplier charged when entering each tile
+    TArray<float> Weights;
+
+    // Whether each tile blocks movement
+    TArray<bool> Obstacles;
+
+    // NumDirections neighbor indices per node, INDEX_NONE where the grid ends. Shared by copies, like Positions.
+    TSharedTileArray<int32> Neighbors;
+
+    // Weight of each tile in fixed point, FixedPointScale per unit of weight. Neighboring tile centers are all
+    // the same distance apart, so this is the whole cost of a step onto the tile.
+    TArray<uint32> StepCosts;
+
+    // Lowest entry of StepCosts, the least any single step can cost
+    uint32 MinStepCost = 0;
+
+private:
+    // Loads grid files straight into the arrays
+    friend class FGridFile;
+
+    // True past the edge of the grid and on obstacles
+    bool IsBlocked(int32 Index) const { return Index == INDEX_NONE || Obstacles[Index]; }
+
+    // Whether every open neighbor costs the same to enter as the tile itself
+    bool IsUniform(int32 Index) const;
+
+    // Whether a tile reached by a run in Direction has a side neighbor that no neighboring run can reach
+    bool HasForcedNeighbor(int32 Index, int32 Direction, bool bFirstLeg) const;
+
+    /* Walks from From in Direction, adding each step's cost to InOutCost, and returns the first tile where the
+       search has to stop, or INDEX_NONE if the run ends at an obstacle or the edge. A first-leg run also stops
+       where a run turning one direction further finds something; bOutExpandAll is false only for those stops. */
+    int32 Jump(int32 From, int32 Direction, bool bFirstLeg, int32 GoalIndex, float& InOutCost, bool& bOutExpandAll) const;
+
+    // Fills the six neighbor slots of every tile in column X into NeighborData, the neighbor table's elements
+    void BuildNeighborsForColumn(int32 X, int32* NeighborData) const;
+
+    // Fixed-point cost of a step onto a tile of the given weight
+    static uint32 ToStepCost(float Weight) { return (uint32)FMath::RoundToInt(FMath::Max(Weight, 0.0f) * FixedPointScale); }
+
+    // Number of tiles per row/column
+    int32 GridCount = 0;
+};
@@ -4,10 +4,10 @@
 #include "Engine/World.h"
 #include "EngineUtils.h"
 #include "Components/InstancedStaticMeshComponent.h"
-#include "DrawDebugHelpers.h"
 #include "Blueprint/UserWidget.h"
 #include "GridControlWidget.h"
 #include "EnhancedInputSubsystems.h"
+#include "PathfindingStats.h"
 
 void AGridPlayerController::BeginPlay()
 {
@@ -34,7 +34,7 @@ void AGridPlayerController::BeginPlay()
                 //Get the grid center, and set the camera to orbit around that point
                 FVector GridCenter = Grid->GetGridCenter();
                 CameraPawn->SetOrbitCenter(GridCenter);
-                UE_LOG(LogTemp, Log, TEXT("Camera targeting OrbitCenter: %s"), *GridCenter.ToString());
+                UE_LOG(LogPathfinding, Verbose, TEXT("Camera targeting OrbitCenter: %s"), *GridCenter.ToString());
 
                 // Sets the camera's position above the grid
                 FVector InitialLocation = GridCenter + FVector(CameraPawn->Radius, 0, 300);
@@ -90,7 +90,7 @@ void AGridPlayerController::SetupInputComponent()
 void AGridPlayerController::Tick(float DeltaSeconds)
 {
     Super::Tick(DeltaSeconds);
-    DrawPath(); // Draws the path visualizer each frame
+    DrawPath(); // Requests a new path when the start, goal or grid changed
 }
 
 void AGridPlayerController::HandleCameraRotation(const FInputActionValue& Value)
@@ -105,43 +105,33 @@ void AGridPlayerController::HandleCameraRotation(const FInputActionValue& Value)
 void AGridPlayerController::HandleLeftClick(const FInputActionValue& Value)
 {
     int32 InstanceIndex; // Stores the index of the tile under the mouse cursor
-    if (GetInstanceUnderCursor(InstanceIndex))
+    AGrid* Grid = Cast<AGrid>(GridActor);
+    if (Grid && GetInstanceUnderCursor(InstanceIndex))
     {
-        // Retrieve the instanced static mesh component of the Grid Actor
-        UInstancedStaticMeshComponent* InstancedMesh = Cast<UInstancedStaticMeshComponent>(GridActor->GetComponentByClass(UInstancedStaticMeshComponent::StaticClass()));
-        if (!InstancedMesh)
-        {
-            return;
-        }
-
         // If the player left-clicks on the start tile, reset it to a default tile
-        if (InstanceIndex == StartNodeIndex)
+        if (InstanceIndex == Grid->GetStartTile())
         {
-            InstancedMesh->SetCustomDataValue(InstanceIndex, 0, 0.0f, true);
-            StartNodeIndex = -1;
+            Grid->SetStartTile(INDEX_NONE);
         }
         // If the player left-clicks on the goal tile, reset it to a default tile
-        else if (InstanceIndex == GoalNodeIndex)
+        else if (InstanceIndex == Grid->GetGoalTile())
         {
-            InstancedMesh->SetCustomDataValue(InstanceIndex, 0, 0.0f, true);
-            GoalNodeIndex = -1;
+            Grid->SetGoalTile(INDEX_NONE);
         }
         else
         {
             // If the start node hasn't been set and the player left-clicks on a tile, mark it as the start node
-            if (StartNodeIndex == -1)
+            if (Grid->GetStartTile() == INDEX_NONE)
             {
-                StartNodeIndex = InstanceIndex;
-                InstancedMesh->SetCustomDataValue(InstanceIndex, 0, 1.0f, true);
-                UE_LOG(LogTemp, Log, TEXT("Set Start Tile: InstanceIndex %d"), InstanceIndex);
+                Grid->SetStartTile(InstanceIndex);
+                UE_LOG(LogPathfinding, VeryVerbose, TEXT("Set Start Tile: InstanceIndex %d"), InstanceIndex);
             }
 
-            // If the goal node hasn't been set and the tile that is clicked on is not the start node, mark this tile as the goal
-            else if (GoalNodeIndex == -1 && InstanceIndex != StartNodeIndex)
+            // If the goal node hasn't been set, mark this tile as the goal
+            else if (Grid->GetGoalTile() == INDEX_NONE)
             {
-                GoalNodeIndex = InstanceIndex;
-                InstancedMesh->SetCustomDataValue(InstanceIndex, 0, 2.0f, true);
-                UE_LOG(LogTemp, Log, TEXT("Set Goal Tile: InstanceIndex %d"), InstanceIndex);
+                Grid->SetGoalTile(InstanceIndex);
+                UE_LOG(LogPathfinding, VeryVerbose, TEXT("Set Goal Tile: InstanceIndex %d"), InstanceIndex);
             }
         }
     }
@@ -150,35 +140,20 @@ void AGridPlayerController::HandleLeftClick(const FInputActionValue& Value)
 void AGridPlayerController::HandleRightClick(const FInputActionValue& Value)
 {
     int32 InstanceIndex;
-    if (GetInstanceUnderCursor(InstanceIndex))
+    AGrid* Grid = Cast<AGrid>(GridActor);
+    if (Grid && GetInstanceUnderCursor(InstanceIndex) && Grid->GetNodeStore().IsValidIndex(InstanceIndex))
     {
-        UInstancedStaticMeshComponent* InstancedMesh = Cast<UInstancedStaticMeshComponent>(GridActor->GetComponentByClass(UInstancedStaticMeshComponent::StaticClass()));
-        if (!InstancedMesh)
+        // If the player right-clicks on an obstacle, reset its status to a default node
+        if (Grid->GetNodeStore().Obstacles[InstanceIndex])
         {
-            return;
-        }
-
-        AGrid* Grid = Cast<AGrid>(GridActor);
-        if (!Grid)
-        {
-            return;
-        }
-
-        // If the player right-clicks on an obstacle, reset its status to a default node and change its appearance
-        if (ObstacleIndices.Contains(InstanceIndex))
-        {
-            ObstacleIndices.Remove(InstanceIndex);
-            InstancedMesh->SetCustomDataValue(InstanceIndex, 0, 0.0f, true);
             Grid->SetNodeObstacle(InstanceIndex, false);
-            UE_LOG(LogTemp, Log, TEXT("Reset to Default: InstanceIndex %d"), InstanceIndex);
+            UE_LOG(LogPathfinding, VeryVerbose, TEXT("Reset to Default: InstanceIndex %d"), InstanceIndex);
         }
         // Otherwise, a right-click will mark a tile as an obstacle
         else
         {
-            ObstacleIndices.Add(InstanceIndex);
-            InstancedMesh->SetCustomDataValue(InstanceIndex, 0, 3.0f, true);
             Grid->SetNodeObstacle(InstanceIndex, true);
-            UE_LOG(LogTemp, Log, TEXT("Set Obstacle Tile: InstanceIndex %d"), InstanceIndex);
+            UE_LOG(LogPathfinding, VeryVerbose, TEXT("Set Obstacle Tile: InstanceIndex %d"), InstanceIndex);
         }
     }
 }
@@ -212,45 +187,82 @@ void AGridPlayerController::DrawPath()
     }
 
     // Check that both the start and goal nodes are set
-    if (StartNodeIndex != -1 && GoalNodeIndex != -1)
+    const int32 StartNodeIndex = Grid->GetStartTile();
+    const int32 GoalNodeIndex = Grid->GetGoalTile();
+    if (StartNodeIndex != INDEX_NONE && GoalNodeIndex != INDEX_NONE)
+    {
+        // Run the A* algorithm off the game thread. Until the new path arrives, the previous one stays on screen
+        RequestPathIfNeeded(Grid);
+    }
+    else if (PendingPathQuery.IsValid() || PathBuffer.Num() > 0)
     {
-        UE_LOG(LogTemp, Log, TEXT("DrawPath: StartNodeIndex = %d, GoalNodeIndex = %d"), StartNodeIndex, GoalNodeIndex);
+        // Start or goal was cleared, so drop the path and any query still working on it
+        PendingPathQuery.Cancel();
+        PendingPathQuery = FPathQueryHandle();
+        PathBuffer.Reset();
+        RequestedStartIndex = -1;
+        RequestedGoalIndex = -1;
+        ShowPath(Grid);
+    }
+}
 
-        // Run the A* algorithm and store the path 
-        TArray<UGridNode*> Path = Grid->FindPath(StartNodeIndex, GoalNodeIndex);
-        
-        UE_LOG(LogTemp, Log, TEXT("DrawPath: Computed path with %d nodes."), Path.Num());
+void AGridPlayerController::ShowPath(AGrid* Grid)
+{
+    UE_LOG(LogPathfinding, Verbose, TEXT("DrawPath: Showing path with %d nodes."), PathBuffer.Num());
 
-        // Ensure that the path has at least two nodes before drawing
-        if (Path.Num() > 1)
+    // A path from before the grid was regenerated can point past the new grid, so only its valid start is shown
+    const FGridNodeStore& Nodes = Grid->GetNodeStore();
+    PathPoints.Reset();
+    for (int32 PathNode : PathBuffer)
+    {
+        if (!Nodes.IsValidIndex(PathNode))
         {
-            for (int32 i = 0; i < Path.Num() - 1; i++)
-            {
-                FVector StartLocation = Path[i]->WorldPosition; // Location of the current node
-                FVector EndLocation = Path[i + 1]->WorldPosition; // Location of the next node
-                float LineOffset = 50.0f; // Places the visual line above the grid
-                StartLocation.Z += LineOffset;
-                EndLocation.Z += LineOffset;
+            break;
+        }
+        PathPoints.Add(Nodes.Positions[PathNode]);
+        UE_LOG(LogPathfinding, VeryVerbose, TEXT("DrawPath: Path point (%.2f, %.2f, %.2f)"), PathPoints.Last().X, PathPoints.Last().Y, PathPoints.Last().Z);
+    }
+    Grid->PathVisualizer->SetPath(PathVisualizerId, PathPoints);
+}
 
-                // Draws the debug line between each node until it completes the path
-                DrawDebugLine(GetWorld(), StartLocation, EndLocation, FColor::Green, false, 0.1f, 0, 5.0f);
+void AGridPlayerController::RequestPathIfNeeded(AGrid* Grid)
+{
+    const int32 StartNodeIndex = Grid->GetStartTile();
+    const int32 GoalNodeIndex = Grid->GetGoalTile();
+    if (StartNodeIndex == RequestedStartIndex && GoalNodeIndex == RequestedGoalIndex && Grid->GetGridVersion() == RequestedGridVersion)
+    {
+        return; // The pending or delivered path is still the right one
+    }
 
-                UE_LOG(LogTemp, Log, TEXT("DrawPath: Drawing line from (%.2f, %.2f, %.2f) to (%.2f, %.2f, %.2f)"),
-                    StartLocation.X, StartLocation.Y, StartLocation.Z,
-                    EndLocation.X, EndLocation.Y, EndLocation.Z);
-            }
-        }
-        else
+    // The previous query is superseded, so make sure its result is never applied
+    PendingPathQuery.Cancel();
+
+    RequestedStartIndex = StartNodeIndex;
+    RequestedGoalIndex = GoalNodeIndex;
+    RequestedGridVersion = Grid->GetGridVersion();
+
+    TWeakObjectPtr<AGridPlayerController> WeakThis(this);
+    TWeakObjectPtr<AGrid> WeakGrid(Grid);
+    PendingPathQuery = Grid->FindPathAsync(StartNodeIndex, GoalNodeIndex, [WeakThis, WeakGrid](const FPathQueryResult& Result)
+    {
+        AGridPlayerController* PlayerController = WeakThis.Get();
+        AGrid* QueriedGrid = WeakGrid.Get();
+        if (PlayerController && QueriedGrid)
         {
-            UE_LOG(LogTemp, Log, TEXT("DrawPath: Path has fewer than 2 nodes, no debug line drawn."));
+            PlayerController->PathBuffer = Result.Path;
+            PlayerController->PendingPathQuery = FPathQueryHandle();
+            PlayerController->ShowPath(QueriedGrid);
         }
-    }
+    });
 }
 
 void AGridPlayerController::ResetGridState()
 {
-    // -1 Indicates that the start and goal nodes have not been set
-    StartNodeIndex = -1;
-    GoalNodeIndex = -1;
-    ObstacleIndices.Empty(); // Clear the array of obstacles
+    // The grid holds the start, goal and obstacles, so clearing them there is all there is to do
+    if (AGrid* Grid = Cast<AGrid>(GridActor))
+    {
+        Grid->SetStartTile(INDEX_NONE);
+        Grid->SetGoalTile(INDEX_NONE);
+        Grid->ClearObstacles();
+    }
 }
@@ -4,6 +4,7 @@
 #include "GameFramework/PlayerController.h"
 #include "EnhancedInputComponent.h"
 #include "UGridNode.h"
+#include "PathQuery.h"
 #include "GridPlayerController.generated.h"
 
 UCLASS()
@@ -24,9 +25,15 @@ protected:
 	// Helper to get the instance index of the tile under the mouse cursor
 	bool GetInstanceUnderCursor(int32& OutInstanceIndex) const;
 
-	// Constructs the visual A* path
+	// Keeps the path shown for the current start and goal up to date
 	void DrawPath();
 
+	// Hands the tiles of PathBuffer to the grid's path visualizer, which redraws only if the path changed
+	void ShowPath(class AGrid* Grid);
+
+	// Sends an asynchronous path query when the start, goal or grid changed, cancelling the one it replaces
+	void RequestPathIfNeeded(class AGrid* Grid);
+
 private:
 	// Holds a reference to the camera pawn used for rotation
 	TObjectPtr<class AGridCameraPawn> CameraPawn;
@@ -55,16 +62,26 @@ private:
 	UPROPERTY(EditInstanceOnly, Category = "Grid")
 	TObjectPtr<class AActor> GridActor;
 
-	// Stores the indices of grid tiles marked as obstacles
-	TSet<int32> ObstacleIndices;
+	// Latest path delivered for the current start and goal
+	TArray<int32> PathBuffer;
 
-public:
+	// World locations of PathBuffer's tiles, kept between updates so showing a path does not allocate
+	TArray<FVector> PathPoints;
+
+	// Id of this player's path in the grid's path visualizer
+	static constexpr int32 PathVisualizerId = 0;
 
-	//Indicate that no start/goal node has been selected by default
-	int32 StartNodeIndex = -1;
-	int32 GoalNodeIndex = -1;
+	// Query that is computing the path for the current start, goal and grid version
+	FPathQueryHandle PendingPathQuery;
+
+	// Start, goal and grid version of the last path request, so a new one is only sent when one of them changes
+	int32 RequestedStartIndex = -1;
+	int32 RequestedGoalIndex = -1;
+	uint32 RequestedGridVersion = 0;
+
+public:
 
-	// Clears start/goal nodes and obstacles
+	// Clears start/goal nodes and obstacles on the grid
 	UFUNCTION(BlueprintCallable, Category = "Grid")
 	void ResetGridState();
 
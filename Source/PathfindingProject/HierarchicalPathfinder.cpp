@@ -0,0 +1,524 @@
+#include "HierarchicalPathfinder.h"
+#include "GridNodeStore.h"
+#include "PathfindingStats.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include <atomic>
+
+// Open stretches of border at least this many edges long get a transition at each end instead of one in the middle
+static constexpr int32 MinLongEntranceLength = 6;
+
+void FHierarchicalPathfinder::Build(const FGridNodeStore& InNodes, int32 InClusterSize, int32 MaxWorkers)
+{
+    Reset();
+    Nodes = &InNodes;
+    ClusterSize = FMath::Max(InClusterSize, 2);
+
+    const int32 GridCount = Nodes->GetGridCount();
+    NumClustersX = FMath::DivideAndRoundUp(GridCount, ClusterSize);
+    NumClustersY = NumClustersX;
+
+    // Clusters are numbered like the tiles, column major, so neighbors in the cluster grid are easy to find
+    Clusters.SetNum(NumClustersX * NumClustersY);
+    TArray<int32> AllClusters;
+    AllClusters.Reserve(Clusters.Num());
+    for (int32 ClusterIndex = 0; ClusterIndex < Clusters.Num(); ClusterIndex++)
+    {
+        FCluster& Cluster = Clusters[ClusterIndex];
+        Cluster.MinX = (ClusterIndex / NumClustersY) * ClusterSize;
+        Cluster.MinY = (ClusterIndex % NumClustersY) * ClusterSize;
+        Cluster.SizeX = FMath::Min(ClusterSize, GridCount - Cluster.MinX);
+        Cluster.SizeY = FMath::Min(ClusterSize, GridCount - Cluster.MinY);
+        AllClusters.Add(ClusterIndex);
+    }
+
+    EntranceSlots.Init(INDEX_NONE, Nodes->Num());
+    ClusterDirtyFlags.Init(false, Clusters.Num());
+    RebuildClusters(AllClusters, MaxWorkers);
+}
+
+void FHierarchicalPathfinder::Reset()
+{
+    Nodes = nullptr;
+    Clusters.Reset();
+    DirtyClusters.Reset();
+}
+
+void FHierarchicalPathfinder::NotifyNodeChanged(int32 Index)
+{
+    if (!Nodes || !Nodes->IsValidIndex(Index))
+    {
+        return;
+    }
+
+    auto MarkDirty = [this](int32 ClusterIndex)
+    {
+        if (!ClusterDirtyFlags[ClusterIndex])
+        {
+            ClusterDirtyFlags[ClusterIndex] = true;
+            DirtyClusters.Add(ClusterIndex);
+        }
+    };
+
+    // A tile on a border also changes the transitions the neighboring cluster sees
+    MarkDirty(GetClusterIndex(Index));
+    for (int32 Neighbor : Nodes->GetNeighbors(Index))
+    {
+        if (Neighbor != INDEX_NONE)
+        {
+            MarkDirty(GetClusterIndex(Neighbor));
+        }
+    }
+}
+
+bool FHierarchicalPathfinder::FindPath(int32 StartIndex, int32 GoalIndex, TArray<int32>& OutPath)
+{
+    SCOPE_CYCLE_COUNTER(STAT_PathfindingSearch);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FHierarchicalPathfinder_FindPath, PathfindingChannel);
+    FPathQueryStats QueryStats(OutPath);
+    QueryStats.Track(NumExpanded, &AbstractContext.OpenSet);
+
+    OutPath.Reset();
+    NumExpanded = 0;
+    if (!Nodes || !Nodes->IsValidIndex(StartIndex) || !Nodes->IsValidIndex(GoalIndex))
+    {
+        return false;
+    }
+
+    // Same answers as the flat search: a query onto its own start is a one-tile path, and obstacles cannot be entered
+    if (StartIndex == GoalIndex)
+    {
+        OutPath.Add(StartIndex);
+        return true;
+    }
+    if (Nodes->Obstacles[GoalIndex])
+    {
+        return false;
+    }
+
+    if (DirtyClusters.Num() > 0)
+    {
+        RebuildClusters(DirtyClusters);
+        for (int32 ClusterIndex : DirtyClusters)
+        {
+            ClusterDirtyFlags[ClusterIndex] = false;
+        }
+        DirtyClusters.Reset();
+    }
+
+    // Connect the start and goal to the entrances of their clusters
+    const int32 StartClusterIndex = GetClusterIndex(StartIndex);
+    const int32 GoalClusterIndex = GetClusterIndex(GoalIndex);
+    const FCluster& StartCluster = Clusters[StartClusterIndex];
+    const FCluster& GoalCluster = Clusters[GoalClusterIndex];
+    QuerySearch.Run(*Nodes, StartCluster, StartIndex, false);
+    GoalSearch.Run(*Nodes, GoalCluster, GoalIndex, true);
+
+    // A* over the entrances. The abstract nodes are ordinary node indices, so the regular search context works as is.
+    AbstractContext.BeginQuery(Nodes->Num());
+    auto IsBetterNode = [this](int32 A, int32 B)
+    {
+        return AbstractContext.IsBetterNode(A, B);
+    };
+
+    const FVector& GoalPosition = Nodes->Positions[GoalIndex];
+    auto Relax = [this, &IsBetterNode, &GoalPosition](int32 From, float FromCost, int32 To, float StepCost)
+    {
+        if (StepCost == TNumericLimits<float>::Max())
+        {
+            return;
+        }
+
+        FPathSearchContext::FNodeState& ToState = AbstractContext.GetNode(To);
+        const float TentativeGCost = FromCost + StepCost;
+        if (!ToState.bClosed && TentativeGCost < ToState.GCost)
+        {
+            ToState.GCost = TentativeGCost;
+            ToState.HCost = FVector::Dist(Nodes->Positions[To], GoalPosition);
+            ToState.Parent = From;
+            if (AbstractContext.OpenSet.Contains(To))
+            {
+                AbstractContext.OpenSet.DecreaseKey(To, IsBetterNode);
+            }
+            else
+            {
+                AbstractContext.OpenSet.Push(To, IsBetterNode);
+            }
+        }
+    };
+
+    FPathSearchContext::FNodeState& StartState = AbstractContext.GetNode(StartIndex);
+    StartState.GCost = 0.0f;
+    StartState.HCost = FVector::Dist(Nodes->Positions[StartIndex], GoalPosition);
+    AbstractContext.OpenSet.Push(StartIndex, IsBetterNode);
+
+    bool bReachedGoal = false;
+    while (!AbstractContext.OpenSet.IsEmpty())
+    {
+        const int32 Current = AbstractContext.OpenSet.Pop(IsBetterNode);
+        FPathSearchContext::FNodeState& CurrentState = AbstractContext.GetNode(Current);
+        CurrentState.bClosed = true;
+        NumExpanded++;
+
+        if (Current == GoalIndex)
+        {
+            bReachedGoal = true;
+            break;
+        }
+
+        const float CurrentCost = CurrentState.GCost;
+        if (Current == StartIndex)
+        {
+            // The start reaches its cluster's entrances, and the goal directly when they share a cluster
+            for (int32 Entrance : StartCluster.Entrances)
+            {
+                Relax(Current, CurrentCost, Entrance, QuerySearch.GetCost(*Nodes, StartCluster, Entrance));
+            }
+            if (StartClusterIndex == GoalClusterIndex)
+            {
+                Relax(Current, CurrentCost, GoalIndex, QuerySearch.GetCost(*Nodes, StartCluster, GoalIndex));
+            }
+
+            // The flat search lets a path leave a start that is an obstacle, but an obstacle is never an entrance,
+            // so its open neighbors across the border are added as stepping stones
+            if (Nodes->Obstacles[StartIndex])
+            {
+                for (int32 Neighbor : Nodes->GetNeighbors(StartIndex))
+                {
+                    if (Neighbor != INDEX_NONE && !Nodes->Obstacles[Neighbor] && GetClusterIndex(Neighbor) != StartClusterIndex)
+                    {
+                        Relax(Current, CurrentCost, Neighbor, FVector::Dist(Nodes->Positions[StartIndex], Nodes->Positions[Neighbor]) * Nodes->Weights[Neighbor]);
+                    }
+                }
+            }
+        }
+
+        // The start may itself be an entrance, so this is not an else
+        const int32 Slot = EntranceSlots[Current];
+        if (Slot != INDEX_NONE)
+        {
+            const int32 ClusterIndex = GetClusterIndex(Current);
+            const FCluster& Cluster = Clusters[ClusterIndex];
+            const int32 NumEntrances = Cluster.Entrances.Num();
+            for (int32 Other = 0; Other < NumEntrances; Other++)
+            {
+                if (Other != Slot)
+                {
+                    Relax(Current, CurrentCost, Cluster.Entrances[Other], Cluster.Distances[Slot * NumEntrances + Other]);
+                }
+            }
+            for (const FInterEdge& Edge : Cluster.InterEdges)
+            {
+                if (Edge.FromSlot == Slot)
+                {
+                    Relax(Current, CurrentCost, Edge.ToNode, Edge.Cost);
+                }
+            }
+            if (ClusterIndex == GoalClusterIndex)
+            {
+                Relax(Current, CurrentCost, GoalIndex, GoalSearch.GetCost(*Nodes, GoalCluster, Current));
+            }
+        }
+        else if (Current != StartIndex)
+        {
+            // A stepping stone: connect it to its own cluster the same way the start was
+            const int32 ClusterIndex = GetClusterIndex(Current);
+            const FCluster& Cluster = Clusters[ClusterIndex];
+            StepSearch.Run(*Nodes, Cluster, Current, false);
+            for (int32 Entrance : Cluster.Entrances)
+            {
+                Relax(Current, CurrentCost, Entrance, StepSearch.GetCost(*Nodes, Cluster, Entrance));
+            }
+            if (ClusterIndex == GoalClusterIndex)
+            {
+                Relax(Current, CurrentCost, GoalIndex, StepSearch.GetCost(*Nodes, Cluster, GoalIndex));
+            }
+        }
+    }
+
+    if (!bReachedGoal)
+    {
+        return false;
+    }
+
+    // Fill in the tiles between consecutive abstract nodes. Steps between clusters are single border crossings.
+    AbstractContext.BuildPath(GoalIndex, AbstractPath);
+    OutPath.Add(AbstractPath[0]);
+    for (int32 i = 1; i < AbstractPath.Num(); i++)
+    {
+        if (GetClusterIndex(AbstractPath[i - 1]) != GetClusterIndex(AbstractPath[i]))
+        {
+            OutPath.Add(AbstractPath[i]);
+        }
+        else if (!RefineSegment(AbstractPath[i - 1], AbstractPath[i], OutPath))
+        {
+            OutPath.Reset();
+            return false;
+        }
+    }
+    return true;
+}
+
+int32 FHierarchicalPathfinder::GetNumEntrances() const
+{
+    int32 NumEntrances = 0;
+    for (const FCluster& Cluster : Clusters)
+    {
+        NumEntrances += Cluster.Entrances.Num();
+    }
+    return NumEntrances;
+}
+
+SIZE_T FHierarchicalPathfinder::GetAllocatedSize() const
+{
+    SIZE_T Size = Clusters.GetAllocatedSize() + EntranceSlots.GetAllocatedSize();
+    for (const FCluster& Cluster : Clusters)
+    {
+        Size += Cluster.Entrances.GetAllocatedSize() + Cluster.Distances.GetAllocatedSize() + Cluster.InterEdges.GetAllocatedSize();
+    }
+    return Size;
+}
+
+int32 FHierarchicalPathfinder::GetClusterIndex(int32 Node) const
+{
+    return (Nodes->GetGridX(Node) / ClusterSize) * NumClustersY + Nodes->GetGridY(Node) / ClusterSize;
+}
+
+void FHierarchicalPathfinder::FindTransitions(int32 LowCluster, int32 HighCluster, TArray<TPair<int32, int32>>& Candidates, TArray<TPair<int32, int32>>& OutTransitions) const
+{
+    Candidates.Reset();
+    OutTransitions.Reset();
+
+    // Every open edge from a border tile of Low into High. Tiles are visited in index order, which walks
+    // along each border, so neighboring edges end up next to each other.
+    const FCluster& Low = Clusters[LowCluster];
+    const FCluster& High = Clusters[HighCluster];
+    for (int32 x = Low.MinX; x < Low.MinX + Low.SizeX; x++)
+    {
+        for (int32 y = Low.MinY; y < Low.MinY + Low.SizeY; y++)
+        {
+            const bool bOnBorder = x == Low.MinX || x == Low.MinX + Low.SizeX - 1 || y == Low.MinY || y == Low.MinY + Low.SizeY - 1;
+            const int32 Inside = Nodes->GetIndex(x, y);
+            if (!bOnBorder || Nodes->Obstacles[Inside])
+            {
+                continue;
+            }
+
+            for (int32 Outside : Nodes->GetNeighbors(Inside))
+            {
+                if (Outside != INDEX_NONE && !Nodes->Obstacles[Outside] && High.Contains(Nodes->GetGridX(Outside), Nodes->GetGridY(Outside)))
+                {
+                    Candidates.Emplace(Inside, Outside);
+                }
+            }
+        }
+    }
+
+    // A tile can have two or three edges into High. Ordering those by the outside tile keeps them in border order too.
+    Candidates.Sort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B)
+    {
+        return A.Key != B.Key ? A.Key < B.Key : A.Value < B.Value;
+    });
+
+    auto IsSameOrAdjacent = [this](int32 A, int32 B)
+    {
+        return A == B || Nodes->GetNeighbors(A).Contains(B);
+    };
+
+    // Split the edges into unbroken stretches and place the transitions of each one
+    int32 RunStart = 0;
+    for (int32 i = 1; i <= Candidates.Num(); i++)
+    {
+        const bool bRunEnds = i == Candidates.Num()
+            || !IsSameOrAdjacent(Candidates[i - 1].Key, Candidates[i].Key)
+            || !IsSameOrAdjacent(Candidates[i - 1].Value, Candidates[i].Value);
+        if (!bRunEnds)
+        {
+            continue;
+        }
+
+        const int32 RunLength = i - RunStart;
+        if (RunLength >= MinLongEntranceLength)
+        {
+            OutTransitions.Add(Candidates[RunStart]);
+            OutTransitions.Add(Candidates[i - 1]);
+        }
+        else
+        {
+            OutTransitions.Add(Candidates[RunStart + RunLength / 2]);
+        }
+        RunStart = i;
+    }
+}
+
+void FHierarchicalPathfinder::RebuildCluster(int32 ClusterIndex, FClusterSearch& Search)
+{
+    FCluster& Cluster = Clusters[ClusterIndex];
+    for (int32 Entrance : Cluster.Entrances)
+    {
+        EntranceSlots[Entrance] = INDEX_NONE;
+    }
+    Cluster.Entrances.Reset();
+    Cluster.InterEdges.Reset();
+
+    // Borders can touch all eight surrounding clusters, since odd rows reach diagonally into the next column
+    const int32 ClusterX = ClusterIndex / NumClustersY;
+    const int32 ClusterY = ClusterIndex % NumClustersY;
+    for (int32 OffsetX = -1; OffsetX <= 1; OffsetX++)
+    {
+        for (int32 OffsetY = -1; OffsetY <= 1; OffsetY++)
+        {
+            const int32 NeighborX = ClusterX + OffsetX;
+            const int32 NeighborY = ClusterY + OffsetY;
+            if ((OffsetX == 0 && OffsetY == 0) || NeighborX < 0 || NeighborX >= NumClustersX || NeighborY < 0 || NeighborY >= NumClustersY)
+            {
+                continue;
+            }
+
+            const int32 NeighborCluster = NeighborX * NumClustersY + NeighborY;
+            const bool bIsLow = ClusterIndex < NeighborCluster;
+            FindTransitions(bIsLow ? ClusterIndex : NeighborCluster, bIsLow ? NeighborCluster : ClusterIndex, Search.Candidates, Search.Transitions);
+
+            for (const TPair<int32, int32>& Transition : Search.Transitions)
+            {
+                const int32 Inside = bIsLow ? Transition.Key : Transition.Value;
+                const int32 Outside = bIsLow ? Transition.Value : Transition.Key;
+
+                int32& Slot = EntranceSlots[Inside];
+                if (Slot == INDEX_NONE)
+                {
+                    Slot = Cluster.Entrances.Add(Inside);
+                }
+                const float Cost = FVector::Dist(Nodes->Positions[Inside], Nodes->Positions[Outside]) * Nodes->Weights[Outside];
+                Cluster.InterEdges.Add({ Slot, Outside, Cost });
+            }
+        }
+    }
+
+    // One search from every entrance gives the costs to all the others
+    const int32 NumEntrances = Cluster.Entrances.Num();
+    Cluster.Distances.SetNumUninitialized(NumEntrances * NumEntrances, false);
+    for (int32 From = 0; From < NumEntrances; From++)
+    {
+        Search.Run(*Nodes, Cluster, Cluster.Entrances[From], false);
+        for (int32 To = 0; To < NumEntrances; To++)
+        {
+            Cluster.Distances[From * NumEntrances + To] = Search.GetCost(*Nodes, Cluster, Cluster.Entrances[To]);
+        }
+    }
+}
+
+void FHierarchicalPathfinder::RebuildClusters(TArrayView<const int32> ClusterIndices, int32 MaxWorkers)
+{
+    if (MaxWorkers <= 0)
+    {
+        MaxWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+    }
+    const int32 NumWorkers = FMath::Min(MaxWorkers, ClusterIndices.Num());
+    if (WorkerSearches.Num() < NumWorkers)
+    {
+        WorkerSearches.SetNum(NumWorkers);
+    }
+
+    // Each cluster only writes its own data and the entrance slots of its own tiles, so clusters rebuild independently
+    std::atomic<int32> NextCluster(0);
+    ParallelFor(NumWorkers, [this, &ClusterIndices, &NextCluster](int32 WorkerIndex)
+    {
+        for (int32 i = NextCluster++; i < ClusterIndices.Num(); i = NextCluster++)
+        {
+            RebuildCluster(ClusterIndices[i], WorkerSearches[WorkerIndex]);
+        }
+    });
+}
+
+bool FHierarchicalPathfinder::RefineSegment(int32 FromNode, int32 ToNode, TArray<int32>& OutPath)
+{
+    const FCluster& Cluster = Clusters[GetClusterIndex(FromNode)];
+    QuerySearch.Run(*Nodes, Cluster, FromNode, false, ToNode);
+    if (QuerySearch.GetCost(*Nodes, Cluster, ToNode) == TNumericLimits<float>::Max())
+    {
+        return false;
+    }
+
+    // Parents lead back from ToNode, so append the segment and flip it in place
+    const int32 SegmentStart = OutPath.Num();
+    for (int32 Node = ToNode; Node != FromNode; Node = QuerySearch.Parents[(Nodes->GetGridX(Node) - Cluster.MinX) * Cluster.SizeY + Nodes->GetGridY(Node) - Cluster.MinY])
+    {
+        OutPath.Add(Node);
+    }
+    for (int32 Low = SegmentStart, High = OutPath.Num() - 1; Low < High; Low++, High--)
+    {
+        Swap(OutPath[Low], OutPath[High]);
+    }
+    return true;
+}
+
+void FHierarchicalPathfinder::FClusterSearch::Run(const FGridNodeStore& Nodes, const FCluster& Cluster, int32 SourceNode, bool bReverse, int32 StopNode)
+{
+    const int32 NumLocal = Cluster.SizeX * Cluster.SizeY;
+    Costs.SetNumUninitialized(NumLocal, false);
+    Parents.SetNumUninitialized(NumLocal, false);
+    for (int32 Local = 0; Local < NumLocal; Local++)
+    {
+        Costs[Local] = TNumericLimits<float>::Max();
+        Parents[Local] = INDEX_NONE;
+    }
+    OpenSet.Reserve(NumLocal);
+    OpenSet.Clear();
+
+    auto IsCheaper = [this](int32 A, int32 B)
+    {
+        return Costs[A] < Costs[B];
+    };
+
+    const int32 SourceLocal = (Nodes.GetGridX(SourceNode) - Cluster.MinX) * Cluster.SizeY + Nodes.GetGridY(SourceNode) - Cluster.MinY;
+    Costs[SourceLocal] = 0.0f;
+    OpenSet.Push(SourceLocal, IsCheaper);
+
+    while (!OpenSet.IsEmpty())
+    {
+        const int32 CurrentLocal = OpenSet.Pop(IsCheaper);
+        const int32 Current = Nodes.GetIndex(Cluster.MinX + CurrentLocal / Cluster.SizeY, Cluster.MinY + CurrentLocal % Cluster.SizeY);
+        if (Current == StopNode)
+        {
+            break;
+        }
+
+        for (int32 Neighbor : Nodes.GetNeighbors(Current))
+        {
+            if (Neighbor == INDEX_NONE || Nodes.Obstacles[Neighbor])
+            {
+                continue;
+            }
+            const int32 NeighborX = Nodes.GetGridX(Neighbor);
+            const int32 NeighborY = Nodes.GetGridY(Neighbor);
+            if (!Cluster.Contains(NeighborX, NeighborY))
+            {
+                continue;
+            }
+
+            // Entering a tile is charged its weight, so walking backwards charges the tile being left
+            const float StepCost = FVector::Dist(Nodes.Positions[Current], Nodes.Positions[Neighbor]) * Nodes.Weights[bReverse ? Current : Neighbor];
+            const float NewCost = Costs[CurrentLocal] + StepCost;
+            const int32 NeighborLocal = (NeighborX - Cluster.MinX) * Cluster.SizeY + NeighborY - Cluster.MinY;
+            if (NewCost < Costs[NeighborLocal])
+            {
+                Costs[NeighborLocal] = NewCost;
+                Parents[NeighborLocal] = Current;
+                if (OpenSet.Contains(NeighborLocal))
+                {
+                    OpenSet.DecreaseKey(NeighborLocal, IsCheaper);
+                }
+                else
+                {
+                    OpenSet.Push(NeighborLocal, IsCheaper);
+                }
+            }
+        }
+    }
+}
+
+float FHierarchicalPathfinder::FClusterSearch::GetCost(const FGridNodeStore& Nodes, const FCluster& Cluster, int32 Node) const
+{
+    return Costs[(Nodes.GetGridX(Node) - Cluster.MinX) * Cluster.SizeY + Nodes.GetGridY(Node) - Cluster.MinY];
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IndexedNodeHeap.h"
+#include "PathSearchContext.h"
+
+struct FGridNodeStore;
+
+/*
+ * Hierarchical A* (HPA*) for grids too large to search tile by tile.
+ * The grid is cut into square clusters of ClusterSize x ClusterSize tiles. Where two clusters touch, every
+ * open stretch of border gets one or two transitions, and the tiles on either side of a transition become
+ * entrances. Each cluster stores the cost between every pair of its entrances, found by a search that
+ * stays inside the cluster. A query searches this much smaller graph of entrances and then fills in the
+ * tiles between consecutive entrances with short searches inside one cluster each.
+ *
+ * Paths are usually within a few percent of optimal, not always optimal. Editing a tile only rebuilds its
+ * cluster, plus the neighboring clusters when the tile sits on a border; the rebuild happens on the next query.
+ */
+class PATHFINDINGPROJECT_API FHierarchicalPathfinder
+{
+public:
+    // Cuts the grid into clusters and computes every cluster's entrances and distances. The store has to
+    // stay alive until the pathfinder is reset. MaxWorkers limits the threads used; zero uses all of them.
+    void Build(const FGridNodeStore& InNodes, int32 InClusterSize, int32 MaxWorkers = 0);
+
+    // Drops the clusters, for example because the grid was regenerated
+    void Reset();
+
+    // Whether Build has run since the last reset
+    bool IsBuilt() const { return Nodes != nullptr; }
+
+    int32 GetClusterSize() const { return ClusterSize; }
+
+    // Marks the clusters affected by a tile's weight or obstacle change for rebuilding
+    void NotifyNodeChanged(int32 Index);
+
+    // Finds a path the same way FGridNodeStore::FindPath reports one: node indices from start to goal, or
+    // false and an empty OutPath if the goal cannot be reached. Rebuilds edited clusters first.
+    bool FindPath(int32 StartIndex, int32 GoalIndex, TArray<int32>& OutPath);
+
+    // Total number of entrances across all clusters
+    int32 GetNumEntrances() const;
+
+    // Bytes used by the clusters and the entrance lookup
+    SIZE_T GetAllocatedSize() const;
+
+    // Number of abstract nodes the last FindPath call expanded
+    int32 NumExpanded = 0;
+
+private:
+    // Edge from an entrance to the tile across the border
+    struct FInterEdge
+    {
+        int32 FromSlot; // Entrance in this cluster
+        int32 ToNode; // Entrance in the neighboring cluster
+        float Cost;
+    };
+
+    struct FCluster
+    {
+        // First column and row of the cluster, and its size (clusters on the far edges may be smaller)
+        int32 MinX = 0;
+        int32 MinY = 0;
+        int32 SizeX = 0;
+        int32 SizeY = 0;
+
+        // Node index of each entrance
+        TArray<int32> Entrances;
+
+        // Cost from entrance I to entrance J at I * Entrances.Num() + J, the max float if J cannot be reached inside the cluster
+        TArray<float> Distances;
+
+        // Edges leaving the cluster
+        TArray<FInterEdge> InterEdges;
+
+        bool Contains(int32 X, int32 Y) const { return X >= MinX && X < MinX + SizeX && Y >= MinY && Y < MinY + SizeY; }
+    };
+
+    // Dijkstra scratch state confined to a single cluster, indexed by the tile's position in the cluster
+    struct FClusterSearch
+    {
+        TArray<float> Costs;
+        TArray<int32> Parents;
+        FIndexedNodeHeap OpenSet;
+
+        // Border edges and the transitions picked from them while a cluster is rebuilt
+        TArray<TPair<int32, int32>> Candidates;
+        TArray<TPair<int32, int32>> Transitions;
+
+        // Finds the cost from SourceNode to every tile of the cluster, or with bReverse the cost from every tile
+        // to SourceNode. Stops early once StopNode is settled.
+        void Run(const FGridNodeStore& Nodes, const FCluster& Cluster, int32 SourceNode, bool bReverse, int32 StopNode = INDEX_NONE);
+
+        // Cost found for a tile of the cluster by the last run
+        float GetCost(const FGridNodeStore& Nodes, const FCluster& Cluster, int32 Node) const;
+    };
+
+    int32 GetClusterIndex(int32 Node) const;
+
+    // Collects the transitions on the border between two clusters as (tile in Low, tile in High) pairs, using
+    // Candidates as scratch. Always walks the lower cluster, so both clusters see the same transitions no
+    // matter which one asks.
+    void FindTransitions(int32 LowCluster, int32 HighCluster, TArray<TPair<int32, int32>>& Candidates, TArray<TPair<int32, int32>>& OutTransitions) const;
+
+    // Recomputes a cluster's entrances, edges and distances from the current tiles
+    void RebuildCluster(int32 ClusterIndex, FClusterSearch& Search);
+
+    // Rebuilds the given clusters in parallel
+    void RebuildClusters(TArrayView<const int32> ClusterIndices, int32 MaxWorkers = 0);
+
+    // Appends the tiles after FromNode up to and including ToNode, searching inside their shared cluster
+    bool RefineSegment(int32 FromNode, int32 ToNode, TArray<int32>& OutPath);
+
+    const FGridNodeStore* Nodes = nullptr;
+    int32 ClusterSize = 0;
+    int32 NumClustersX = 0;
+    int32 NumClustersY = 0;
+
+    TArray<FCluster> Clusters;
+
+    // Slot of each tile in its cluster's entrance list, INDEX_NONE for tiles that are not entrances
+    TArray<int32> EntranceSlots;
+
+    // Clusters waiting to be rebuilt, and a flag per cluster so each is only queued once
+    TArray<int32> DirtyClusters;
+    TBitArray<> ClusterDirtyFlags;
+
+    // Scratch state for queries
+    FPathSearchContext AbstractContext;
+    FClusterSearch QuerySearch;
+    FClusterSearch GoalSearch;
+    FClusterSearch StepSearch;
+    TArray<int32> AbstractPath;
+    TArray<FClusterSearch> WorkerSearches;
+};
@@ -0,0 +1,211 @@
+#include "IncrementalPathPlanner.h"
+#include "GridNodeStore.h"
+#include "Algo/Reverse.h"
+#include "PathfindingStats.h"
+
+// Cost of a node nobody has found a way to yet
+static constexpr float UnreachableCost = TNumericLimits<float>::Max();
+
+void FIncrementalPathPlanner::Initialize(const FGridNodeStore& InNodes, int32 InStartIndex, int32 InGoalIndex)
+{
+    Reset();
+    if (!InNodes.IsValidIndex(InStartIndex) || !InNodes.IsValidIndex(InGoalIndex))
+    {
+        return;
+    }
+
+    Nodes = &InNodes;
+    StartIndex = InStartIndex;
+    GoalIndex = InGoalIndex;
+
+    // Everything starts out unreachable, except the start which costs nothing to reach
+    const int32 NumNodes = Nodes->Num();
+    GCosts.Init(UnreachableCost, NumNodes);
+    RhsCosts.Init(UnreachableCost, NumNodes);
+    Keys.SetNumUninitialized(NumNodes, false);
+    OpenSet.Reserve(NumNodes);
+
+    RhsCosts[StartIndex] = 0.0f;
+    Keys[StartIndex] = CalculateKey(StartIndex);
+    OpenSet.Push(StartIndex, [this](int32 A, int32 B) { return Keys[A] < Keys[B]; });
+}
+
+void FIncrementalPathPlanner::Reset()
+{
+    Nodes = nullptr;
+    StartIndex = INDEX_NONE;
+    GoalIndex = INDEX_NONE;
+    OpenSet.Clear();
+}
+
+void FIncrementalPathPlanner::NotifyNodeChanged(int32 Index)
+{
+    // The edges that changed are the ones entering the tile, so only its own Rhs can be affected directly.
+    // If its G changes as a result, the search passes that on to the neighbors when it expands the tile.
+    if (Nodes && Nodes->IsValidIndex(Index))
+    {
+        UpdateNode(Index);
+    }
+}
+
+bool FIncrementalPathPlanner::FindPath(TArray<int32>& OutPath)
+{
+    SCOPE_CYCLE_COUNTER(STAT_PathfindingSearch);
+    TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(FIncrementalPathPlanner_FindPath, PathfindingChannel);
+    FPathQueryStats QueryStats(OutPath);
+    QueryStats.Track(NumExpanded);
+
+    OutPath.Reset();
+    NumExpanded = 0;
+    if (!Nodes)
+    {
+        return false;
+    }
+
+    ComputeShortestPath();
+    if (GCosts[GoalIndex] == UnreachableCost)
+    {
+        return false;
+    }
+
+    // Walk back from the goal, always through the neighbor the goal's cost came from. G strictly drops
+    // along the way, so the walk cannot loop; the step limit only guards against a corrupted tree.
+    OutPath.Add(GoalIndex);
+    for (int32 Current = GoalIndex; Current != StartIndex && OutPath.Num() <= Nodes->Num();)
+    {
+        int32 BestNeighbor = INDEX_NONE;
+        float BestCost = UnreachableCost;
+        for (int32 Neighbor : Nodes->GetNeighbors(Current))
+        {
+            if (Neighbor != INDEX_NONE && GCosts[Neighbor] != UnreachableCost)
+            {
+                const float Cost = GCosts[Neighbor] + GetEdgeCost(Neighbor, Current);
+                if (Cost < BestCost)
+                {
+                    BestCost = Cost;
+                    BestNeighbor = Neighbor;
+                }
+            }
+        }
+
+        if (BestNeighbor == INDEX_NONE)
+        {
+            OutPath.Reset();
+            return false;
+        }
+        OutPath.Add(BestNeighbor);
+        Current = BestNeighbor;
+    }
+
+    Algo::Reverse(OutPath);
+    return true;
+}
+
+FIncrementalPathPlanner::FKey FIncrementalPathPlanner::CalculateKey(int32 Node) const
+{
+    const float Cost = FMath::Min(GCosts[Node], RhsCosts[Node]);
+    if (Cost == UnreachableCost)
+    {
+        return { UnreachableCost, UnreachableCost };
+    }
+
+    // Same Euclidean heuristic as the A* search. It never overestimates since every weight is at least one.
+    const float Heuristic = FVector::Dist(Nodes->Positions[Node], Nodes->Positions[GoalIndex]);
+    return { Cost + Heuristic, Cost };
+}
+
+float FIncrementalPathPlanner::GetEdgeCost(int32 From, int32 To) const
+{
+    if (Nodes->Obstacles[To])
+    {
+        return UnreachableCost;
+    }
+    return FVector::Dist(Nodes->Positions[From], Nodes->Positions[To]) * Nodes->Weights[To];
+}
+
+float FIncrementalPathPlanner::GetBestNeighborCost(int32 Node) const
+{
+    // Nothing can enter an obstacle, so there is no need to look at the neighbors
+    if (Nodes->Obstacles[Node])
+    {
+        return UnreachableCost;
+    }
+
+    float BestCost = UnreachableCost;
+    for (int32 Neighbor : Nodes->GetNeighbors(Node))
+    {
+        if (Neighbor != INDEX_NONE && GCosts[Neighbor] != UnreachableCost)
+        {
+            BestCost = FMath::Min(BestCost, GCosts[Neighbor] + GetEdgeCost(Neighbor, Node));
+        }
+    }
+    return BestCost;
+}
+
+void FIncrementalPathPlanner::UpdateNode(int32 Node)
+{
+    auto IsBetterNode = [this](int32 A, int32 B)
+    {
+        return Keys[A] < Keys[B];
+    };
+
+    // The start's cost is fixed at zero
+    if (Node != StartIndex)
+    {
+        RhsCosts[Node] = GetBestNeighborCost(Node);
+    }
+
+    if (GCosts[Node] != RhsCosts[Node])
+    {
+        // Inconsistent: queue the node, or move it to where its new key belongs
+        Keys[Node] = CalculateKey(Node);
+        if (OpenSet.Contains(Node))
+        {
+            OpenSet.Update(Node, IsBetterNode);
+        }
+        else
+        {
+            OpenSet.Push(Node, IsBetterNode);
+        }
+    }
+    else if (OpenSet.Contains(Node))
+    {
+        // An edit put the node back in agreement before the search got to it
+        OpenSet.Remove(Node, IsBetterNode);
+    }
+}
+
+void FIncrementalPathPlanner::ComputeShortestPath()
+{
+    auto IsBetterNode = [this](int32 A, int32 B)
+    {
+        return Keys[A] < Keys[B];
+    };
+
+    // Stop once nothing queued can still improve the goal, and the goal itself agrees with its neighbors
+    while (!OpenSet.IsEmpty() && (Keys[OpenSet.Top()] < CalculateKey(GoalIndex) || GCosts[GoalIndex] != RhsCosts[GoalIndex]))
+    {
+        const int32 Current = OpenSet.Pop(IsBetterNode);
+        NumExpanded++;
+
+        if (GCosts[Current] > RhsCosts[Current])
+        {
+            // A cheaper way in was found: settle on it and let the neighbors pick it up
+            GCosts[Current] = RhsCosts[Current];
+        }
+        else
+        {
+            // The node got more expensive: forget its cost and requeue it, along with every neighbor that may have relied on it
+            GCosts[Current] = UnreachableCost;
+            UpdateNode(Current);
+        }
+
+        for (int32 Neighbor : Nodes->GetNeighbors(Current))
+        {
+            if (Neighbor != INDEX_NONE && !Nodes->Obstacles[Neighbor])
+            {
+                UpdateNode(Neighbor);
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IndexedNodeHeap.h"
+
+struct FGridNodeStore;
+
+/*
+ * Lifelong Planning A* between a fixed start and goal. The planner keeps its search tree between calls,
+ * and when tiles change it only re-examines the nodes whose cost to reach actually changed, so a single
+ * toggled obstacle usually costs a handful of expansions instead of a whole new search.
+ *
+ * Every node keeps two costs: G, the cost the last expansion settled on, and Rhs, the best cost its
+ * neighbors currently offer. A node whose two costs disagree is queued until the search repairs it.
+ * Costs are charged exactly like FGridNodeStore::FindPath, so both return paths of the same cost.
+ */
+class PATHFINDINGPROJECT_API FIncrementalPathPlanner
+{
+public:
+    // Starts planning from StartIndex to GoalIndex on the given tiles, dropping any previous search tree.
+    // The planner reads the store on every call, so it has to stay alive until the planner is reset.
+    void Initialize(const FGridNodeStore& InNodes, int32 InStartIndex, int32 InGoalIndex);
+
+    // Forgets the search tree, for example because the grid was rebuilt or most of its tiles changed
+    void Reset();
+
+    // Whether the planner holds a search tree for these endpoints
+    bool IsPlanning(int32 InStartIndex, int32 InGoalIndex) const { return Nodes && StartIndex == InStartIndex && GoalIndex == InGoalIndex; }
+
+    // Tells the planner that a tile's weight or obstacle state changed. The repair itself is deferred to the next FindPath.
+    void NotifyNodeChanged(int32 Index);
+
+    // Brings the search tree up to date with the edits since the last call and writes the path from start to
+    // goal into OutPath. Returns false and leaves OutPath empty if the goal cannot be reached.
+    bool FindPath(TArray<int32>& OutPath);
+
+    // Number of nodes the last FindPath call had to expand
+    int32 NumExpanded = 0;
+
+private:
+    // Queue order of a node: lowest estimated total cost first, then lowest cost from the start
+    struct FKey
+    {
+        float Primary;
+        float Secondary;
+
+        bool operator<(const FKey& Other) const
+        {
+            return Primary < Other.Primary || (Primary == Other.Primary && Secondary < Other.Secondary);
+        }
+    };
+
+    FKey CalculateKey(int32 Node) const;
+
+    // Cost of stepping from one node onto a neighboring one, infinite if the neighbor is an obstacle
+    float GetEdgeCost(int32 From, int32 To) const;
+
+    // Best cost to reach the node through any of its neighbors
+    float GetBestNeighborCost(int32 Node) const;
+
+    // Recomputes a node's Rhs and queues it if it no longer agrees with its G
+    void UpdateNode(int32 Node);
+
+    // Expands queued nodes until the goal's cost is settled
+    void ComputeShortestPath();
+
+    // Tiles being planned on, null until Initialize
+    const FGridNodeStore* Nodes = nullptr;
+
+    int32 StartIndex = INDEX_NONE;
+    int32 GoalIndex = INDEX_NONE;
+
+    TArray<float> GCosts;
+    TArray<float> RhsCosts;
+
+    // Key each queued node was last queued with
+    TArray<FKey> Keys;
+
+    // Nodes whose G and Rhs disagree
+    FIndexedNodeHeap OpenSet;
+};
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Binary min-heap of node indices used as the A* open set.
+ * Each node's slot in the heap is tracked in a position table, so membership is a single array read
+ * and a node that is already queued can have its key changed in O(log n) instead of being searched for.
+ * The heap does not own the keys: every operation takes the predicate that orders two node indices,
+ * the same way TArray::HeapPush/HeapPop do.
+ */
+class FIndexedNodeHeap
+{
+public:
+    // Grows the heap to hold every node of a graph with NumNodes nodes. Returns true if it had to allocate.
+    bool Reserve(int32 NumNodes)
+    {
+        if (Positions.Num() >= NumNodes)
+        {
+            return false;
+        }
+        Items.Reserve(NumNodes);
+        Positions.Reserve(NumNodes);
+        while (Positions.Num() < NumNodes)
+        {
+            Positions.Add(INDEX_NONE);
+        }
+        return true;
+    }
+
+    // Empties the heap. Only the nodes still queued are touched, so this is cheap after a search that ended early.
+    void Clear()
+    {
+        for (int32 Node : Items)
+        {
+            Positions[Node] = INDEX_NONE;
+        }
+        Items.Reset();
+        PeakNum = 0;
+    }
+
+    int32 Num() const { return Items.Num(); }
+
+    // Most nodes queued at once since the last Clear
+    int32 GetPeakNum() const { return PeakNum; }
+    bool IsEmpty() const { return Items.Num() == 0; }
+
+    // Bytes used by the heap and its position table
+    SIZE_T GetAllocatedSize() const { return Items.GetAllocatedSize() + Positions.GetAllocatedSize(); }
+
+    // True if the node is currently queued
+    bool Contains(int32 Node) const { return Positions[Node] != INDEX_NONE; }
+
+    // Returns the node with the highest priority without removing it
+    int32 Top() const { return Items[0]; }
+
+    // Adds a node that is not in the heap yet
+    template <typename PredicateType>
+    void Push(int32 Node, const PredicateType& Predicate)
+    {
+        checkSlow(!Contains(Node));
+        Positions[Node] = Items.Add(Node);
+        PeakNum = FMath::Max(PeakNum, Items.Num());
+        SiftUp(Positions[Node], Predicate);
+    }
+
+    // Removes and returns the node with the highest priority
+    template <typename PredicateType>
+    int32 Pop(const PredicateType& Predicate)
+    {
+        const int32 TopNode = Items[0];
+        Positions[TopNode] = INDEX_NONE;
+
+        const int32 LastNode = Items.Pop(false);
+        if (Items.Num() > 0)
+        {
+            // Move the last node into the root and let it sink back into place
+            Items[0] = LastNode;
+            Positions[LastNode] = 0;
+            SiftDown(0, Predicate);
+        }
+        return TopNode;
+    }
+
+    // Restores the heap order after a queued node's key was lowered
+    template <typename PredicateType>
+    void DecreaseKey(int32 Node, const PredicateType& Predicate)
+    {
+        SiftUp(Positions[Node], Predicate);
+    }
+
+    // Restores the heap order after a queued node's key changed in either direction
+    template <typename PredicateType>
+    void Update(int32 Node, const PredicateType& Predicate)
+    {
+        SiftUp(Positions[Node], Predicate);
+        SiftDown(Positions[Node], Predicate);
+    }
+
+    // Removes a queued node from anywhere in the heap
+    template <typename PredicateType>
+    void Remove(int32 Node, const PredicateType& Predicate)
+    {
+        const int32 Position = Positions[Node];
+        Positions[Node] = INDEX_NONE;
+
+        const int32 LastNode = Items.Pop(false);
+        if (Position < Items.Num())
+        {
+            // Fill the hole with the last node, which may need to move either way
+            Items[Position] = LastNode;
+            Positions[LastNode] = Position;
+            Update(LastNode, Predicate);
+        }
+    }
+
+private:
+    template <typename PredicateType>
+    void SiftUp(int32 Position, const PredicateType& Predicate)
+    {
+        const int32 Node = Items[Position];
+        while (Position > 0)
+        {
+            const int32 ParentPosition = (Position - 1) / 2;
+            const int32 Parent = Items[ParentPosition];
+            if (!Predicate(Node, Parent))
+            {
+                break;
+            }
+
+            // Pull the parent down into the hole and keep climbing
+            Items[Position] = Parent;
+            Positions[Parent] = Position;
+            Position = ParentPosition;
+        }
+        Items[Position] = Node;
+        Positions[Node] = Position;
+    }
+
+    template <typename PredicateType>
+    void SiftDown(int32 Position, const PredicateType& Predicate)
+    {
+        const int32 Node = Items[Position];
+        const int32 Count = Items.Num();
+        while (true)
+        {
+            // Pick the better of the two children
+            int32 ChildPosition = Position * 2 + 1;
+            if (ChildPosition >= Count)
+            {
+                break;
+            }
+            if (ChildPosition + 1 < Count && Predicate(Items[ChildPosition + 1], Items[ChildPosition]))
+            {
+                ChildPosition++;
+            }
+            if (!Predicate(Items[ChildPosition], Node))
+            {
+                break;
+            }
+
+            // Pull the child up into the hole and keep sinking
+            Items[Position] = Items[ChildPosition];
+            Positions[Items[Position]] = Position;
+            Position = ChildPosition;
+        }
+        Items[Position] = Node;
+        Positions[Node] = Position;
+    }
+
+    // Node indices in heap order
+    TArray<int32> Items;
+
+    // Heap slot of every node, INDEX_NONE when the node is not queued
+    TArray<int32> Positions;
+
+    int32 PeakNum = 0;
+};
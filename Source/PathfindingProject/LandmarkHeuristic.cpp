@@ -0,0 +1,226 @@
+#include "LandmarkHeuristic.h"
+#include "GridNodeStore.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformTime.h"
+#include <atomic>
+
+void FLandmarkHeuristic::Build(const FGridNodeStore& InNodes, int32 NumLandmarks, int32 MaxWorkers)
+{
+    Reset();
+    Nodes = &InNodes;
+    RequestedLandmarks = FMath::Max(NumLandmarks, 1);
+    const double StartTime = FPlatformTime::Seconds();
+
+    // Farthest-point placement: every landmark goes to the open tile farthest, by path cost, from the landmarks
+    // placed before it. Each pick reads the tables of the earlier landmarks, so these are built one at a time.
+    Landmarks.Reserve(RequestedLandmarks);
+    FromLandmark.Reserve(RequestedLandmarks);
+    while (Landmarks.Num() < RequestedLandmarks)
+    {
+        const int32 Landmark = FindFarthestTile(INDEX_NONE);
+        if (Landmark == INDEX_NONE)
+        {
+            break;
+        }
+        Landmarks.Add(Landmark);
+        FromLandmark.AddDefaulted_GetRef().BuildFromSource(*Nodes, Landmark);
+    }
+
+    // The tables towards the landmarks don't affect the placement and can all be built at once
+    ToLandmark.SetNum(Landmarks.Num());
+    ForEachLandmark(MaxWorkers, [this](int32 Slot)
+    {
+        ToLandmark[Slot].Build(*Nodes, Landmarks[Slot]);
+    });
+
+    BuildSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+void FLandmarkHeuristic::Reset()
+{
+    Nodes = nullptr;
+    RequestedLandmarks = 0;
+    Landmarks.Reset();
+    FromLandmark.Reset();
+    ToLandmark.Reset();
+    BuildSeconds = 0.0;
+}
+
+void FLandmarkHeuristic::NotifyNodeChanged(int32 Index)
+{
+    for (int32 Slot = 0; Slot < Landmarks.Num(); Slot++)
+    {
+        FromLandmark[Slot].NotifyNodeChanged(Index);
+        ToLandmark[Slot].NotifyNodeChanged(Index);
+    }
+}
+
+void FLandmarkHeuristic::NotifyAllChanged()
+{
+    for (int32 Slot = 0; Slot < Landmarks.Num(); Slot++)
+    {
+        FromLandmark[Slot].NotifyAllChanged();
+        ToLandmark[Slot].NotifyAllChanged();
+    }
+}
+
+bool FLandmarkHeuristic::NeedsUpdate() const
+{
+    for (int32 Slot = 0; Slot < Landmarks.Num(); Slot++)
+    {
+        if (FromLandmark[Slot].NeedsUpdate() || ToLandmark[Slot].NeedsUpdate())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FLandmarkHeuristic::Update(int32 MaxWorkers)
+{
+    if (!NeedsUpdate())
+    {
+        return;
+    }
+
+    // The bounds through an obstacle landmark still hold, but nothing can step onto it anymore, so its table
+    // towards it is empty. Moving it to the farthest tile from the other landmarks makes it useful again. The
+    // distances used to pick the spot may be slightly out of date, which only affects how well it is placed.
+    for (int32 Slot = 0; Slot < Landmarks.Num(); Slot++)
+    {
+        if (Nodes->Obstacles[Landmarks[Slot]])
+        {
+            const int32 Replacement = FindFarthestTile(Slot);
+            if (Replacement != INDEX_NONE)
+            {
+                Landmarks[Slot] = Replacement;
+            }
+        }
+    }
+
+    // Moved landmarks get new tables, the others are repaired
+    ForEachLandmark(MaxWorkers, [this](int32 Slot)
+    {
+        if (FromLandmark[Slot].GetGoalIndex() != Landmarks[Slot])
+        {
+            BuildTables(Slot);
+        }
+        else
+        {
+            FromLandmark[Slot].Update();
+            ToLandmark[Slot].Update();
+        }
+    });
+}
+
+SIZE_T FLandmarkHeuristic::GetAllocatedSizePerLandmark() const
+{
+    return Landmarks.Num() > 0 ? GetAllocatedSize() / Landmarks.Num() : 0;
+}
+
+SIZE_T FLandmarkHeuristic::GetAllocatedSize() const
+{
+    SIZE_T Size = Landmarks.GetAllocatedSize() + FromLandmark.GetAllocatedSize() + ToLandmark.GetAllocatedSize();
+    for (int32 Slot = 0; Slot < Landmarks.Num(); Slot++)
+    {
+        Size += FromLandmark[Slot].GetAllocatedSize() + ToLandmark[Slot].GetAllocatedSize();
+    }
+    return Size;
+}
+
+int32 FLandmarkHeuristic::FindFarthestTile(int32 SkipSlot) const
+{
+    if (Nodes->Num() == 0)
+    {
+        return INDEX_NONE;
+    }
+    const int32 NumOthers = Landmarks.Num() - (Landmarks.IsValidIndex(SkipSlot) ? 1 : 0);
+
+    // Without other landmarks to measure against, the spread starts at the tile farthest from the open tile
+    // nearest the middle of the grid. Measuring by path cost keeps it out of walled-off pockets, where a corner
+    // picked by straight-line distance could end up.
+    if (NumOthers == 0)
+    {
+        const FVector Center = (Nodes->Positions[0] + Nodes->Positions.Last()) * 0.5f;
+        int32 Seed = INDEX_NONE;
+        double SeedDistance = TNumericLimits<double>::Max();
+        for (int32 Index = 0; Index < Nodes->Num(); Index++)
+        {
+            const double Distance = FVector::DistSquared(Nodes->Positions[Index], Center);
+            if (!Nodes->Obstacles[Index] && Distance < SeedDistance)
+            {
+                Seed = Index;
+                SeedDistance = Distance;
+            }
+        }
+        if (Seed == INDEX_NONE)
+        {
+            return INDEX_NONE;
+        }
+
+        FFlowField SeedField;
+        SeedField.BuildFromSource(*Nodes, Seed);
+        int32 Farthest = Seed;
+        for (int32 Index = 0; Index < Nodes->Num(); Index++)
+        {
+            const float Distance = SeedField.GetDistance(Index);
+            if (!Nodes->Obstacles[Index] && Distance < UnreachableDistance && Distance > SeedField.GetDistance(Farthest))
+            {
+                Farthest = Index;
+            }
+        }
+        return Farthest;
+    }
+
+    // Tiles no landmark reaches are left out, so walled-off pockets don't take landmarks from the main area
+    int32 Farthest = INDEX_NONE;
+    float FarthestDistance = 0.0f;
+    for (int32 Index = 0; Index < Nodes->Num(); Index++)
+    {
+        if (Nodes->Obstacles[Index])
+        {
+            continue;
+        }
+
+        float NearestDistance = UnreachableDistance;
+        for (int32 Slot = 0; Slot < Landmarks.Num(); Slot++)
+        {
+            if (Slot != SkipSlot)
+            {
+                NearestDistance = FMath::Min(NearestDistance, FromLandmark[Slot].GetDistance(Index));
+            }
+        }
+        if (NearestDistance < UnreachableDistance && NearestDistance > FarthestDistance)
+        {
+            Farthest = Index;
+            FarthestDistance = NearestDistance;
+        }
+    }
+    return Farthest;
+}
+
+void FLandmarkHeuristic::BuildTables(int32 Slot)
+{
+    FromLandmark[Slot].BuildFromSource(*Nodes, Landmarks[Slot]);
+    ToLandmark[Slot].Build(*Nodes, Landmarks[Slot]);
+}
+
+void FLandmarkHeuristic::ForEachLandmark(int32 MaxWorkers, TFunctionRef<void(int32)> Function)
+{
+    if (MaxWorkers <= 0)
+    {
+        MaxWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+    }
+    const int32 NumWorkers = FMath::Min(MaxWorkers, Landmarks.Num());
+
+    // Every table only writes its own arrays, so landmarks are processed independently
+    std::atomic<int32> NextSlot(0);
+    ParallelFor(NumWorkers, [this, &Function, &NextSlot](int32 WorkerIndex)
+    {
+        for (int32 Slot = NextSlot++; Slot < Landmarks.Num(); Slot = NextSlot++)
+        {
+            Function(Slot);
+        }
+    });
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FlowField.h"
+
+struct FGridNodeStore;
+
+/*
+ * ALT heuristic (A*, Landmarks, Triangle inequality) for FGridNodeStore::FindPath.
+ * A few landmark tiles are spread over the grid, and the cost from each landmark to every tile and from every
+ * tile back to it is computed once. For any landmark L, the triangle inequality bounds the remaining cost from
+ * a tile N to the goal G from below by d(L,G) - d(L,N) and by d(N,L) - d(G,L). On weighted maps and mazes the
+ * best of these bounds is far closer to the real cost than the straight-line distance, so A* expands fewer tiles
+ * and still finds the cheapest path.
+ *
+ * Each table is a flow field, so tile edits are queued and the tables repaired on the next Update rather than
+ * recomputed. A landmark that turned into an obstacle is replaced then too.
+ */
+class PATHFINDINGPROJECT_API FLandmarkHeuristic
+{
+public:
+    // Places up to NumLandmarks landmarks and computes their tables. The store has to stay alive until the
+    // heuristic is reset. MaxWorkers limits the threads used; zero uses all of them.
+    void Build(const FGridNodeStore& InNodes, int32 NumLandmarks, int32 MaxWorkers = 0);
+
+    // Drops the tables, for example because the grid was regenerated
+    void Reset();
+
+    // Whether Build has run since the last reset
+    bool IsBuilt() const { return Nodes != nullptr; }
+
+    // Landmarks asked for by the last Build. Fewer are placed when the grid has fewer open tiles.
+    int32 GetRequestedLandmarks() const { return RequestedLandmarks; }
+
+    // Node index of each landmark
+    const TArray<int32>& GetLandmarks() const { return Landmarks; }
+
+    // Queues a tile whose weight or obstacle state changed. The tables are not repaired until Update.
+    void NotifyNodeChanged(int32 Index);
+
+    // Queues a rebuild of every table, for edits that touch most of the grid
+    void NotifyAllChanged();
+
+    // Whether edits are waiting for Update
+    bool NeedsUpdate() const;
+
+    // Repairs the tables after the queued edits, and moves landmarks that were turned into obstacles
+    void Update(int32 MaxWorkers = 0);
+
+    // Lower bound on the cost of the cheapest path from Index to GoalIndex. Zero when no landmark can tell.
+    float GetLowerBound(int32 Index, int32 GoalIndex) const
+    {
+        float Bound = 0.0f;
+        for (int32 i = 0; i < Landmarks.Num(); i++)
+        {
+            // Tables hold the max float where there is no path, and those say nothing about the distance
+            const float FromLandmarkToGoal = FromLandmark[i].GetDistance(GoalIndex);
+            const float FromLandmarkToNode = FromLandmark[i].GetDistance(Index);
+            if (FromLandmarkToGoal < UnreachableDistance && FromLandmarkToNode < UnreachableDistance)
+            {
+                Bound = FMath::Max(Bound, FromLandmarkToGoal - FromLandmarkToNode);
+            }
+
+            const float FromNodeToLandmark = ToLandmark[i].GetDistance(Index);
+            const float FromGoalToLandmark = ToLandmark[i].GetDistance(GoalIndex);
+            if (FromNodeToLandmark < UnreachableDistance && FromGoalToLandmark < UnreachableDistance)
+            {
+                Bound = FMath::Max(Bound, FromNodeToLandmark - FromGoalToLandmark);
+            }
+        }
+        return Bound;
+    }
+
+    // Bytes used by the tables of one landmark, and by all of them
+    SIZE_T GetAllocatedSizePerLandmark() const;
+    SIZE_T GetAllocatedSize() const;
+
+    // Time the last Build took, in seconds
+    double BuildSeconds = 0.0;
+
+private:
+    static constexpr float UnreachableDistance = TNumericLimits<float>::Max();
+
+    // Open tile whose cost from the nearest existing landmark is highest, skipping landmark SkipSlot. INDEX_NONE if none is left.
+    int32 FindFarthestTile(int32 SkipSlot) const;
+
+    // Builds both tables of landmark slot Slot around its current tile
+    void BuildTables(int32 Slot);
+
+    // Runs Function(Slot) for every landmark, spread over MaxWorkers threads
+    void ForEachLandmark(int32 MaxWorkers, TFunctionRef<void(int32)> Function);
+
+    const FGridNodeStore* Nodes = nullptr;
+    int32 RequestedLandmarks = 0;
+
+    TArray<int32> Landmarks;
+
+    // Cost from each landmark to every tile, and from every tile to each landmark, by landmark slot
+    TArray<FFlowField> FromLandmark;
+    TArray<FFlowField> ToLandmark;
+};
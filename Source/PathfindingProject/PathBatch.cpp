@@ -0,0 +1,70 @@
+#include "PathBatch.h"
+#include "GridNodeStore.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include <atomic>
+
+void FPathBatchSearcher::Run(const FGridNodeStore& Nodes, TArrayView<FPathRequest> Requests, TArray<int32>& OutPaths, int32 MaxWorkers)
+{
+    OutPaths.Reset();
+    if (Requests.Num() == 0)
+    {
+        return;
+    }
+
+    // One worker per thread that can run the batch (the task graph workers plus the calling thread), and never more than there are requests
+    if (MaxWorkers <= 0)
+    {
+        MaxWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+    }
+    const int32 NumWorkers = FMath::Min(MaxWorkers, Requests.Num());
+    while (Workers.Num() < NumWorkers)
+    {
+        Workers.Add(MakeUnique<FWorker>());
+    }
+    RequestWorkers.SetNumUninitialized(Requests.Num(), false);
+
+    // Workers pull the next unsolved request until none are left, so long and short queries even out
+    std::atomic<int32> NextRequest(0);
+    ParallelFor(NumWorkers, [this, &Nodes, &Requests, &NextRequest](int32 WorkerIndex)
+    {
+        FWorker& Worker = *Workers[WorkerIndex];
+        Worker.Paths.Reset();
+
+        for (int32 RequestIndex = NextRequest++; RequestIndex < Requests.Num(); RequestIndex = NextRequest++)
+        {
+            FPathRequest& Request = Requests[RequestIndex];
+            RequestWorkers[RequestIndex] = WorkerIndex;
+
+            // Until the batch is packed, the offset points into this worker's own buffer
+            Request.PathOffset = Worker.Paths.Num();
+            Request.PathLength = 0;
+            if (Nodes.FindPath(Request.StartIndex, Request.GoalIndex, Worker.Context, Worker.Path))
+            {
+                Worker.Paths.Append(Worker.Path);
+                Request.PathLength = Worker.Path.Num();
+            }
+        }
+    }, NumWorkers == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::Unbalanced);
+
+    // Pack the paths in request order into the output buffer
+    int32 TotalLength = 0;
+    for (const FPathRequest& Request : Requests)
+    {
+        TotalLength += Request.PathLength;
+    }
+    OutPaths.SetNumUninitialized(TotalLength, false);
+
+    int32 WriteOffset = 0;
+    for (int32 RequestIndex = 0; RequestIndex < Requests.Num(); RequestIndex++)
+    {
+        FPathRequest& Request = Requests[RequestIndex];
+        if (Request.PathLength > 0)
+        {
+            const TArray<int32>& WorkerPaths = Workers[RequestWorkers[RequestIndex]]->Paths;
+            FMemory::Memcpy(OutPaths.GetData() + WriteOffset, WorkerPaths.GetData() + Request.PathOffset, Request.PathLength * sizeof(int32));
+        }
+        Request.PathOffset = WriteOffset;
+        WriteOffset += Request.PathLength;
+    }
+}
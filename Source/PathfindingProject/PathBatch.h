@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathSearchContext.h"
+
+struct FGridNodeStore;
+
+// One query of a batch, and where its path ended up in the batch's output buffer
+struct FPathRequest
+{
+    int32 StartIndex = INDEX_NONE;
+    int32 GoalIndex = INDEX_NONE;
+
+    // Filled in by the batch: the path is PathLength node indices of the output buffer starting at PathOffset,
+    // start node first. PathLength is zero when the goal cannot be reached.
+    int32 PathOffset = 0;
+    int32 PathLength = 0;
+};
+
+/*
+ * Solves many independent path queries at once. Queries are handed out to parallel workers, each with its
+ * own search context and path storage, and the node store is only read. Workers and their buffers are kept
+ * between batches, so a batch of the same size as the previous one does not allocate.
+ */
+class PATHFINDINGPROJECT_API FPathBatchSearcher
+{
+public:
+    /* Solves every request and packs all paths back to back into OutPaths. MaxWorkers limits how many
+       workers run in parallel; zero uses one per task graph thread. Returns once the whole batch is done. */
+    void Run(const FGridNodeStore& Nodes, TArrayView<FPathRequest> Requests, TArray<int32>& OutPaths, int32 MaxWorkers = 0);
+
+private:
+    struct FWorker
+    {
+        FPathSearchContext Context;
+
+        // Path of the query currently being solved
+        TArray<int32> Path;
+
+        // Every path this worker found during the batch, back to back
+        TArray<int32> Paths;
+    };
+
+    TArray<TUniquePtr<FWorker>> Workers;
+
+    // Worker that solved each request of the current batch
+    TArray<int32> RequestWorkers;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+// Result of a path query that ran off the game thread
+struct FPathQueryResult
+{
+    int32 StartIndex = INDEX_NONE;
+    int32 GoalIndex = INDEX_NONE;
+
+    // Grid version of the snapshot the query searched
+    uint32 GridVersion = 0;
+
+    bool bFoundPath = false;
+
+    // Node indices from start to goal, empty if the goal cannot be reached
+    TArray<int32> Path;
+
+    // Time the search took on the worker, zero if the result came from the cache
+    double SearchSeconds = 0.0;
+
+    // Position of the query in the workload the grid was recording when it was requested, INDEX_NONE if none
+    int32 WorkloadEvent = INDEX_NONE;
+};
+
+// Called on the game thread once an asynchronous query has finished and was not cancelled
+typedef TFunction<void(const FPathQueryResult& Result)> FOnPathQueryComplete;
+
+/*
+ * Returned by AGrid::FindPathAsync. Cancelling stops the search at its next poll and guarantees that the
+ * completion callback is not called, which is how a query that has been superseded by a newer one is dropped.
+ */
+struct FPathQueryHandle
+{
+    FPathQueryHandle() = default;
+    explicit FPathQueryHandle(const TSharedRef<std::atomic<bool>>& InCancelFlag) : CancelFlag(InCancelFlag) {}
+
+    // Whether the handle refers to a query
+    bool IsValid() const { return CancelFlag.IsValid(); }
+
+    // Asks the query to stop. Safe to call on an empty handle or a query that already finished.
+    void Cancel()
+    {
+        if (CancelFlag.IsValid())
+        {
+            CancelFlag->store(true);
+        }
+    }
+
+    bool IsCancelled() const { return CancelFlag.IsValid() && CancelFlag->load(); }
+
+private:
+    TSharedPtr<std::atomic<bool>> CancelFlag;
+};
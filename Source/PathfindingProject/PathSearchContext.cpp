@@ -0,0 +1,98 @@
+#include "PathSearchContext.h"
+#include "Misc/ScopeLock.h"
+#include "PathfindingStats.h"
+
+void FPathSearchContext::Reserve(int32 NumNodes)
+{
+    if (NodeStates.Num() < NumNodes)
+    {
+        // New states start at generation zero, which no query uses
+        FNodeState StaleState;
+        StaleState.GCost = TNumericLimits<float>::Max();
+        StaleState.HCost = TNumericLimits<float>::Max();
+        StaleState.Parent = INDEX_NONE;
+        StaleState.Generation = 0;
+        StaleState.bClosed = false;
+        StaleState.Direction = 0;
+        StaleState.bExpandAll = false;
+
+        NodeStates.Reserve(NumNodes);
+        while (NodeStates.Num() < NumNodes)
+        {
+            NodeStates.Add(StaleState);
+        }
+        NumContextGrowths++;
+    }
+
+    // The open set can never hold more than every node at once
+    if (OpenSet.Reserve(NumNodes))
+    {
+        NumContextGrowths++;
+    }
+}
+
+void FPathSearchContext::BeginQuery(int32 NumNodes)
+{
+    SCOPE_CYCLE_COUNTER(STAT_PathfindingReset);
+    Reserve(NumNodes);
+    OpenSet.Clear();
+    NumExpanded = 0;
+
+    Generation++;
+    if (Generation == 0)
+    {
+        // The counter wrapped around, so old stamps could collide with new ones. This happens once every 4 billion queries.
+        for (FNodeState& State : NodeStates)
+        {
+            State.Generation = 0;
+        }
+        Generation = 1;
+    }
+}
+
+void FPathSearchContext::BuildPath(int32 GoalNode, TArray<int32>& OutPath)
+{
+    SCOPE_CYCLE_COUNTER(STAT_PathfindingReconstruction);
+
+    // Count the nodes first so the path can be written back to front in a single pass
+    int32 PathLength = 0;
+    for (int32 PathNode = GoalNode; PathNode != INDEX_NONE; PathNode = NodeStates[PathNode].Parent)
+    {
+        PathLength++;
+    }
+
+    if (OutPath.Max() < PathLength)
+    {
+        NumContextGrowths++;
+    }
+    OutPath.SetNumUninitialized(PathLength, false);
+
+    int32 WriteIndex = PathLength - 1;
+    for (int32 PathNode = GoalNode; PathNode != INDEX_NONE; PathNode = NodeStates[PathNode].Parent)
+    {
+        OutPath[WriteIndex--] = PathNode;
+    }
+}
+
+TUniquePtr<FPathSearchContext> FPathSearchContextPool::Acquire()
+{
+    {
+        FScopeLock ScopeLock(&Lock);
+        if (FreeContexts.Num() > 0)
+        {
+            return FreeContexts.Pop(false);
+        }
+    }
+    return MakeUnique<FPathSearchContext>();
+}
+
+void FPathSearchContextPool::Release(TUniquePtr<FPathSearchContext> Context)
+{
+    if (Context)
+    {
+        Context->CancelFlag = nullptr;
+
+        FScopeLock ScopeLock(&Lock);
+        FreeContexts.Add(MoveTemp(Context));
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "IndexedNodeHeap.h"
+#include <atomic>
+
+/*
+ * Scratch state for A* queries that callers keep and reuse between searches.
+ * Every node's state is stamped with the generation of the query that last touched it, so state left over
+ * from an earlier query reads as unvisited and nothing has to be cleared before a search. Once the buffers
+ * have grown to the size of the grid, a query on the context does not allocate.
+ */
+struct PATHFINDINGPROJECT_API FPathSearchContext
+{
+    // Search state of one node
+    struct FNodeState
+    {
+        // Fixed-point searches keep their integer costs in the same place as the float ones
+        union
+        {
+            float GCost; // Movement cost from the start node
+            uint32 FixedGCost;
+        };
+        union
+        {
+            float HCost; // Estimated cost to the goal node
+            uint32 FixedHCost;
+        };
+        int32 Parent; // Node we arrived from, for path reconstruction
+        uint32 Generation; // Query that last initialized this state
+        bool bClosed; // Whether the lowest cost to this node is final
+        uint8 Direction; // Jump point search only: direction of the straight run that reached this node
+        bool bExpandAll; // Jump point search only: whether to search in every direction from this node
+
+        float FCost() const { return GCost + HCost; }
+    };
+
+    // Grows the scratch buffers to hold a graph with NumNodes nodes
+    void Reserve(int32 NumNodes);
+
+    // Starts a new query over a graph with NumNodes nodes. Node state from previous queries becomes stale.
+    void BeginQuery(int32 NumNodes);
+
+    // Whether the node has been reached during the current query
+    bool IsVisited(int32 Node) const { return NodeStates[Node].Generation == Generation; }
+
+    // Returns the node's state for the current query, resetting it first if an earlier query left it behind
+    FNodeState& GetNode(int32 Node)
+    {
+        FNodeState& State = NodeStates[Node];
+        if (State.Generation != Generation)
+        {
+            State.GCost = TNumericLimits<float>::Max();
+            State.HCost = TNumericLimits<float>::Max();
+            State.Parent = INDEX_NONE;
+            State.Generation = Generation;
+            State.bClosed = false;
+            State.Direction = 0;
+            State.bExpandAll = false;
+        }
+        return State;
+    }
+
+    // Orders the open set by lowest FCost, and if there is a tie, by lowest HCost. Both nodes must be visited.
+    bool IsBetterNode(int32 A, int32 B) const
+    {
+        const FNodeState& StateA = NodeStates[A];
+        const FNodeState& StateB = NodeStates[B];
+        if (FMath::IsNearlyEqual(StateA.FCost(), StateB.FCost()))
+        {
+            return StateA.HCost < StateB.HCost;
+        }
+        return StateA.FCost() < StateB.FCost();
+    }
+
+    // Writes the path ending at GoalNode into OutPath, start first, following the parents of the current query
+    void BuildPath(int32 GoalNode, TArray<int32>& OutPath);
+
+    // Number of times the context grew its own buffers or the path buffer passed to BuildPath. Only what the
+    // context sees itself: use FScopedAllocationCounter to count every allocation a query makes.
+    int32 GetNumContextGrowths() const { return NumContextGrowths; }
+
+    // Whether the query's owner asked for it to stop early
+    bool IsCancelled() const { return CancelFlag && CancelFlag->load(std::memory_order_relaxed); }
+
+    // Nodes waiting to be expanded, best node on top
+    FIndexedNodeHeap OpenSet;
+
+    // Number of nodes expanded by the last query
+    int32 NumExpanded = 0;
+
+    // Optional flag polled during the search. When it turns true the search gives up and reports no path.
+    const std::atomic<bool>* CancelFlag = nullptr;
+
+private:
+    TArray<FNodeState> NodeStates;
+
+    // Stamp of the current query. Zero is never used, so freshly added states always read as stale.
+    uint32 Generation = 0;
+
+    int32 NumContextGrowths = 0;
+};
+
+/*
+ * Keeps warm search contexts for queries that run on worker threads. A query takes a context for the
+ * duration of one search and gives it back, so contexts are only allocated when more queries run at
+ * once than ever before.
+ */
+class PATHFINDINGPROJECT_API FPathSearchContextPool
+{
+public:
+    // Takes a free context, or creates one if every context is in use
+    TUniquePtr<FPathSearchContext> Acquire();
+
+    // Returns a context to the pool
+    void Release(TUniquePtr<FPathSearchContext> Context);
+
+private:
+    FCriticalSection Lock;
+    TArray<TUniquePtr<FPathSearchContext>> FreeContexts;
+};
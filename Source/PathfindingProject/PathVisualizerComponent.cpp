@@ -0,0 +1,159 @@
+#include "PathVisualizerComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "UObject/ConstructorHelpers.h"
+#include "PathfindingStats.h"
+
+UPathVisualizerComponent::UPathVisualizerComponent()
+{
+    // Rebuild after everything that could set a path this frame has ticked
+    PrimaryComponentTick.bCanEverTick = true;
+    PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+    HeightOffset = 50.0f;
+    LineThickness = 5.0f;
+
+    // Green, like the debug lines the paths used to be drawn with
+    PathColor = FLinearColor::Green;
+    SegmentMaterial = nullptr;
+    FallbackMaterialInstance = nullptr;
+    NumCustomDataFloats = 3;
+
+    SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    SetCastShadow(false);
+
+    // The engine's 100 unit cube, stretched along each step
+    static ConstructorHelpers::FObjectFinder<UStaticMesh> SegmentMesh(TEXT("/Engine/BasicShapes/Cube.Cube"));
+    if (SegmentMesh.Succeeded())
+    {
+        SetStaticMesh(SegmentMesh.Object);
+    }
+
+    // The engine ships no material that reads custom data, so the fallback tints its own instance of this one instead
+    static ConstructorHelpers::FObjectFinder<UMaterialInterface> BasicShapeMaterial(TEXT("/Engine/BasicShapes/BasicShapeMaterial.BasicShapeMaterial"));
+    FallbackMaterial = BasicShapeMaterial.Object;
+}
+
+void UPathVisualizerComponent::OnRegister()
+{
+    Super::OnRegister();
+
+    // Editing a property re-registers the component, so a new material shows up right away and the instances are
+    // given the new color on the next rebuild
+    ApplyMaterial();
+    if (GetInstanceCount() > 0)
+    {
+        bPathsChanged = true;
+    }
+}
+
+void UPathVisualizerComponent::ApplyMaterial()
+{
+    if (SegmentMaterial)
+    {
+        SetMaterial(0, SegmentMaterial);
+        return;
+    }
+    if (!FallbackMaterial)
+    {
+        return;
+    }
+    if (!FallbackMaterialInstance)
+    {
+        FallbackMaterialInstance = UMaterialInstanceDynamic::Create(FallbackMaterial, this);
+    }
+    FallbackMaterialInstance->SetVectorParameterValue(TEXT("Color"), PathColor);
+    SetMaterial(0, FallbackMaterialInstance);
+}
+
+void UPathVisualizerComponent::SetPath(int32 PathId, TArrayView<const FVector> Points)
+{
+    TArray<FVector>& Path = Paths.FindOrAdd(PathId);
+    if (Path.Num() == Points.Num() && FMemory::Memcmp(Path.GetData(), Points.GetData(), Points.Num() * sizeof(FVector)) == 0)
+    {
+        return;
+    }
+    Path.Reset();
+    Path.Append(Points.GetData(), Points.Num());
+    bPathsChanged = true;
+}
+
+void UPathVisualizerComponent::ClearPath(int32 PathId)
+{
+    if (Paths.Remove(PathId) > 0)
+    {
+        bPathsChanged = true;
+    }
+}
+
+void UPathVisualizerComponent::ClearAllPaths()
+{
+    if (Paths.Num() > 0)
+    {
+        Paths.Reset();
+        bPathsChanged = true;
+    }
+}
+
+void UPathVisualizerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+    if (bPathsChanged)
+    {
+        RebuildInstances();
+        bPathsChanged = false;
+    }
+}
+
+void UPathVisualizerComponent::RebuildInstances()
+{
+    SCOPE_CYCLE_COUNTER(STAT_PathfindingDraw);
+
+    // The segment mesh is a cube 100 units on a side, so a step of length L is the cube scaled by L / 100 along X
+    const FVector Offset(0.0f, 0.0f, HeightOffset);
+    const float ThicknessScale = LineThickness / 100.0f;
+    const FTransform& ComponentToWorld = GetComponentTransform();
+    SegmentTransforms.Reset();
+    for (const TPair<int32, TArray<FVector>>& Path : Paths)
+    {
+        for (int32 Index = 1; Index < Path.Value.Num(); Index++)
+        {
+            const FVector From = Path.Value[Index - 1] + Offset;
+            const FVector To = Path.Value[Index] + Offset;
+            const FVector Step = To - From;
+            const FTransform WorldTransform(Step.Rotation(), (From + To) * 0.5f, FVector(Step.Size() / 100.0f, ThicknessScale, ThicknessScale));
+            SegmentTransforms.Add(WorldTransform.GetRelativeTransform(ComponentToWorld));
+        }
+    }
+
+    // Move the instances that are already there, then add or drop instances only at the end
+    const int32 NumExisting = GetInstanceCount();
+    const int32 NumReused = FMath::Min(NumExisting, SegmentTransforms.Num());
+    for (int32 Index = 0; Index < NumReused; Index++)
+    {
+        UpdateInstanceTransform(Index, SegmentTransforms[Index], false, false, true);
+    }
+    if (NumExisting > SegmentTransforms.Num())
+    {
+        RemovedInstances.Reset();
+        for (int32 Index = SegmentTransforms.Num(); Index < NumExisting; Index++)
+        {
+            RemovedInstances.Add(Index);
+        }
+        RemoveInstances(RemovedInstances);
+    }
+    if (SegmentTransforms.Num() > NumExisting)
+    {
+        AddedTransforms.Reset();
+        AddedTransforms.Append(SegmentTransforms.GetData() + NumExisting, SegmentTransforms.Num() - NumExisting);
+        AddInstances(AddedTransforms, false);
+    }
+
+    // Every instance gets the color again, since it may have changed since the reused ones were added
+    const float Color[] = { PathColor.R, PathColor.G, PathColor.B };
+    for (int32 Index = 0; Index < SegmentTransforms.Num(); Index++)
+    {
+        SetCustomData(Index, Color, false);
+    }
+    MarkRenderStateDirty();
+}
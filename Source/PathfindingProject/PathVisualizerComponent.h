@@ -0,0 +1,84 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "PathVisualizerComponent.generated.h"
+
+class UMaterialInterface;
+class UMaterialInstanceDynamic;
+
+/*
+ * Draws any number of paths as stretched instances of one segment mesh, one instance per step. Paths are
+ * keyed by an id chosen by the caller, such as one per agent. Setting a path only records it; the instances are
+ * rebuilt once at the end of the frame, and only if some path actually changed. A rebuild moves the existing
+ * instances into place and only adds or removes instances at the end, so the instance buffers are reused
+ * between updates. Works in every build configuration, unlike debug lines.
+ *
+ * Like the grid's tiles, each instance carries its color as custom data (red, green and blue in 0-2), for a
+ * segment material that reads it.
+ */
+UCLASS(ClassGroup = (Pathfinding), meta = (BlueprintSpawnableComponent))
+class PATHFINDINGPROJECT_API UPathVisualizerComponent : public UInstancedStaticMeshComponent
+{
+    GENERATED_BODY()
+
+public:
+    UPathVisualizerComponent();
+
+    // Shows the path through Points, in world space, under PathId. A path equal to the one shown is ignored.
+    void SetPath(int32 PathId, TArrayView<const FVector> Points);
+
+    // Stops showing the path with the given id
+    UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+    void ClearPath(int32 PathId);
+
+    // Stops showing every path
+    UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+    void ClearAllPaths();
+
+    // Height of the segments above the points they connect
+    UPROPERTY(EditAnywhere, Category = "Pathfinding")
+    float HeightOffset;
+
+    // Width and height of each segment
+    UPROPERTY(EditAnywhere, Category = "Pathfinding", meta = (ClampMin = "0"))
+    float LineThickness;
+
+    // Color of the segments, written to the custom data of every instance
+    UPROPERTY(EditAnywhere, Category = "Pathfinding")
+    FLinearColor PathColor;
+
+    // Unlit material that takes its color from custom data 0-2. Without it the segments use the engine's basic shape
+    // material tinted with PathColor.
+    UPROPERTY(EditAnywhere, Category = "Pathfinding")
+    UMaterialInterface* SegmentMaterial;
+
+    virtual void OnRegister() override;
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+    // Turns every path into segment instances, reusing the instances already there
+    void RebuildInstances();
+
+    // Sets SegmentMaterial on the segments, or the tinted fallback if there is none
+    void ApplyMaterial();
+
+    UPROPERTY()
+    UMaterialInterface* FallbackMaterial;
+
+    UPROPERTY(Transient)
+    UMaterialInstanceDynamic* FallbackMaterialInstance;
+
+    // Points of every path shown, by id
+    TMap<int32, TArray<FVector>> Paths;
+
+    // Segment transforms of all paths, kept between rebuilds so they do not allocate
+    TArray<FTransform> SegmentTransforms;
+
+    // Instances dropped and added at the end by a rebuild, kept for the same reason
+    TArray<int32> RemovedInstances;
+    TArray<FTransform> AddedTransforms;
+
+    // Whether a path changed since the last rebuild
+    bool bPathsChanged = false;
+};
@@ -0,0 +1,317 @@
+#include "PathWorkload.h"
+#include "Grid.h"
+#include "GridNodeStore.h"
+#include "PathSearchContext.h"
+#include "IncrementalPathPlanner.h"
+#include "HierarchicalPathfinder.h"
+#include "LandmarkHeuristic.h"
+#include "CompressedPathDatabase.h"
+#include "HAL/PlatformTime.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// Identifies a saved workload, and the layout it was saved with
+static constexpr uint32 BlobMagic = 0x4C575046; // "FPWL"
+static constexpr uint32 BlobVersion = 1;
+
+// Reads or writes one event in a few bytes: the time as microseconds since the previous event and the tiles as
+// packed integers. Gaps longer than about an hour are shortened to that, which a replay does not notice.
+static void SerializeEvent(FArchive& Ar, FPathWorkload::FEvent& Event, double& PreviousTime)
+{
+    uint8 Type = (uint8)Event.Type;
+    uint32 DeltaMicros = (uint32)FMath::Clamp((Event.Time - PreviousTime) * 1.e6, 0.0, (double)MAX_uint32);
+    uint32 Index = (uint32)Event.Index;
+    uint32 Value = (uint32)Event.Value;
+
+    Ar << Type;
+    Ar.SerializeIntPacked(DeltaMicros);
+    Ar.SerializeIntPacked(Index);
+    Ar.SerializeIntPacked(Value);
+    if (Type == (uint8)FPathWorkload::EEventType::Query)
+    {
+        Ar << Event.Mode << Event.Flags << Event.LiveMicros;
+    }
+
+    if (Ar.IsLoading())
+    {
+        Event.Type = (FPathWorkload::EEventType)Type;
+        Event.Time = PreviousTime + DeltaMicros * 1.e-6;
+        Event.Index = (int32)Index;
+        Event.Value = (int32)Value;
+    }
+    PreviousTime = Event.Time;
+}
+
+// Path cost the way the searches charge it, for comparing the results of different modes
+static double GetPathCost(const FGridNodeStore& Nodes, const TArray<int32>& Path)
+{
+    double Cost = 0.0;
+    for (int32 i = 1; i < Path.Num(); i++)
+    {
+        Cost += FVector::Dist(Nodes.Positions[Path[i - 1]], Nodes.Positions[Path[i]]) * Nodes.Weights[Path[i]];
+    }
+    return Cost;
+}
+
+FPathWorkload::FPathWorkload()
+{
+    StartTime = FPlatformTime::Seconds();
+}
+
+void FPathWorkload::AddSnapshot(const FGridNodeStore& Nodes, int32 Seed)
+{
+    FSnapshot& Snapshot = Snapshots.AddDefaulted_GetRef();
+    Snapshot.GridCount = Nodes.GetGridCount();
+    Snapshot.Seed = Seed;
+    Snapshot.Weights = Nodes.Weights;
+    Snapshot.Obstacles.Init(false, Nodes.Num());
+    for (int32 Index = 0; Index < Nodes.Num(); Index++)
+    {
+        Snapshot.Obstacles[Index] = Nodes.Obstacles[Index];
+    }
+
+    FEvent& Event = Events.AddDefaulted_GetRef();
+    Event.Type = EEventType::Snapshot;
+    Event.Time = FPlatformTime::Seconds() - StartTime;
+    Event.Index = Snapshots.Num() - 1;
+    Event.Value = 0;
+}
+
+void FPathWorkload::AddObstacleEdit(int32 Index, bool bObstacle)
+{
+    FEvent& Event = Events.AddDefaulted_GetRef();
+    Event.Type = EEventType::SetObstacle;
+    Event.Time = FPlatformTime::Seconds() - StartTime;
+    Event.Index = Index;
+    Event.Value = bObstacle ? 1 : 0;
+}
+
+int32 FPathWorkload::AddQuery(int32 StartIndex, int32 GoalIndex, EPathSearchMode Mode, uint8 Flags, float LiveMicros)
+{
+    FEvent& Event = Events.AddDefaulted_GetRef();
+    Event.Type = EEventType::Query;
+    Event.Time = FPlatformTime::Seconds() - StartTime;
+    Event.Index = StartIndex;
+    Event.Value = GoalIndex;
+    Event.Mode = (uint8)Mode;
+    Event.Flags = Flags;
+    Event.LiveMicros = LiveMicros;
+    NumQueries++;
+    return Events.Num() - 1;
+}
+
+void FPathWorkload::SetQueryResult(int32 EventIndex, bool bFoundPath, float LiveMicros)
+{
+    if (Events.IsValidIndex(EventIndex) && Events[EventIndex].Type == EEventType::Query)
+    {
+        FEvent& Event = Events[EventIndex];
+        Event.Flags = bFoundPath ? (uint8)(Event.Flags | Found) : (uint8)(Event.Flags & ~Found);
+        Event.LiveMicros = LiveMicros;
+    }
+}
+
+void FPathWorkload::Replay(EPathSearchMode Mode, TArray<FReplayedQuery>& OutQueries, int32 HierarchicalClusterSize, int32 NumLandmarks) const
+{
+    OutQueries.Reset(NumQueries);
+
+    // The same search state AGrid keeps, built up and repaired the same way
+    FGridNodeStore Nodes;
+    FPathSearchContext Context;
+    FPathSearchContext ReverseContext;
+    FIncrementalPathPlanner IncrementalPlanner;
+    FHierarchicalPathfinder HierarchicalPathfinder;
+    FLandmarkHeuristic LandmarkHeuristic;
+    FCompressedPathDatabase PathDatabase;
+    TArray<int32> Path;
+
+    // Recorded time at which the path database being rebuilt would be ready
+    double PathDatabaseReadyTime = 0.0;
+
+    for (int32 EventIndex = 0; EventIndex < Events.Num(); EventIndex++)
+    {
+        const FEvent& Event = Events[EventIndex];
+        switch (Event.Type)
+        {
+        case EEventType::Snapshot:
+        {
+            const FSnapshot& Snapshot = Snapshots[Event.Index];
+            Nodes.Build(Snapshot.GridCount, Snapshot.Seed);
+            for (int32 Index = 0; Index < Nodes.Num(); Index++)
+            {
+                Nodes.Weights[Index] = Snapshot.Weights[Index];
+                Nodes.Obstacles[Index] = Snapshot.Obstacles[Index];
+            }
+            Nodes.UpdateStepCosts();
+            Context.Reserve(Nodes.Num());
+            IncrementalPlanner.Reset();
+            HierarchicalPathfinder.Reset();
+            LandmarkHeuristic.Reset();
+            PathDatabase.Reset();
+            break;
+        }
+
+        case EEventType::SetObstacle:
+            if (Nodes.IsValidIndex(Event.Index))
+            {
+                Nodes.Obstacles[Event.Index] = Event.Value != 0;
+                IncrementalPlanner.NotifyNodeChanged(Event.Index);
+                HierarchicalPathfinder.NotifyNodeChanged(Event.Index);
+                LandmarkHeuristic.NotifyNodeChanged(Event.Index);
+                PathDatabase.Reset();
+            }
+            break;
+
+        case EEventType::Query:
+        {
+            FReplayedQuery& Replayed = OutQueries.AddDefaulted_GetRef();
+            Replayed.EventIndex = EventIndex;
+            const int32 StartIndex = Event.Index;
+            const int32 GoalIndex = Event.Value;
+            if (!Nodes.IsValidIndex(StartIndex) || !Nodes.IsValidIndex(GoalIndex))
+            {
+                break;
+            }
+
+            // The live grid rebuilds the path database in the background after an edit. Here it is built right away,
+            // timed apart from the query, and only answers queries recorded after it would have finished.
+            if (Mode == EPathSearchMode::PathDatabase && !PathDatabase.IsBuilt())
+            {
+                const double BuildStartTime = FPlatformTime::Seconds();
+                PathDatabase.Build(Nodes);
+                const double BuildSeconds = FPlatformTime::Seconds() - BuildStartTime;
+                Replayed.RebuildMicros = BuildSeconds * 1.e6;
+                PathDatabaseReadyTime = Event.Time + BuildSeconds;
+            }
+
+            const double QueryStartTime = FPlatformTime::Seconds();
+            switch (Mode)
+            {
+            case EPathSearchMode::Incremental:
+                if (!IncrementalPlanner.IsPlanning(StartIndex, GoalIndex))
+                {
+                    IncrementalPlanner.Initialize(Nodes, StartIndex, GoalIndex);
+                }
+                Replayed.bFoundPath = IncrementalPlanner.FindPath(Path);
+                break;
+            case EPathSearchMode::Hierarchical:
+                if (!HierarchicalPathfinder.IsBuilt())
+                {
+                    HierarchicalPathfinder.Build(Nodes, FMath::Max(HierarchicalClusterSize, 2));
+                }
+                Replayed.bFoundPath = HierarchicalPathfinder.FindPath(StartIndex, GoalIndex, Path);
+                break;
+            case EPathSearchMode::JumpPoint:
+                Replayed.bFoundPath = Nodes.FindPathJumpPoint(StartIndex, GoalIndex, Context, Path);
+                break;
+            case EPathSearchMode::Bidirectional:
+                Replayed.bFoundPath = Nodes.FindPathBidirectional(StartIndex, GoalIndex, Context, ReverseContext, Path);
+                break;
+            case EPathSearchMode::FixedPoint:
+                Replayed.bFoundPath = Nodes.FindPathFixedPoint(StartIndex, GoalIndex, Context, Path);
+                break;
+            case EPathSearchMode::Landmarks:
+                if (!LandmarkHeuristic.IsBuilt())
+                {
+                    LandmarkHeuristic.Build(Nodes, FMath::Max(NumLandmarks, 1));
+                }
+                else
+                {
+                    LandmarkHeuristic.Update();
+                }
+                Replayed.bFoundPath = Nodes.FindPath(StartIndex, GoalIndex, Context, Path, &LandmarkHeuristic);
+                break;
+            case EPathSearchMode::PathDatabase:
+                Replayed.bFellBack = Event.Time < PathDatabaseReadyTime;
+                Replayed.bFoundPath = Replayed.bFellBack ? Nodes.FindPath(StartIndex, GoalIndex, Context, Path)
+                    : PathDatabase.FindPath(Nodes, StartIndex, GoalIndex, Path);
+                break;
+            default:
+                Replayed.bFoundPath = Nodes.FindPath(StartIndex, GoalIndex, Context, Path);
+                break;
+            }
+            Replayed.Micros = (FPlatformTime::Seconds() - QueryStartTime) * 1.e6;
+            Replayed.PathCost = Replayed.bFoundPath ? GetPathCost(Nodes, Path) : 0.0;
+            break;
+        }
+        }
+    }
+}
+
+void FPathWorkload::SaveToBlob(TArray<uint8>& OutBlob) const
+{
+    OutBlob.Reset();
+    FMemoryWriter Writer(OutBlob, true);
+
+    uint32 Magic = BlobMagic;
+    uint32 Version = BlobVersion;
+    int32 NumSnapshots = Snapshots.Num();
+    int32 NumEvents = Events.Num();
+    Writer << Magic << Version << NumSnapshots << NumEvents;
+    for (const FSnapshot& Snapshot : Snapshots)
+    {
+        FSnapshot& Saved = const_cast<FSnapshot&>(Snapshot);
+        Writer << Saved.GridCount << Saved.Seed << Saved.Weights << Saved.Obstacles;
+    }
+
+    double PreviousTime = 0.0;
+    for (const FEvent& Event : Events)
+    {
+        SerializeEvent(Writer, const_cast<FEvent&>(Event), PreviousTime);
+    }
+}
+
+bool FPathWorkload::LoadFromBlob(const TArray<uint8>& Blob)
+{
+    Snapshots.Reset();
+    Events.Reset();
+    NumQueries = 0;
+    FMemoryReader Reader(Blob, true);
+
+    uint32 Magic = 0;
+    uint32 Version = 0;
+    int32 NumSnapshots = 0;
+    int32 NumEvents = 0;
+    Reader << Magic << Version << NumSnapshots << NumEvents;
+
+    // Every snapshot and event takes at least a few bytes, which bounds the counts of a damaged blob
+    if (Reader.IsError() || Magic != BlobMagic || Version != BlobVersion || NumSnapshots < 0 || NumEvents < 0
+        || NumSnapshots > Blob.Num() || NumEvents > Blob.Num())
+    {
+        return false;
+    }
+
+    bool bValid = true;
+    Snapshots.SetNum(NumSnapshots);
+    for (FSnapshot& Snapshot : Snapshots)
+    {
+        Reader << Snapshot.GridCount << Snapshot.Seed << Snapshot.Weights << Snapshot.Obstacles;
+        const int64 NumTiles = (int64)Snapshot.GridCount * Snapshot.GridCount;
+        bValid = bValid && !Reader.IsError() && Snapshot.GridCount >= 0 && Snapshot.Weights.Num() == NumTiles && Snapshot.Obstacles.Num() == NumTiles;
+        if (!bValid)
+        {
+            break;
+        }
+    }
+
+    double PreviousTime = 0.0;
+    Events.SetNum(bValid ? NumEvents : 0);
+    for (FEvent& Event : Events)
+    {
+        SerializeEvent(Reader, Event, PreviousTime);
+        bValid = !Reader.IsError() && Event.Type <= EEventType::Query
+            && (Event.Type != EEventType::Snapshot || Snapshots.IsValidIndex(Event.Index));
+        if (!bValid)
+        {
+            break;
+        }
+        NumQueries += Event.Type == EEventType::Query ? 1 : 0;
+    }
+
+    if (!bValid)
+    {
+        Snapshots.Reset();
+        Events.Reset();
+        NumQueries = 0;
+    }
+    return bValid;
+}
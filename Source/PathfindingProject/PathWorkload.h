@@ -0,0 +1,126 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FGridNodeStore;
+enum class EPathSearchMode : uint8;
+
+/*
+ * A recorded pathfinding session: the tiles of the grid, every obstacle edit and every path query, in the order
+ * they happened and stamped with the time since the recording started. Whole-grid changes (regenerating the grid,
+ * randomizing weights) are stored as snapshots of the weights and obstacles, so the tiles a query saw can always
+ * be rebuilt without the random streams that made them.
+ *
+ * AGrid fills one while recording; Replay runs the same queries against the same tiles with any search mode, so a
+ * hitch seen in a live session can be measured again, headless, as often as needed.
+ */
+class PATHFINDINGPROJECT_API FPathWorkload
+{
+public:
+    enum class EEventType : uint8
+    {
+        // The tiles were replaced by Snapshots[Index]
+        Snapshot,
+
+        // Tile Index became an obstacle (Value 1) or open (Value 0)
+        SetObstacle,
+
+        // Path from tile Index to tile Value
+        Query
+    };
+
+    // Bit flags describing how a live query was answered
+    enum EQueryFlags : uint8
+    {
+        // Requested through FindPathAsync
+        Async = 1 << 0,
+
+        // Answered from the path cache, without a search
+        CacheHit = 1 << 1,
+
+        // A path was found
+        Found = 1 << 2
+    };
+
+    struct FEvent
+    {
+        EEventType Type = EEventType::Query;
+
+        // Seconds since the recording started
+        double Time = 0.0;
+
+        int32 Index = INDEX_NONE;
+        int32 Value = INDEX_NONE;
+
+        // Queries only: the EPathSearchMode the grid was using, the EQueryFlags, and how long the live search took
+        // in microseconds. Negative when the time is unknown, for an async query cancelled before it finished.
+        uint8 Mode = 0;
+        uint8 Flags = 0;
+        float LiveMicros = -1.0f;
+    };
+
+    // Tiles of the grid at one point of the recording
+    struct FSnapshot
+    {
+        int32 GridCount = 0;
+
+        // Seed the node store was built with. Weights and obstacles are stored as they were, so it is informational.
+        int32 Seed = 0;
+
+        TArray<float> Weights;
+        TBitArray<> Obstacles;
+    };
+
+    // One query run again by Replay
+    struct FReplayedQuery
+    {
+        // Position of the query in GetEvents
+        int32 EventIndex = INDEX_NONE;
+
+        bool bFoundPath = false;
+        double Micros = 0.0;
+        double PathCost = 0.0;
+
+        // PathDatabase only: answered with A* because the database was still being rebuilt, and how long the
+        // rebuild this query started took, which is not part of Micros
+        bool bFellBack = false;
+        double RebuildMicros = 0.0;
+    };
+
+    // Starts an empty recording; event times are measured from now
+    FPathWorkload();
+
+    // Appends the current tiles of Nodes, which every later event applies to
+    void AddSnapshot(const FGridNodeStore& Nodes, int32 Seed);
+
+    void AddObstacleEdit(int32 Index, bool bObstacle);
+
+    // Appends a query and returns its position in GetEvents, for SetQueryResult once an async query has finished
+    int32 AddQuery(int32 StartIndex, int32 GoalIndex, EPathSearchMode Mode, uint8 Flags, float LiveMicros = -1.0f);
+
+    // Fills in the outcome of a query recorded before it finished
+    void SetQueryResult(int32 EventIndex, bool bFoundPath, float LiveMicros);
+
+    const TArray<FEvent>& GetEvents() const { return Events; }
+    const TArray<FSnapshot>& GetSnapshots() const { return Snapshots; }
+    int32 GetNumQueries() const { return NumQueries; }
+
+    /* Rebuilds the recorded tiles and runs every query again, in recorded order and with the edits between them
+       applied, using Mode for all of them. Queries the live grid answered from its cache are searched as well, so
+       every query gets a time. Modes with precomputed state keep it across queries the way AGrid does, and build
+       it on the first query that needs it; that time is part of the query. The path database is the exception: like
+       the live grid, queries are answered with A* until a rebuild that runs apart from them would have finished. */
+    void Replay(EPathSearchMode Mode, TArray<FReplayedQuery>& OutQueries, int32 HierarchicalClusterSize = 16, int32 NumLandmarks = 8) const;
+
+    // Writes the workload to a compact blob, and reads one back. Loading fails on a damaged blob or one from another version.
+    void SaveToBlob(TArray<uint8>& OutBlob) const;
+    bool LoadFromBlob(const TArray<uint8>& Blob);
+
+private:
+    TArray<FSnapshot> Snapshots;
+    TArray<FEvent> Events;
+    int32 NumQueries = 0;
+
+    // FPlatformTime::Seconds when the recording started
+    double StartTime = 0.0;
+};
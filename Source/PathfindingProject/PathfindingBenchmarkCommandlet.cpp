@@ -0,0 +1,430 @@
+#include "PathfindingBenchmarkCommandlet.h"
+#include "GridNodeStore.h"
+#include "PathSearchContext.h"
+#include "PathfindingStats.h"
+#include "PathWorkload.h"
+#include "AllocationCounter.h"
+#include "Grid.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace PathfindingBenchmarkCommandlet
+{
+    // Searches that work on an FGridNodeStore and a caller's context, which is every mode that needs no precomputation
+    static const TCHAR* ModeNames[] = { TEXT("AStar"), TEXT("JumpPoint"), TEXT("Bidirectional"), TEXT("FixedPoint") };
+
+    // How the tile weights of a configuration are drawn
+    static const TCHAR* WeightNames[] = { TEXT("Random"), TEXT("Flat"), TEXT("Patches") };
+
+    // Numbers written for one configuration, and compared against the baseline
+    struct FResultRow
+    {
+        FString Key;
+        int32 NumQueries = 0;
+        int32 NumFound = 0;
+        double P50Micros = 0.0;
+        double P90Micros = 0.0;
+        double P99Micros = 0.0;
+        double MaxMicros = 0.0;
+        double MeanExpanded = 0.0;
+        int64 Allocations = 0;
+        double TotalCost = 0.0;
+    };
+
+    static const TCHAR* CsvHeader = TEXT("GridCount,ObstacleDensity,Weights,Mode,Queries,Found,P50Us,P90Us,P99Us,MaxUs,MeanExpanded,Allocations,TotalCost");
+
+    // Splits a comma separated switch value, falling back to Default when the switch is missing
+    static TArray<FString> ParseList(const FString& Params, const TCHAR* Switch, const TCHAR* Default)
+    {
+        FString Value;
+        if (!FParse::Value(*Params, Switch, Value, false))
+        {
+            Value = Default;
+        }
+        TArray<FString> Items;
+        Value.ParseIntoArray(Items, TEXT(","));
+        return Items;
+    }
+
+    // Sums the movement cost of a path the same way the search charges it
+    static double GetPathCost(const FGridNodeStore& Nodes, const TArray<int32>& Path)
+    {
+        double Cost = 0.0;
+        for (int32 i = 1; i < Path.Num(); i++)
+        {
+            Cost += FVector::Dist(Nodes.Positions[Path[i - 1]], Nodes.Positions[Path[i]]) * Nodes.Weights[Path[i]];
+        }
+        return Cost;
+    }
+
+    // Lays out the grid of one configuration. Everything is drawn from Seed, so every mode sees the same grid.
+    static void BuildGrid(FGridNodeStore& Nodes, int32 GridCount, float ObstacleDensity, int32 WeightType, int32 Seed)
+    {
+        Nodes.Build(GridCount, Seed);
+        FRandomStream Random(Seed);
+        for (int32 Index = 0; Index < Nodes.Num(); Index++)
+        {
+            if (WeightType == 1)
+            {
+                Nodes.Weights[Index] = 1.0f;
+            }
+            else if (WeightType == 2)
+            {
+                // Blocks of eight by eight tiles sharing one weight, like terrain types
+                const uint32 Patch = HashCombine((uint32)(Nodes.GetGridX(Index) / 8), (uint32)(Nodes.GetGridY(Index) / 8));
+                Nodes.Weights[Index] = 1.0f + (float)(HashCombine(Patch, (uint32)Seed) % 5);
+            }
+            Nodes.Obstacles[Index] = Random.FRand() < ObstacleDensity;
+        }
+        Nodes.UpdateStepCosts();
+    }
+
+    static bool RunQuery(const FGridNodeStore& Nodes, int32 Mode, int32 StartIndex, int32 GoalIndex, FPathSearchContext& Context, FPathSearchContext& ReverseContext, TArray<int32>& OutPath)
+    {
+        switch (Mode)
+        {
+        case 1:
+            return Nodes.FindPathJumpPoint(StartIndex, GoalIndex, Context, OutPath);
+        case 2:
+            return Nodes.FindPathBidirectional(StartIndex, GoalIndex, Context, ReverseContext, OutPath);
+        case 3:
+            return Nodes.FindPathFixedPoint(StartIndex, GoalIndex, Context, OutPath);
+        default:
+            return Nodes.FindPath(StartIndex, GoalIndex, Context, OutPath);
+        }
+    }
+
+    // Percentile of sorted samples, by nearest rank
+    static double GetPercentile(const TArray<double>& SortedSamples, double Percentile)
+    {
+        const int32 Rank = FMath::Clamp(FMath::CeilToInt(Percentile * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+        return SortedSamples.Num() > 0 ? SortedSamples[Rank] : 0.0;
+    }
+
+    // Reads the rows of an earlier output file by configuration
+    static bool LoadBaseline(const FString& Filename, TMap<FString, FResultRow>& OutRows)
+    {
+        TArray<FString> Lines;
+        if (!FFileHelper::LoadFileToStringArray(Lines, *Filename))
+        {
+            return false;
+        }
+        for (int32 LineIndex = 1; LineIndex < Lines.Num(); LineIndex++)
+        {
+            TArray<FString> Fields;
+            Lines[LineIndex].ParseIntoArray(Fields, TEXT(","), false);
+            if (Fields.Num() != 13)
+            {
+                continue;
+            }
+            FResultRow Row;
+            Row.Key = FString::Join(MakeArrayView(Fields.GetData(), 4), TEXT(","));
+            Row.NumQueries = FCString::Atoi(*Fields[4]);
+            Row.NumFound = FCString::Atoi(*Fields[5]);
+            Row.P50Micros = FCString::Atod(*Fields[6]);
+            Row.P90Micros = FCString::Atod(*Fields[7]);
+            Row.P99Micros = FCString::Atod(*Fields[8]);
+            Row.MaxMicros = FCString::Atod(*Fields[9]);
+            Row.MeanExpanded = FCString::Atod(*Fields[10]);
+            Row.Allocations = FCString::Atoi64(*Fields[11]);
+            Row.TotalCost = FCString::Atod(*Fields[12]);
+            OutRows.Add(Row.Key, Row);
+        }
+        return true;
+    }
+}
+
+UPathfindingBenchmarkCommandlet::UPathfindingBenchmarkCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UPathfindingBenchmarkCommandlet::Main(const FString& Params)
+{
+    using namespace PathfindingBenchmarkCommandlet;
+
+    FString ReplayFile;
+    if (FParse::Value(*Params, TEXT("Replay="), ReplayFile))
+    {
+        return ReplayWorkload(Params, ReplayFile);
+    }
+
+    const TArray<FString> GridCounts = ParseList(Params, TEXT("GridCounts="), TEXT("100,300"));
+    const TArray<FString> Densities = ParseList(Params, TEXT("Densities="), TEXT("0,0.2,0.35"));
+    const TArray<FString> Weights = ParseList(Params, TEXT("Weights="), TEXT("Random,Flat,Patches"));
+    const TArray<FString> Modes = ParseList(Params, TEXT("Modes="), TEXT("AStar,JumpPoint,Bidirectional,FixedPoint"));
+
+    int32 NumQueries = 200;
+    int32 Seed = 1;
+    float Tolerance = 0.2f;
+    FString OutputFile = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("Pathfinding.csv");
+    FString BaselineFile;
+    FParse::Value(*Params, TEXT("Queries="), NumQueries);
+    FParse::Value(*Params, TEXT("Seed="), Seed);
+    FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+    FParse::Value(*Params, TEXT("Output="), OutputFile);
+    FParse::Value(*Params, TEXT("Baseline="), BaselineFile);
+    NumQueries = FMath::Max(NumQueries, 1);
+
+    TMap<FString, FResultRow> Baseline;
+    if (!BaselineFile.IsEmpty() && !LoadBaseline(BaselineFile, Baseline))
+    {
+        UE_LOG(LogPathfinding, Error, TEXT("PathfindingBenchmark: Could not read baseline %s"), *BaselineFile);
+        return 1;
+    }
+
+    TArray<FString> CsvLines;
+    CsvLines.Add(CsvHeader);
+    int32 NumRegressions = 0;
+
+    for (const FString& GridCountString : GridCounts)
+    {
+        const int32 GridCount = FMath::Max(2, FCString::Atoi(*GridCountString));
+        for (const FString& DensityString : Densities)
+        {
+            const float Density = FMath::Clamp(FCString::Atof(*DensityString), 0.0f, 1.0f);
+            for (const FString& WeightName : Weights)
+            {
+                int32 WeightType = INDEX_NONE;
+                for (int32 Type = 0; Type < UE_ARRAY_COUNT(WeightNames); Type++)
+                {
+                    WeightType = WeightName.Equals(WeightNames[Type], ESearchCase::IgnoreCase) ? Type : WeightType;
+                }
+                if (WeightType == INDEX_NONE)
+                {
+                    UE_LOG(LogPathfinding, Warning, TEXT("PathfindingBenchmark: Unknown weight distribution %s"), *WeightName);
+                    continue;
+                }
+
+                FGridNodeStore Nodes;
+                BuildGrid(Nodes, GridCount, Density, WeightType, Seed);
+
+                // One query set per grid, shared by every mode
+                FRandomStream QueryRandom(HashCombine((uint32)Seed, (uint32)GridCount));
+                TArray<TPair<int32, int32>> Queries;
+                for (int32 Query = 0; Query < NumQueries; Query++)
+                {
+                    Queries.Emplace(QueryRandom.RandRange(0, Nodes.Num() - 1), QueryRandom.RandRange(0, Nodes.Num() - 1));
+                }
+
+                // Warm-up endpoints: the first and last open tiles, near opposite corners, so the warm-up really searches
+                int32 WarmStart = 0;
+                int32 WarmGoal = Nodes.Num() - 1;
+                while (WarmStart < WarmGoal && Nodes.Obstacles[WarmStart])
+                {
+                    WarmStart++;
+                }
+                while (WarmGoal > WarmStart && Nodes.Obstacles[WarmGoal])
+                {
+                    WarmGoal--;
+                }
+
+                for (const FString& ModeName : Modes)
+                {
+                    int32 Mode = INDEX_NONE;
+                    for (int32 ModeIndex = 0; ModeIndex < UE_ARRAY_COUNT(ModeNames); ModeIndex++)
+                    {
+                        Mode = ModeName.Equals(ModeNames[ModeIndex], ESearchCase::IgnoreCase) ? ModeIndex : Mode;
+                    }
+                    if (Mode == INDEX_NONE)
+                    {
+                        UE_LOG(LogPathfinding, Warning, TEXT("PathfindingBenchmark: Unknown mode %s"), *ModeName);
+                        continue;
+                    }
+
+                    // Size the contexts and the path buffer for the whole grid, then warm them with a long query between
+                    // open tiles, so the allocations counted below are the ones the searches themselves make
+                    FPathSearchContext Context;
+                    FPathSearchContext ReverseContext;
+                    TArray<int32> Path;
+                    Context.Reserve(Nodes.Num());
+                    ReverseContext.Reserve(Nodes.Num());
+                    Path.Reserve(Nodes.Num());
+                    RunQuery(Nodes, Mode, WarmStart, WarmGoal, Context, ReverseContext, Path);
+
+                    FResultRow Row;
+                    Row.Key = FString::Printf(TEXT("%d,%g,%s,%s"), GridCount, Density, WeightNames[WeightType], ModeNames[Mode]);
+                    Row.NumQueries = NumQueries;
+                    TArray<double> Latencies;
+                    Latencies.Reserve(NumQueries);
+                    int64 TotalExpanded = 0;
+                    {
+                        FScopedAllocationCounter AllocationCounter;
+                        for (const TPair<int32, int32>& Query : Queries)
+                        {
+                            const double StartTime = FPlatformTime::Seconds();
+                            const bool bFound = RunQuery(Nodes, Mode, Query.Key, Query.Value, Context, ReverseContext, Path);
+                            Latencies.Add((FPlatformTime::Seconds() - StartTime) * 1.e6);
+
+                            TotalExpanded += Context.NumExpanded + (Mode == 2 ? ReverseContext.NumExpanded : 0);
+                            Row.NumFound += bFound ? 1 : 0;
+                            Row.TotalCost += GetPathCost(Nodes, Path);
+                        }
+                        Row.Allocations = AllocationCounter.GetNumAllocations();
+                    }
+                    Latencies.Sort();
+
+                    Row.P50Micros = GetPercentile(Latencies, 0.5);
+                    Row.P90Micros = GetPercentile(Latencies, 0.9);
+                    Row.P99Micros = GetPercentile(Latencies, 0.99);
+                    Row.MaxMicros = Latencies.Last();
+                    Row.MeanExpanded = (double)TotalExpanded / NumQueries;
+
+                    CsvLines.Add(FString::Printf(TEXT("%s,%d,%d,%.2f,%.2f,%.2f,%.2f,%.1f,%lld,%.2f"), *Row.Key, Row.NumQueries, Row.NumFound,
+                        Row.P50Micros, Row.P90Micros, Row.P99Micros, Row.MaxMicros, Row.MeanExpanded, Row.Allocations, Row.TotalCost));
+                    UE_LOG(LogPathfinding, Display, TEXT("PathfindingBenchmark: %s"), *CsvLines.Last());
+
+                    // Costs come from the same seeded grid and queries, so they only differ when the search result changed
+                    if (const FResultRow* BaselineRow = Baseline.Find(Row.Key))
+                    {
+                        TArray<FString> Failures;
+                        if (Row.P90Micros > BaselineRow->P90Micros * (1.0 + Tolerance))
+                        {
+                            Failures.Add(FString::Printf(TEXT("p90 %.2f us against %.2f us"), Row.P90Micros, BaselineRow->P90Micros));
+                        }
+                        if (Row.MeanExpanded > BaselineRow->MeanExpanded * (1.0 + Tolerance))
+                        {
+                            Failures.Add(FString::Printf(TEXT("%.1f expansions against %.1f"), Row.MeanExpanded, BaselineRow->MeanExpanded));
+                        }
+                        if (Row.Allocations > BaselineRow->Allocations)
+                        {
+                            Failures.Add(FString::Printf(TEXT("%lld allocations against %lld"), Row.Allocations, BaselineRow->Allocations));
+                        }
+                        if (Row.NumFound != BaselineRow->NumFound || !FMath::IsNearlyEqual(Row.TotalCost, BaselineRow->TotalCost, FMath::Max(BaselineRow->TotalCost * 1.e-4, 1.0)))
+                        {
+                            Failures.Add(FString::Printf(TEXT("%d paths costing %.2f against %d costing %.2f"), Row.NumFound, Row.TotalCost, BaselineRow->NumFound, BaselineRow->TotalCost));
+                        }
+                        if (Failures.Num() > 0)
+                        {
+                            UE_LOG(LogPathfinding, Error, TEXT("PathfindingBenchmark: %s regressed: %s"), *Row.Key, *FString::Join(Failures, TEXT("; ")));
+                            NumRegressions++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (!FFileHelper::SaveStringArrayToFile(CsvLines, *OutputFile))
+    {
+        UE_LOG(LogPathfinding, Error, TEXT("PathfindingBenchmark: Could not write %s"), *OutputFile);
+        return 1;
+    }
+    UE_LOG(LogPathfinding, Display, TEXT("PathfindingBenchmark: Wrote %d configurations to %s, %d regressions"), CsvLines.Num() - 1, *OutputFile, NumRegressions);
+    return NumRegressions > 0 ? 1 : 0;
+}
+
+int32 UPathfindingBenchmarkCommandlet::ReplayWorkload(const FString& Params, const FString& Filename)
+{
+    using namespace PathfindingBenchmarkCommandlet;
+
+    TArray<uint8> Blob;
+    FPathWorkload Workload;
+    if (!FFileHelper::LoadFileToArray(Blob, *Filename) || !Workload.LoadFromBlob(Blob))
+    {
+        UE_LOG(LogPathfinding, Error, TEXT("PathfindingBenchmark: Could not read workload %s"), *Filename);
+        return 1;
+    }
+
+    int32 HierarchicalClusterSize = 16;
+    int32 NumLandmarks = 8;
+    FString OutputFile = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / (FPaths::GetBaseFilename(Filename) + TEXT("-Replay.csv"));
+    FParse::Value(*Params, TEXT("ClusterSize="), HierarchicalClusterSize);
+    FParse::Value(*Params, TEXT("Landmarks="), NumLandmarks);
+    FParse::Value(*Params, TEXT("Output="), OutputFile);
+
+    // Any search mode can be replayed, by its enum name
+    const UEnum* ModeEnum = StaticEnum<EPathSearchMode>();
+    TArray<EPathSearchMode> Modes;
+    for (const FString& ModeName : ParseList(Params, TEXT("Modes="), TEXT("AStar,JumpPoint,Bidirectional,FixedPoint")))
+    {
+        const int64 Value = ModeEnum->GetValueByNameString(ModeName);
+        if (Value == INDEX_NONE)
+        {
+            UE_LOG(LogPathfinding, Warning, TEXT("PathfindingBenchmark: Unknown mode %s"), *ModeName);
+            continue;
+        }
+        Modes.Add((EPathSearchMode)Value);
+    }
+
+    // One column block per mode, next to the live timing of each query
+    FString Header = TEXT("Event,TimeS,Start,Goal,LiveMode,Async,CacheHit,LiveFound,LiveUs");
+    TArray<TArray<FPathWorkload::FReplayedQuery>> Replays;
+    for (EPathSearchMode Mode : Modes)
+    {
+        const FString ModeName = ModeEnum->GetNameStringByValue((int64)Mode);
+        Header += FString::Printf(TEXT(",%sFound,%sUs,%sDeltaUs,%sCost,%sFellBack,%sRebuildUs"), *ModeName, *ModeName, *ModeName, *ModeName, *ModeName, *ModeName);
+
+        const double StartTime = FPlatformTime::Seconds();
+        Workload.Replay(Mode, Replays.AddDefaulted_GetRef(), HierarchicalClusterSize, NumLandmarks);
+        const double ReplaySeconds = FPlatformTime::Seconds() - StartTime;
+
+        // Only queries that searched live and have a time compare like for like
+        TArray<double> Latencies;
+        double LiveMicros = 0.0;
+        double ReplayMicros = 0.0;
+        double RebuildMicros = 0.0;
+        int32 NumRebuilds = 0;
+        int32 NumFellBack = 0;
+        int32 NumMismatched = 0;
+        for (const FPathWorkload::FReplayedQuery& Replayed : Replays.Last())
+        {
+            const FPathWorkload::FEvent& Event = Workload.GetEvents()[Replayed.EventIndex];
+            Latencies.Add(Replayed.Micros);
+            RebuildMicros += Replayed.RebuildMicros;
+            NumRebuilds += Replayed.RebuildMicros > 0.0 ? 1 : 0;
+            NumFellBack += Replayed.bFellBack ? 1 : 0;
+            NumMismatched += Replayed.bFoundPath != ((Event.Flags & FPathWorkload::Found) != 0) && Event.LiveMicros >= 0.0f ? 1 : 0;
+            if (Event.LiveMicros >= 0.0f && !(Event.Flags & FPathWorkload::CacheHit))
+            {
+                LiveMicros += Event.LiveMicros;
+                ReplayMicros += Replayed.Micros;
+            }
+        }
+        Latencies.Sort();
+        UE_LOG(LogPathfinding, Display, TEXT("PathfindingBenchmark: %s replayed %d queries in %.2f ms, p50 %.2f us, p90 %.2f us, max %.2f us; searched queries took %.2f ms against %.2f ms live; %d found a path where live did not or the other way round"),
+            *ModeName, Latencies.Num(), ReplaySeconds * 1000.0, GetPercentile(Latencies, 0.5), GetPercentile(Latencies, 0.9), Latencies.Num() > 0 ? Latencies.Last() : 0.0,
+            ReplayMicros / 1000.0, LiveMicros / 1000.0, NumMismatched);
+        if (NumRebuilds > 0)
+        {
+            UE_LOG(LogPathfinding, Display, TEXT("PathfindingBenchmark: %s rebuilt its path database %d times in %.2f ms, apart from the queries; %d queries used A* while it was stale"),
+                *ModeName, NumRebuilds, RebuildMicros / 1000.0, NumFellBack);
+        }
+    }
+
+    TArray<FString> CsvLines;
+    CsvLines.Add(Header);
+    for (int32 QueryIndex = 0; QueryIndex < Workload.GetNumQueries(); QueryIndex++)
+    {
+        const int32 EventIndex = Replays.Num() > 0 ? Replays[0][QueryIndex].EventIndex : INDEX_NONE;
+        if (EventIndex == INDEX_NONE)
+        {
+            break;
+        }
+        const FPathWorkload::FEvent& Event = Workload.GetEvents()[EventIndex];
+        FString Line = FString::Printf(TEXT("%d,%.6f,%d,%d,%s,%d,%d,%d,%.2f"), EventIndex, Event.Time, Event.Index, Event.Value,
+            *ModeEnum->GetNameStringByValue(Event.Mode), (Event.Flags & FPathWorkload::Async) ? 1 : 0, (Event.Flags & FPathWorkload::CacheHit) ? 1 : 0,
+            (Event.Flags & FPathWorkload::Found) ? 1 : 0, Event.LiveMicros);
+        for (const TArray<FPathWorkload::FReplayedQuery>& Replay : Replays)
+        {
+            const FPathWorkload::FReplayedQuery& Replayed = Replay[QueryIndex];
+            const double DeltaMicros = Event.LiveMicros >= 0.0f ? Replayed.Micros - Event.LiveMicros : 0.0;
+            Line += FString::Printf(TEXT(",%d,%.2f,%.2f,%.2f,%d,%.2f"), Replayed.bFoundPath ? 1 : 0, Replayed.Micros, DeltaMicros, Replayed.PathCost,
+                Replayed.bFellBack ? 1 : 0, Replayed.RebuildMicros);
+        }
+        CsvLines.Add(MoveTemp(Line));
+    }
+
+    if (!FFileHelper::SaveStringArrayToFile(CsvLines, *OutputFile))
+    {
+        UE_LOG(LogPathfinding, Error, TEXT("PathfindingBenchmark: Could not write %s"), *OutputFile);
+        return 1;
+    }
+    UE_LOG(LogPathfinding, Display, TEXT("PathfindingBenchmark: Wrote %d replayed queries of %s to %s"), CsvLines.Num() - 1, *Filename, *OutputFile);
+    return 0;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PathfindingBenchmarkCommandlet.generated.h"
+
+/*
+ * Headless pathfinding benchmark. Sweeps grid sizes, obstacle densities and weight distributions, runs the same
+ * seeded query set against each search mode, and writes one CSV row per configuration with latency percentiles,
+ * expansions, heap allocations (every one the searches make on warm contexts, see FScopedAllocationCounter) and
+ * total path cost. Grids are laid out with FGridNodeStore::Build, the same call
+ * AGrid::GenerateGrid makes, so no level or renderer is needed:
+ *
+ *   UnrealEditor-Cmd PathfindingProject -run=PathfindingBenchmark -nullrhi -unattended
+ *       [-GridCounts=100,300] [-Densities=0,0.2,0.35] [-Weights=Random,Flat,Patches] [-Modes=AStar,JumpPoint,Bidirectional,FixedPoint]
+ *       [-Queries=200] [-Seed=1] [-Output=<csv>] [-Baseline=<csv>] [-Tolerance=0.2]
+ *
+ * A baseline is an earlier output file. A configuration regresses when its p90 latency or mean expansions exceed
+ * the baseline's by more than Tolerance, when it allocates more, or when its path cost differs; the commandlet then
+ * returns 1 so a build step can fail on it.
+ *
+ * With -Replay=<file> it instead runs a workload recorded by AGrid (Pathfinding.RecordWorkload) against each of
+ * -Modes, which may name any EPathSearchMode, and writes one row per recorded query with the live time and each
+ * mode's time, its difference to the live one and the path cost. A PathDatabase replay answers with A* while the
+ * database would still be rebuilding after an edit, as the live grid does, and reports the rebuilds apart.
+ */
+UCLASS()
+class UPathfindingBenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UPathfindingBenchmarkCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+
+private:
+    // Replays the workload saved in Filename and writes the per-query comparison
+    int32 ReplayWorkload(const FString& Params, const FString& Filename);
+};
@@ -0,0 +1,1421 @@
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "GridNodeStore.h"
+#include "PathSearchContext.h"
+#include "PathBatch.h"
+#include "IncrementalPathPlanner.h"
+#include "HierarchicalPathfinder.h"
+#include "FlowField.h"
+#include "LandmarkHeuristic.h"
+#include "CompressedPathDatabase.h"
+#include "GridFile.h"
+#include "GridChunkWorld.h"
+#include "ConnectedComponents.h"
+#include "CooperativePlanner.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Async/ParallelFor.h"
+
+// Console commands that time the pathfinding code on node stores built outside of the level, so large grid
+// counts can be measured without spawning tiles or text components
+
+namespace PathfindingBenchmarks
+{
+    // The search AGrid::FindPath used before the indexed heap: a linear scan of the open array for the best
+    // FCost and a hashed set for the closed nodes. Kept only as the baseline for the benchmark.
+    static bool FindPathLinearScan(const FGridNodeStore& Nodes, int32 StartIndex, int32 GoalIndex, TArray<int32>& OutPath, int32& OutNumExpanded)
+    {
+        OutPath.Reset();
+        OutNumExpanded = 0;
+
+        TArray<float> GCosts;
+        TArray<float> HCosts;
+        TArray<int32> Parents;
+        GCosts.Init(TNumericLimits<float>::Max(), Nodes.Num());
+        HCosts.Init(TNumericLimits<float>::Max(), Nodes.Num());
+        Parents.Init(INDEX_NONE, Nodes.Num());
+
+        const FVector& GoalPosition = Nodes.Positions[GoalIndex];
+        GCosts[StartIndex] = 0;
+        HCosts[StartIndex] = FVector::Dist(Nodes.Positions[StartIndex], GoalPosition);
+
+        TArray<int32> OpenSet;
+        TSet<int32> ClosedSet;
+        OpenSet.Add(StartIndex);
+
+        while (OpenSet.Num() > 0)
+        {
+            int32 Current = OpenSet[0];
+            for (int32 Node : OpenSet)
+            {
+                const float NodeFCost = GCosts[Node] + HCosts[Node];
+                const float CurrentFCost = GCosts[Current] + HCosts[Current];
+                if (NodeFCost < CurrentFCost || (FMath::IsNearlyEqual(NodeFCost, CurrentFCost) && HCosts[Node] < HCosts[Current]))
+                {
+                    Current = Node;
+                }
+            }
+            OutNumExpanded++;
+
+            if (Current == GoalIndex)
+            {
+                for (int32 PathNode = GoalIndex; PathNode != INDEX_NONE; PathNode = Parents[PathNode])
+                {
+                    OutPath.Insert(PathNode, 0);
+                }
+                return true;
+            }
+
+            OpenSet.Remove(Current);
+            ClosedSet.Add(Current);
+
+            for (int32 Neighbor : Nodes.GetNeighbors(Current))
+            {
+                if (Neighbor == INDEX_NONE || Nodes.Obstacles[Neighbor] || ClosedSet.Contains(Neighbor))
+                {
+                    continue;
+                }
+
+                float TentativeGCost = GCosts[Current] + FVector::Dist(Nodes.Positions[Current], Nodes.Positions[Neighbor]) * Nodes.Weights[Neighbor];
+                if (TentativeGCost < GCosts[Neighbor])
+                {
+                    GCosts[Neighbor] = TentativeGCost;
+                    HCosts[Neighbor] = FVector::Dist(Nodes.Positions[Neighbor], GoalPosition);
+                    Parents[Neighbor] = Current;
+                    if (!OpenSet.Contains(Neighbor))
+                    {
+                        OpenSet.Add(Neighbor);
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    // Sums the movement cost of a path the same way the search charges it
+    static float GetPathCost(const FGridNodeStore& Nodes, const TArray<int32>& Path)
+    {
+        float Cost = 0.0f;
+        for (int32 i = 1; i < Path.Num(); i++)
+        {
+            Cost += FVector::Dist(Nodes.Positions[Path[i - 1]], Nodes.Positions[Path[i]]) * Nodes.Weights[Path[i]];
+        }
+        return Cost;
+    }
+
+    // Pathfinding.BenchmarkOpenSet [NumQueries] [GridCount...]
+    static void RunOpenSetBenchmark(const TArray<FString>& Args)
+    {
+        int32 NumQueries = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 3;
+        TArray<int32> GridCounts;
+        for (int32 i = 1; i < Args.Num(); i++)
+        {
+            GridCounts.Add(FMath::Max(2, FCString::Atoi(*Args[i])));
+        }
+        if (GridCounts.Num() == 0)
+        {
+            GridCounts = { 10, 100, 1000 };
+        }
+
+        for (int32 GridCount : GridCounts)
+        {
+            FGridNodeStore Nodes;
+            Nodes.Build(GridCount);
+            const int32 NumNodes = Nodes.Num();
+
+            // The first query crosses the whole grid, the rest use a fixed seed so every run compares the same pairs
+            FRandomStream Random(GridCount);
+            double LegacySeconds = 0.0;
+            double HeapSeconds = 0.0;
+            int64 LegacyExpanded = 0;
+            int64 HeapExpanded = 0;
+            int32 NumMismatches = 0;
+            TArray<int32> LegacyPath;
+            TArray<int32> HeapPath;
+            FPathSearchContext Context;
+
+            for (int32 Query = 0; Query < NumQueries; Query++)
+            {
+                int32 StartIndex = Query == 0 ? 0 : Random.RandRange(0, NumNodes - 1);
+                int32 GoalIndex = Query == 0 ? NumNodes - 1 : Random.RandRange(0, NumNodes - 1);
+
+                int32 NumExpanded = 0;
+                double StartTime = FPlatformTime::Seconds();
+                FindPathLinearScan(Nodes, StartIndex, GoalIndex, LegacyPath, NumExpanded);
+                LegacySeconds += FPlatformTime::Seconds() - StartTime;
+                LegacyExpanded += NumExpanded;
+
+                StartTime = FPlatformTime::Seconds();
+                Nodes.FindPath(StartIndex, GoalIndex, Context, HeapPath);
+                HeapSeconds += FPlatformTime::Seconds() - StartTime;
+                HeapExpanded += Context.NumExpanded;
+
+                if (LegacyPath.Num() != HeapPath.Num() || !FMath::IsNearlyEqual(GetPathCost(Nodes, LegacyPath), GetPathCost(Nodes, HeapPath), 1.e-3f))
+                {
+                    NumMismatches++;
+                }
+            }
+
+            UE_LOG(LogTemp, Log, TEXT("BenchmarkOpenSet: GridCount %d, %d queries | linear scan %.3f ms (%lld expanded, %.3f us/expansion) | indexed heap %.3f ms (%lld expanded, %.3f us/expansion) | speedup %.1fx, %d path mismatches"),
+                GridCount, NumQueries,
+                LegacySeconds * 1000.0, LegacyExpanded, LegacySeconds * 1.e6 / FMath::Max<int64>(LegacyExpanded, 1),
+                HeapSeconds * 1000.0, HeapExpanded, HeapSeconds * 1.e6 / FMath::Max<int64>(HeapExpanded, 1),
+                LegacySeconds / FMath::Max(HeapSeconds, 1.e-9), NumMismatches);
+        }
+    }
+
+    // Pathfinding.BenchmarkBatch [GridCount] [NumQueries] [MaxWorkers]
+    static void RunBatchBenchmark(const TArray<FString>& Args)
+    {
+        const int32 GridCount = Args.Num() > 0 ? FMath::Max(2, FCString::Atoi(*Args[0])) : 200;
+        const int32 NumQueries = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 500;
+        const int32 MaxWorkers = Args.Num() > 2 ? FMath::Max(1, FCString::Atoi(*Args[2])) : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+
+        FGridNodeStore Nodes;
+        Nodes.Build(GridCount);
+        FRandomStream Random(GridCount);
+        for (int32 Index = 0; Index < Nodes.Num(); Index++)
+        {
+            Nodes.Obstacles[Index] = Random.FRand() < 0.2f;
+        }
+
+        TArray<FPathRequest> Requests;
+        Requests.SetNum(NumQueries);
+        for (FPathRequest& Request : Requests)
+        {
+            Request.StartIndex = Random.RandRange(0, Nodes.Num() - 1);
+            Request.GoalIndex = Random.RandRange(0, Nodes.Num() - 1);
+        }
+
+        // Double the worker count each step, always ending on the maximum
+        TArray<int32> WorkerCounts;
+        for (int32 NumWorkers = 1; NumWorkers < MaxWorkers; NumWorkers *= 2)
+        {
+            WorkerCounts.Add(NumWorkers);
+        }
+        WorkerCounts.Add(MaxWorkers);
+
+        FPathBatchSearcher Searcher;
+        TArray<int32> Paths;
+        double SingleWorkerRate = 0.0;
+        int32 SingleWorkerLength = 0;
+        for (int32 NumWorkers : WorkerCounts)
+        {
+            // The first run warms the workers' contexts, the second one is timed
+            Searcher.Run(Nodes, Requests, Paths, NumWorkers);
+            const double StartTime = FPlatformTime::Seconds();
+            Searcher.Run(Nodes, Requests, Paths, NumWorkers);
+            const double Seconds = FMath::Max(FPlatformTime::Seconds() - StartTime, 1.e-9);
+
+            const double QueriesPerSecond = NumQueries / Seconds;
+            if (NumWorkers == 1)
+            {
+                SingleWorkerRate = QueriesPerSecond;
+                SingleWorkerLength = Paths.Num();
+            }
+
+            UE_LOG(LogTemp, Log, TEXT("BenchmarkBatch: GridCount %d, %d queries, %d workers | %.3f ms, %.0f queries/s, %.2fx of one worker, %d path nodes%s"),
+                GridCount, NumQueries, NumWorkers, Seconds * 1000.0, QueriesPerSecond, QueriesPerSecond / FMath::Max(SingleWorkerRate, 1.e-9),
+                Paths.Num(), Paths.Num() != SingleWorkerLength ? TEXT(" (differs from one worker!)") : TEXT(""));
+        }
+    }
+
+    static FAutoConsoleCommand BenchmarkBatchCommand(
+        TEXT("Pathfinding.BenchmarkBatch"),
+        TEXT("Measures FindPathsBatch throughput from one worker up to MaxWorkers. Usage: Pathfinding.BenchmarkBatch [GridCount] [NumQueries] [MaxWorkers]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunBatchBenchmark));
+
+    // Pathfinding.BenchmarkReplanning [GridCount] [NumEdits]
+    static void RunReplanningBenchmark(const TArray<FString>& Args)
+    {
+        const int32 GridCount = Args.Num() > 0 ? FMath::Max(2, FCString::Atoi(*Args[0])) : 500;
+        const int32 NumEdits = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100;
+
+        FGridNodeStore Nodes;
+        Nodes.Build(GridCount);
+        FRandomStream Random(GridCount);
+        for (int32 Index = 0; Index < Nodes.Num(); Index++)
+        {
+            Nodes.Obstacles[Index] = Random.FRand() < 0.2f;
+        }
+
+        // Plan between opposite corners so the search tree covers most of the grid, and keep the corners
+        // open so neither end gets walled in
+        const int32 StartIndex = 0;
+        const int32 GoalIndex = Nodes.Num() - 1;
+        for (int32 Corner : { StartIndex, GoalIndex })
+        {
+            Nodes.Obstacles[Corner] = false;
+            for (int32 Neighbor : Nodes.GetNeighbors(Corner))
+            {
+                if (Neighbor != INDEX_NONE)
+                {
+                    Nodes.Obstacles[Neighbor] = false;
+                }
+            }
+        }
+
+        FIncrementalPathPlanner Planner;
+        TArray<int32> PlannerPath;
+        double StartTime = FPlatformTime::Seconds();
+        Planner.Initialize(Nodes, StartIndex, GoalIndex);
+        Planner.FindPath(PlannerPath);
+        const double InitialSeconds = FPlatformTime::Seconds() - StartTime;
+        const int32 InitialExpanded = Planner.NumExpanded;
+
+        FPathSearchContext Context;
+        TArray<int32> SearchPath;
+        Nodes.FindPath(StartIndex, GoalIndex, Context, SearchPath);
+
+        // Half of the edits toggle a tile on the current path, which forces a detour. The other half toggle
+        // a random tile, which is what most edits on a large map look like.
+        double ReplanSeconds[2] = { 0.0, 0.0 };
+        double SearchSeconds[2] = { 0.0, 0.0 };
+        int64 ReplanExpanded[2] = { 0, 0 };
+        int64 SearchExpanded[2] = { 0, 0 };
+        int32 EditCounts[2] = { 0, 0 };
+        int32 NumMismatches = 0;
+
+        for (int32 Edit = 0; Edit < NumEdits; Edit++)
+        {
+            const int32 Kind = (Edit % 2 == 0 && PlannerPath.Num() > 2) ? 0 : 1;
+            const int32 Tile = Kind == 0 ? PlannerPath[Random.RandRange(1, PlannerPath.Num() - 2)] : Random.RandRange(1, Nodes.Num() - 2);
+            Nodes.Obstacles[Tile] = !Nodes.Obstacles[Tile];
+            EditCounts[Kind]++;
+
+            StartTime = FPlatformTime::Seconds();
+            Planner.NotifyNodeChanged(Tile);
+            const bool bPlannerFound = Planner.FindPath(PlannerPath);
+            ReplanSeconds[Kind] += FPlatformTime::Seconds() - StartTime;
+            ReplanExpanded[Kind] += Planner.NumExpanded;
+
+            StartTime = FPlatformTime::Seconds();
+            const bool bSearchFound = Nodes.FindPath(StartIndex, GoalIndex, Context, SearchPath);
+            SearchSeconds[Kind] += FPlatformTime::Seconds() - StartTime;
+            SearchExpanded[Kind] += Context.NumExpanded;
+
+            // Both searches are optimal, so their paths may differ but their costs may not
+            const float SearchCost = GetPathCost(Nodes, SearchPath);
+            if (bPlannerFound != bSearchFound || !FMath::IsNearlyEqual(GetPathCost(Nodes, PlannerPath), SearchCost, FMath::Max(SearchCost * 1.e-5f, 1.e-3f)))
+            {
+                NumMismatches++;
+            }
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("BenchmarkReplanning: GridCount %d, initial plan %.3f ms (%d expanded)"), GridCount, InitialSeconds * 1000.0, InitialExpanded);
+        const TCHAR* KindNames[2] = { TEXT("on-path edits"), TEXT("random edits") };
+        for (int32 Kind = 0; Kind < 2; Kind++)
+        {
+            const int32 Count = FMath::Max(EditCounts[Kind], 1);
+            UE_LOG(LogTemp, Log, TEXT("BenchmarkReplanning: %d %s | replan %.3f ms, %lld expanded per edit | full A* %.3f ms, %lld expanded per edit | speedup %.1fx"),
+                EditCounts[Kind], KindNames[Kind],
+                ReplanSeconds[Kind] * 1000.0 / Count, ReplanExpanded[Kind] / Count,
+                SearchSeconds[Kind] * 1000.0 / Count, SearchExpanded[Kind] / Count,
+                SearchSeconds[Kind] / FMath::Max(ReplanSeconds[Kind], 1.e-9));
+        }
+        UE_LOG(LogTemp, Log, TEXT("BenchmarkReplanning: %d path cost mismatches"), NumMismatches);
+    }
+
+    static FAutoConsoleCommand BenchmarkReplanningCommand(
+        TEXT("Pathfinding.BenchmarkReplanning"),
+        TEXT("Toggles single tiles between two fixed corners and times the incremental planner's repair against a full A* search. Usage: Pathfinding.BenchmarkReplanning [GridCount] [NumEdits] (defaults: 500 100)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunReplanningBenchmark));
+
+    // Pathfinding.BenchmarkHierarchical [GridCount] [NumQueries] [ClusterSize]
+    static void RunHierarchicalBenchmark(const TArray<FString>& Args)
+    {
+        const int32 GridCount = Args.Num() > 0 ? FMath::Max(2, FCString::Atoi(*Args[0])) : 1000;
+        const int32 NumQueries = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100;
+        const int32 ClusterSize = Args.Num() > 2 ? FMath::Max(2, FCString::Atoi(*Args[2])) : 16;
+
+        FGridNodeStore Nodes;
+        Nodes.Build(GridCount);
+        FRandomStream Random(GridCount);
+        for (int32 Index = 0; Index < Nodes.Num(); Index++)
+        {
+            Nodes.Obstacles[Index] = Random.FRand() < 0.2f;
+        }
+
+        FHierarchicalPathfinder Hierarchical;
+        double StartTime = FPlatformTime::Seconds();
+        Hierarchical.Build(Nodes, ClusterSize);
+        const double BuildSeconds = FPlatformTime::Seconds() - StartTime;
+
+        UE_LOG(LogTemp, Log, TEXT("BenchmarkHierarchical: GridCount %d, cluster size %d | build %.1f ms, %d entrances, %.1f MB"),
+            GridCount, ClusterSize, BuildSeconds * 1000.0, Hierarchical.GetNumEntrances(), Hierarchical.GetAllocatedSize() / (1024.0 * 1024.0));
+
+        FPathSearchContext Context;
+        TArray<int32> FlatPath;
+        TArray<int32> HierarchicalPath;
+        double FlatSeconds = 0.0;
+        double HierarchicalSeconds = 0.0;
+        double MaxHierarchicalSeconds = 0.0;
+        double TotalCostRatio = 0.0;
+        double MaxCostRatio = 1.0;
+        int32 NumCompared = 0;
+        int32 NumMismatches = 0;
+
+        for (int32 Query = 0; Query < NumQueries; Query++)
+        {
+            const int32 StartIndex = Random.RandRange(0, Nodes.Num() - 1);
+            const int32 GoalIndex = Random.RandRange(0, Nodes.Num() - 1);
+
+            StartTime = FPlatformTime::Seconds();
+            const bool bFlatFound = Nodes.FindPath(StartIndex, GoalIndex, Context, FlatPath);
+            FlatSeconds += FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            const bool bHierarchicalFound = Hierarchical.FindPath(StartIndex, GoalIndex, HierarchicalPath);
+            const double QuerySeconds = FPlatformTime::Seconds() - StartTime;
+            HierarchicalSeconds += QuerySeconds;
+            MaxHierarchicalSeconds = FMath::Max(MaxHierarchicalSeconds, QuerySeconds);
+
+            // Both searches must agree on whether the goal is reachable; how much longer the hierarchical path is, is the price of the speedup
+            if (bFlatFound != bHierarchicalFound)
+            {
+                NumMismatches++;
+            }
+            else if (bFlatFound && FlatPath.Num() > 1)
+            {
+                const double CostRatio = GetPathCost(Nodes, HierarchicalPath) / GetPathCost(Nodes, FlatPath);
+                TotalCostRatio += CostRatio;
+                MaxCostRatio = FMath::Max(MaxCostRatio, CostRatio);
+                NumCompared++;
+            }
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("BenchmarkHierarchical: %d queries | flat A* %.3f ms avg | hierarchical %.3f ms avg, %.3f ms max | speedup %.1fx | path cost %.2f%% over optimal on average, %.2f%% at worst | %d reachability mismatches"),
+            NumQueries, FlatSeconds * 1000.0 / NumQueries, HierarchicalSeconds * 1000.0 / NumQueries, MaxHierarchicalSeconds * 1000.0,
+            FlatSeconds / FMath::Max(HierarchicalSeconds, 1.e-9),
+            NumCompared > 0 ? (TotalCostRatio / NumCompared - 1.0) * 100.0 : 0.0, (MaxCostRatio - 1.0) * 100.0, NumMismatches);
+
+        // A single edit only rebuilds the clusters around the tile, which the next query pays for
+        const int32 NumEdits = 20;
+        double EditSeconds = 0.0;
+        for (int32 Edit = 0; Edit < NumEdits; Edit++)
+        {
+            const int32 Tile = Random.RandRange(0, Nodes.Num() - 1);
+            Nodes.Obstacles[Tile] = !Nodes.Obstacles[Tile];
+
+            StartTime = FPlatformTime::Seconds();
+            Hierarchical.NotifyNodeChanged(Tile);
+            Hierarchical.FindPath(Random.RandRange(0, Nodes.Num() - 1), Random.RandRange(0, Nodes.Num() - 1), HierarchicalPath);
+            EditSeconds += FPlatformTime::Seconds() - StartTime;
+        }
+        UE_LOG(LogTemp, Log, TEXT("BenchmarkHierarchical: first query after a single-tile edit %.3f ms avg, against %.1f ms for a full build"),
+            EditSeconds * 1000.0 / NumEdits, BuildSeconds * 1000.0);
+    }
+
+    static FAutoConsoleCommand BenchmarkHierarchicalCommand(
+        TEXT("Pathfinding.BenchmarkHierarchical"),
+        TEXT("Compares hierarchical search latency and path cost with flat A* on a large grid. Usage: Pathfinding.BenchmarkHierarchical [GridCount] [NumQueries] [ClusterSize] (defaults: 1000 100 16)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunHierarchicalBenchmark));
+
+    // Pathfinding.BenchmarkJumpPoint [GridCount] [NumQueries]
+    static void RunJumpPointBenchmark(const TArray<FString>& Args)
+    {
+        const int32 GridCount = Args.Num() > 0 ? FMath::Max(2, FCString::Atoi(*Args[0])) : 300;
+        const int32 NumQueries = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100;
+
+        const TCHAR* MapNames[] = { TEXT("open"), TEXT("weighted patches"), TEXT("maze"), TEXT("random weights") };
+        for (int32 MapType = 0; MapType < UE_ARRAY_COUNT(MapNames); MapType++)
+        {
+            FGridNodeStore Nodes;
+            Nodes.Build(GridCount);
+            FRandomStream Random(GridCount);
+            for (int32 Index = 0; Index < Nodes.Num(); Index++)
+            {
+                const int32 X = Nodes.GetGridX(Index);
+                const int32 Y = Nodes.GetGridY(Index);
+                switch (MapType)
+                {
+                case 0: // One weight everywhere and nothing in the way
+                    Nodes.Weights[Index] = 1.0f;
+                    Nodes.Obstacles[Index] = false;
+                    break;
+                case 1: // Blocks of 16 x 16 tiles, each with its own weight
+                    Nodes.Weights[Index] = 1.0f + (X / 16 + Y / 16) % 3;
+                    Nodes.Obstacles[Index] = false;
+                    break;
+                case 2: // Walls every eight rows and columns, with random gaps
+                    Nodes.Weights[Index] = 1.0f;
+                    Nodes.Obstacles[Index] = (X % 8 == 0 || Y % 8 == 0) && Random.FRand() < 0.8f;
+                    break;
+                default: // The grid's own random weights, where there is nothing to skip
+                    Nodes.Obstacles[Index] = Random.FRand() < 0.2f;
+                    break;
+                }
+            }
+
+            FPathSearchContext Context;
+            TArray<int32> AStarPath;
+            TArray<int32> JumpPointPath;
+            double AStarSeconds = 0.0;
+            double JumpPointSeconds = 0.0;
+            int64 AStarExpanded = 0;
+            int64 JumpPointExpanded = 0;
+            int32 NumMismatches = 0;
+
+            for (int32 Query = 0; Query < NumQueries; Query++)
+            {
+                const int32 StartIndex = Random.RandRange(0, Nodes.Num() - 1);
+                const int32 GoalIndex = Random.RandRange(0, Nodes.Num() - 1);
+
+                double StartTime = FPlatformTime::Seconds();
+                const bool bAStarFound = Nodes.FindPath(StartIndex, GoalIndex, Context, AStarPath);
+                AStarSeconds += FPlatformTime::Seconds() - StartTime;
+                AStarExpanded += Context.NumExpanded;
+
+                StartTime = FPlatformTime::Seconds();
+                const bool bJumpPointFound = Nodes.FindPathJumpPoint(StartIndex, GoalIndex, Context, JumpPointPath);
+                JumpPointSeconds += FPlatformTime::Seconds() - StartTime;
+                JumpPointExpanded += Context.NumExpanded;
+
+                // The paths may differ between equally short alternatives, but never in cost
+                if (bAStarFound != bJumpPointFound ||
+                    !FMath::IsNearlyEqual(GetPathCost(Nodes, AStarPath), GetPathCost(Nodes, JumpPointPath), FMath::Max(GetPathCost(Nodes, AStarPath) * 1.e-5f, 1.e-2f)))
+                {
+                    NumMismatches++;
+                }
+            }
+
+            UE_LOG(LogTemp, Log, TEXT("BenchmarkJumpPoint: %s map, GridCount %d, %d queries | A* %.3f ms avg, %lld expanded | jump point %.3f ms avg, %lld expanded | %.1fx fewer expansions, speedup %.1fx | %d cost mismatches"),
+                MapNames[MapType], GridCount, NumQueries,
+                AStarSeconds * 1000.0 / NumQueries, AStarExpanded, JumpPointSeconds * 1000.0 / NumQueries, JumpPointExpanded,
+                (double)AStarExpanded / FMath::Max<int64>(JumpPointExpanded, 1), AStarSeconds / FMath::Max(JumpPointSeconds, 1.e-9), NumMismatches);
+        }
+    }
+
+    static FAutoConsoleCommand BenchmarkJumpPointCommand(
+        TEXT("Pathfinding.BenchmarkJumpPoint"),
+        TEXT("Compares jump point search with A* on open, patchy, maze and randomly weighted maps. Usage: Pathfinding.BenchmarkJumpPoint [GridCount] [NumQueries] (defaults: 300 100)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunJumpPointBenchmark));
+
+    // Pathfinding.BenchmarkBidirectional [NumQueries] [GridCount...]
+    static void RunBidirectionalBenchmark(const TArray<FString>& Args)
+    {
+        const int32 NumQueries = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100;
+        TArray<int32> GridCounts;
+        for (int32 i = 1; i < Args.Num(); i++)
+        {
+            GridCounts.Add(FMath::Max(2, FCString::Atoi(*Args[i])));
+        }
+        if (GridCounts.Num() == 0)
+        {
+            GridCounts = { 100, 300, 1000 };
+        }
+
+        for (int32 GridCount : GridCounts)
+        {
+            FGridNodeStore Nodes;
+            Nodes.Build(GridCount);
+            FRandomStream Random(GridCount);
+            for (int32 Index = 0; Index < Nodes.Num(); Index++)
+            {
+                Nodes.Obstacles[Index] = Random.FRand() < 0.2f;
+            }
+
+            // Random pairs, and long queries between opposite sides of the grid where a single frontier grows widest
+            const TCHAR* ScenarioNames[] = { TEXT("random pairs"), TEXT("across the grid") };
+            for (int32 Scenario = 0; Scenario < UE_ARRAY_COUNT(ScenarioNames); Scenario++)
+            {
+                FPathSearchContext Context;
+                FPathSearchContext ReverseContext;
+                TArray<int32> ForwardPath;
+                TArray<int32> BidirectionalPath;
+                double ForwardSeconds = 0.0;
+                double BidirectionalSeconds = 0.0;
+                int64 ForwardExpanded = 0;
+                int64 BidirectionalExpanded = 0;
+                int32 NumMismatches = 0;
+
+                for (int32 Query = 0; Query < NumQueries; Query++)
+                {
+                    int32 StartIndex = Random.RandRange(0, Nodes.Num() - 1);
+                    int32 GoalIndex = Random.RandRange(0, Nodes.Num() - 1);
+                    if (Scenario == 1)
+                    {
+                        StartIndex = Nodes.GetIndex(Random.RandRange(0, GridCount / 10), Random.RandRange(0, GridCount - 1));
+                        GoalIndex = Nodes.GetIndex(GridCount - 1 - Random.RandRange(0, GridCount / 10), Random.RandRange(0, GridCount - 1));
+                    }
+
+                    double StartTime = FPlatformTime::Seconds();
+                    const bool bForwardFound = Nodes.FindPath(StartIndex, GoalIndex, Context, ForwardPath);
+                    ForwardSeconds += FPlatformTime::Seconds() - StartTime;
+                    ForwardExpanded += Context.NumExpanded;
+
+                    StartTime = FPlatformTime::Seconds();
+                    const bool bBidirectionalFound = Nodes.FindPathBidirectional(StartIndex, GoalIndex, Context, ReverseContext, BidirectionalPath);
+                    BidirectionalSeconds += FPlatformTime::Seconds() - StartTime;
+                    BidirectionalExpanded += Context.NumExpanded + ReverseContext.NumExpanded;
+
+                    if (bForwardFound != bBidirectionalFound ||
+                        !FMath::IsNearlyEqual(GetPathCost(Nodes, ForwardPath), GetPathCost(Nodes, BidirectionalPath), FMath::Max(GetPathCost(Nodes, ForwardPath) * 1.e-5f, 1.e-2f)))
+                    {
+                        NumMismatches++;
+                    }
+                }
+
+                UE_LOG(LogTemp, Log, TEXT("BenchmarkBidirectional: GridCount %d, %d queries %s | forward %.3f ms avg, %lld expanded | bidirectional %.3f ms avg, %lld expanded | %.2fx fewer expansions, speedup %.2fx | %d cost mismatches"),
+                    GridCount, NumQueries, ScenarioNames[Scenario],
+                    ForwardSeconds * 1000.0 / NumQueries, ForwardExpanded, BidirectionalSeconds * 1000.0 / NumQueries, BidirectionalExpanded,
+                    (double)ForwardExpanded / FMath::Max<int64>(BidirectionalExpanded, 1), ForwardSeconds / FMath::Max(BidirectionalSeconds, 1.e-9), NumMismatches);
+            }
+        }
+    }
+
+    static FAutoConsoleCommand BenchmarkBidirectionalCommand(
+        TEXT("Pathfinding.BenchmarkBidirectional"),
+        TEXT("Compares bidirectional A* with the forward search on random and long queries. Usage: Pathfinding.BenchmarkBidirectional [NumQueries] [GridCount...] (defaults: 100 queries at 100 300 1000)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunBidirectionalBenchmark));
+
+    // Pathfinding.CheckBidirectional [NumMaps] [NumQueries]
+    static void RunBidirectionalCheck(const TArray<FString>& Args)
+    {
+        const int32 NumMaps = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 50;
+        const int32 NumQueries = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 200;
+
+        FRandomStream Random(NumMaps);
+        FPathSearchContext Context;
+        FPathSearchContext ReverseContext;
+        TArray<int32> ForwardPath;
+        TArray<int32> BidirectionalPath;
+        int32 NumFound = 0;
+        int32 NumFailures = 0;
+
+        for (int32 Map = 0; Map < NumMaps; Map++)
+        {
+            // Every map gets its own size and obstacle density, from open fields to mazes split into pockets,
+            // and every third map only uses two weights so that many paths tie
+            FGridNodeStore Nodes;
+            Nodes.Build(Random.RandRange(2, 120));
+            const float ObstacleChance = Random.FRandRange(0.0f, 0.45f);
+            const bool bFewWeights = Map % 3 == 0;
+            for (int32 Index = 0; Index < Nodes.Num(); Index++)
+            {
+                Nodes.Obstacles[Index] = Random.FRand() < ObstacleChance;
+                Nodes.Weights[Index] = bFewWeights ? (float)Random.RandRange(1, 2) : Random.FRandRange(1.0f, 5.0f);
+            }
+
+            for (int32 Query = 0; Query < NumQueries; Query++)
+            {
+                // Includes starts on obstacles and queries from a tile to itself
+                const int32 StartIndex = Random.RandRange(0, Nodes.Num() - 1);
+                const int32 GoalIndex = Query % 10 == 0 ? StartIndex : Random.RandRange(0, Nodes.Num() - 1);
+
+                const bool bForwardFound = Nodes.FindPath(StartIndex, GoalIndex, Context, ForwardPath);
+                const bool bBidirectionalFound = Nodes.FindPathBidirectional(StartIndex, GoalIndex, Context, ReverseContext, BidirectionalPath);
+                NumFound += bForwardFound ? 1 : 0;
+
+                // The path must be a chain of open neighbors from start to goal, and cost the same as the forward one
+                bool bValid = bForwardFound == bBidirectionalFound;
+                if (bValid && bBidirectionalFound)
+                {
+                    bValid = BidirectionalPath[0] == StartIndex && BidirectionalPath.Last() == GoalIndex;
+                    for (int32 i = 1; bValid && i < BidirectionalPath.Num(); i++)
+                    {
+                        bValid = !Nodes.Obstacles[BidirectionalPath[i]] && Nodes.GetNeighbors(BidirectionalPath[i - 1]).Contains(BidirectionalPath[i]);
+                    }
+
+                    const float ForwardCost = GetPathCost(Nodes, ForwardPath);
+                    bValid = bValid && FMath::IsNearlyEqual(ForwardCost, GetPathCost(Nodes, BidirectionalPath), FMath::Max(ForwardCost * 1.e-5f, 1.e-2f));
+                }
+
+                if (!bValid)
+                {
+                    if (NumFailures++ < 10)
+                    {
+                        UE_LOG(LogTemp, Error, TEXT("CheckBidirectional: map %d (GridCount %d), %d -> %d: forward %s cost %.3f, bidirectional %s cost %.3f"),
+                            Map, Nodes.GetGridCount(), StartIndex, GoalIndex,
+                            bForwardFound ? TEXT("found") : TEXT("no path"), GetPathCost(Nodes, ForwardPath),
+                            bBidirectionalFound ? TEXT("found") : TEXT("no path"), GetPathCost(Nodes, BidirectionalPath));
+                    }
+                }
+            }
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("CheckBidirectional: %d maps, %d queries (%d reachable), %d failures"),
+            NumMaps, NumMaps * NumQueries, NumFound, NumFailures);
+    }
+
+    static FAutoConsoleCommand CheckBidirectionalCommand(
+        TEXT("Pathfinding.CheckBidirectional"),
+        TEXT("Runs random queries on random maps and checks that bidirectional A* finds valid paths of the same cost as the forward search. Usage: Pathfinding.CheckBidirectional [NumMaps] [NumQueries] (defaults: 50 200)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunBidirectionalCheck));
+
+    // Pathfinding.BenchmarkFlowField [GridCount] [NumAgents] [NumEdits]
+    static void RunFlowFieldBenchmark(const TArray<FString>& Args)
+    {
+        const int32 GridCount = Args.Num() > 0 ? FMath::Max(2, FCString::Atoi(*Args[0])) : 300;
+        const int32 NumAgents = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100;
+        const int32 NumEdits = Args.Num() > 2 ? FMath::Max(1, FCString::Atoi(*Args[2])) : 50;
+
+        FGridNodeStore Nodes;
+        Nodes.Build(GridCount);
+        FRandomStream Random(GridCount);
+        for (int32 Index = 0; Index < Nodes.Num(); Index++)
+        {
+            Nodes.Obstacles[Index] = Random.FRand() < 0.2f;
+        }
+
+        // Every agent heads for the middle of the grid
+        const int32 GoalIndex = Nodes.GetIndex(GridCount / 2, GridCount / 2);
+        Nodes.Obstacles[GoalIndex] = false;
+        TArray<int32> AgentStarts;
+        for (int32 Agent = 0; Agent < NumAgents; Agent++)
+        {
+            AgentStarts.Add(Random.RandRange(0, Nodes.Num() - 1));
+        }
+
+        FPathSearchContext Context;
+        TArray<int32> Path;
+        double StartTime = FPlatformTime::Seconds();
+        TArray<float> SearchCosts;
+        for (int32 StartIndex : AgentStarts)
+        {
+            SearchCosts.Add(Nodes.FindPath(StartIndex, GoalIndex, Context, Path) ? GetPathCost(Nodes, Path) : -1.0f);
+        }
+        const double SearchSeconds = FPlatformTime::Seconds() - StartTime;
+
+        FFlowField FlowField;
+        StartTime = FPlatformTime::Seconds();
+        FlowField.Build(Nodes, GoalIndex);
+        const double BuildSeconds = FPlatformTime::Seconds() - StartTime;
+
+        // Each agent walks the field to the goal, which is what units do one step at a time
+        StartTime = FPlatformTime::Seconds();
+        int32 NumMismatches = 0;
+        for (int32 Agent = 0; Agent < NumAgents; Agent++)
+        {
+            const float FieldCost = FlowField.GetPath(AgentStarts[Agent], Path) ? GetPathCost(Nodes, Path) : -1.0f;
+            if (!FMath::IsNearlyEqual(FieldCost, SearchCosts[Agent], FMath::Max(SearchCosts[Agent] * 1.e-5f, 1.e-2f)))
+            {
+                NumMismatches++;
+            }
+        }
+        const double WalkSeconds = FPlatformTime::Seconds() - StartTime;
+
+        UE_LOG(LogTemp, Log, TEXT("BenchmarkFlowField: GridCount %d, %d agents | %d A* queries %.3f ms | flow field build %.3f ms (%.1f KB) + walking every path %.3f ms | speedup %.1fx | %d cost mismatches"),
+            GridCount, NumAgents, NumAgents, SearchSeconds * 1000.0, BuildSeconds * 1000.0, FlowField.GetAllocatedSize() / 1024.0, WalkSeconds * 1000.0,
+            SearchSeconds / FMath::Max(BuildSeconds + WalkSeconds, 1.e-9), NumMismatches);
+
+        // Single tile edits against rebuilding the field from scratch
+        double UpdateSeconds = 0.0;
+        int64 UpdateExpanded = 0;
+        int32 NumRepairMismatches = 0;
+        FFlowField FreshField;
+        for (int32 Edit = 0; Edit < NumEdits; Edit++)
+        {
+            const int32 Tile = Random.RandRange(0, Nodes.Num() - 1);
+            if (Tile == GoalIndex)
+            {
+                continue;
+            }
+            Nodes.Obstacles[Tile] = !Nodes.Obstacles[Tile];
+            FlowField.NotifyNodeChanged(Tile);
+
+            StartTime = FPlatformTime::Seconds();
+            FlowField.Update();
+            UpdateSeconds += FPlatformTime::Seconds() - StartTime;
+            UpdateExpanded += FlowField.NumExpanded;
+
+            FreshField.Build(Nodes, GoalIndex);
+            for (int32 Index = 0; Index < Nodes.Num(); Index++)
+            {
+                if (!FMath::IsNearlyEqual(FlowField.GetDistance(Index), FreshField.GetDistance(Index), FMath::Max(FreshField.GetDistance(Index) * 1.e-5f, 1.e-2f)))
+                {
+                    NumRepairMismatches++;
+                    break;
+                }
+            }
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("BenchmarkFlowField: %d single-tile edits | repair %.3f ms avg, %lld tiles settled avg | full build %.3f ms, %d tiles | %d repaired fields differ from a fresh build"),
+            NumEdits, UpdateSeconds * 1000.0 / NumEdits, UpdateExpanded / NumEdits, BuildSeconds * 1000.0, Nodes.Num(), NumRepairMismatches);
+    }
+
+    static FAutoConsoleCommand BenchmarkFlowFieldCommand(
+        TEXT("Pathfinding.BenchmarkFlowField"),
+        TEXT("Compares one flow field with an A* query per agent towards the same goal, and times repairs after tile edits. Usage: Pathfinding.BenchmarkFlowField [GridCount] [NumAgents] [NumEdits] (defaults: 300 100 50)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunFlowFieldBenchmark));
+
+    // Pathfinding.BenchmarkFixedPoint [NumQueries] [GridCount...]
+    static void RunFixedPointBenchmark(const TArray<FString>& Args)
+    {
+        const int32 NumQueries = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100;
+        TArray<int32> GridCounts;
+        for (int32 i = 1; i < Args.Num(); i++)
+        {
+            GridCounts.Add(FMath::Max(2, FCString::Atoi(*Args[i])));
+        }
+        if (GridCounts.Num() == 0)
+        {
+            GridCounts = { 100, 300, 1000 };
+        }
+
+        for (int32 GridCount : GridCounts)
+        {
+            // The grid's own random weights, then whole-number weights like the labels show. Fixed point loses nothing
+            // to rounding on the latter, so any difference left there comes from the float search's own rounding.
+            for (int32 WeightMode = 0; WeightMode < 2; WeightMode++)
+            {
+                FGridNodeStore Nodes;
+                Nodes.Build(GridCount);
+                FRandomStream Random(GridCount);
+                for (int32 Index = 0; Index < Nodes.Num(); Index++)
+                {
+                    Nodes.Obstacles[Index] = Random.FRand() < 0.2f;
+                    Nodes.Weights[Index] = WeightMode == 0 ? Random.FRandRange(1.0f, 5.0f) : (float)Random.RandRange(1, 5);
+                }
+                Nodes.UpdateStepCosts();
+
+                FPathSearchContext Context;
+                TArray<int32> FloatPath;
+                TArray<int32> FixedPath;
+                double FloatSeconds = 0.0;
+                double FixedSeconds = 0.0;
+                int64 FloatExpanded = 0;
+                int64 FixedExpanded = 0;
+                int32 NumCompared = 0;
+                int32 NumEqual = 0;
+                int32 NumMismatches = 0;
+                double MaxCostDifference = 0.0;
+
+                for (int32 Query = 0; Query < NumQueries; Query++)
+                {
+                    const int32 StartIndex = Random.RandRange(0, Nodes.Num() - 1);
+                    const int32 GoalIndex = Random.RandRange(0, Nodes.Num() - 1);
+
+                    double StartTime = FPlatformTime::Seconds();
+                    const bool bFloatFound = Nodes.FindPath(StartIndex, GoalIndex, Context, FloatPath);
+                    FloatSeconds += FPlatformTime::Seconds() - StartTime;
+                    FloatExpanded += Context.NumExpanded;
+
+                    StartTime = FPlatformTime::Seconds();
+                    const bool bFixedFound = Nodes.FindPathFixedPoint(StartIndex, GoalIndex, Context, FixedPath);
+                    FixedSeconds += FPlatformTime::Seconds() - StartTime;
+                    FixedExpanded += Context.NumExpanded;
+
+                    // Both paths are measured with the float costs, which is what the rounding can make slightly worse
+                    if (bFloatFound != bFixedFound)
+                    {
+                        NumMismatches++;
+                    }
+                    else if (bFloatFound)
+                    {
+                        const float FloatCost = GetPathCost(Nodes, FloatPath);
+                        const float FixedCost = GetPathCost(Nodes, FixedPath);
+                        NumEqual += FMath::IsNearlyEqual(FloatCost, FixedCost, FMath::Max(FloatCost * 1.e-6f, 1.e-3f)) ? 1 : 0;
+                        MaxCostDifference = FMath::Max(MaxCostDifference, (double)(FixedCost - FloatCost) / FMath::Max(FloatCost, 1.0f));
+                        NumCompared++;
+                    }
+                }
+
+                UE_LOG(LogTemp, Log, TEXT("BenchmarkFixedPoint: GridCount %d, %s weights, %d queries | float %.3f ms avg, %.2f M expansions/s (%lld expanded) | fixed point %.3f ms avg, %.2f M expansions/s (%lld expanded) | speedup %.2fx | %d of %d path costs equal, worst %.4f%% higher | %d reachability mismatches"),
+                    GridCount, WeightMode == 0 ? TEXT("random") : TEXT("whole-number"), NumQueries,
+                    FloatSeconds * 1000.0 / NumQueries, FloatExpanded / FMath::Max(FloatSeconds, 1.e-9) / 1.e6, FloatExpanded,
+                    FixedSeconds * 1000.0 / NumQueries, FixedExpanded / FMath::Max(FixedSeconds, 1.e-9) / 1.e6, FixedExpanded,
+                    FloatSeconds / FMath::Max(FixedSeconds, 1.e-9), NumEqual, NumCompared, MaxCostDifference * 100.0, NumMismatches);
+            }
+        }
+    }
+
+    static FAutoConsoleCommand BenchmarkFixedPointCommand(
+        TEXT("Pathfinding.BenchmarkFixedPoint"),
+        TEXT("Compares the integer hex-distance search with the float A* for speed and path cost. Usage: Pathfinding.BenchmarkFixedPoint [NumQueries] [GridCount...] (defaults: 100 queries at 100 300 1000)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunFixedPointBenchmark));
+
+    // Pathfinding.BenchmarkLandmarks [GridCount] [NumQueries] [NumLandmarks]
+    static void RunLandmarkBenchmark(const TArray<FString>& Args)
+    {
+        const int32 GridCount = Args.Num() > 0 ? FMath::Max(2, FCString::Atoi(*Args[0])) : 300;
+        const int32 NumQueries = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100;
+        const int32 NumLandmarks = Args.Num() > 2 ? FMath::Max(1, FCString::Atoi(*Args[2])) : 8;
+
+        const TCHAR* MapNames[] = { TEXT("random weights"), TEXT("maze") };
+        for (int32 MapType = 0; MapType < UE_ARRAY_COUNT(MapNames); MapType++)
+        {
+            FGridNodeStore Nodes;
+            Nodes.Build(GridCount);
+            FRandomStream Random(GridCount);
+            for (int32 Index = 0; Index < Nodes.Num(); Index++)
+            {
+                const int32 X = Nodes.GetGridX(Index);
+                const int32 Y = Nodes.GetGridY(Index);
+                if (MapType == 0)
+                {
+                    // The grid's own random weights, with scattered obstacles
+                    Nodes.Obstacles[Index] = Random.FRand() < 0.2f;
+                }
+                else
+                {
+                    // Walls every eight rows and columns with a few gaps, so most paths have to wind around
+                    Nodes.Weights[Index] = 1.0f;
+                    Nodes.Obstacles[Index] = (X % 8 == 0 || Y % 8 == 0) && Random.FRand() < 0.9f;
+                }
+            }
+
+            FLandmarkHeuristic Landmarks;
+            Landmarks.Build(Nodes, NumLandmarks);
+
+            FPathSearchContext Context;
+            TArray<int32> AStarPath;
+            TArray<int32> LandmarkPath;
+            double AStarSeconds = 0.0;
+            double LandmarkSeconds = 0.0;
+            int64 AStarExpanded = 0;
+            int64 LandmarkExpanded = 0;
+            int32 NumMismatches = 0;
+
+            for (int32 Query = 0; Query < NumQueries; Query++)
+            {
+                const int32 StartIndex = Random.RandRange(0, Nodes.Num() - 1);
+                const int32 GoalIndex = Random.RandRange(0, Nodes.Num() - 1);
+
+                double StartTime = FPlatformTime::Seconds();
+                const bool bAStarFound = Nodes.FindPath(StartIndex, GoalIndex, Context, AStarPath);
+                AStarSeconds += FPlatformTime::Seconds() - StartTime;
+                AStarExpanded += Context.NumExpanded;
+
+                StartTime = FPlatformTime::Seconds();
+                const bool bLandmarkFound = Nodes.FindPath(StartIndex, GoalIndex, Context, LandmarkPath, &Landmarks);
+                LandmarkSeconds += FPlatformTime::Seconds() - StartTime;
+                LandmarkExpanded += Context.NumExpanded;
+
+                // Both heuristics never overestimate, so the costs only differ by float rounding
+                if (bAStarFound != bLandmarkFound ||
+                    !FMath::IsNearlyEqual(GetPathCost(Nodes, AStarPath), GetPathCost(Nodes, LandmarkPath), FMath::Max(GetPathCost(Nodes, AStarPath) * 1.e-4f, 1.e-2f)))
+                {
+                    NumMismatches++;
+                }
+            }
+
+            UE_LOG(LogTemp, Log, TEXT("BenchmarkLandmarks: %s map, GridCount %d, %d landmarks | preprocessing %.1f ms, %.1f KB per landmark | A* %.3f ms avg, %lld expanded | ALT %.3f ms avg, %lld expanded | %.1fx fewer expansions, speedup %.1fx | %d cost mismatches"),
+                MapNames[MapType], GridCount, Landmarks.GetLandmarks().Num(), Landmarks.BuildSeconds * 1000.0, Landmarks.GetAllocatedSizePerLandmark() / 1024.0,
+                AStarSeconds * 1000.0 / NumQueries, AStarExpanded, LandmarkSeconds * 1000.0 / NumQueries, LandmarkExpanded,
+                (double)AStarExpanded / FMath::Max<int64>(LandmarkExpanded, 1), AStarSeconds / FMath::Max(LandmarkSeconds, 1.e-9), NumMismatches);
+
+            // A handful of obstacle edits between queries, the way the level makes them, including one on a landmark
+            const int32 NumEditRounds = 20;
+            double UpdateSeconds = 0.0;
+            int32 NumEditMismatches = 0;
+            for (int32 Round = 0; Round < NumEditRounds; Round++)
+            {
+                for (int32 Edit = 0; Edit < 4; Edit++)
+                {
+                    const int32 Index = Edit == 0 && Round % 5 == 0 ? Landmarks.GetLandmarks()[Round % Landmarks.GetLandmarks().Num()] : Random.RandRange(0, Nodes.Num() - 1);
+                    Nodes.Obstacles[Index] = !Nodes.Obstacles[Index];
+                    Landmarks.NotifyNodeChanged(Index);
+                }
+
+                const double StartTime = FPlatformTime::Seconds();
+                Landmarks.Update();
+                UpdateSeconds += FPlatformTime::Seconds() - StartTime;
+
+                const int32 StartIndex = Random.RandRange(0, Nodes.Num() - 1);
+                const int32 GoalIndex = Random.RandRange(0, Nodes.Num() - 1);
+                const bool bAStarFound = Nodes.FindPath(StartIndex, GoalIndex, Context, AStarPath);
+                const bool bLandmarkFound = Nodes.FindPath(StartIndex, GoalIndex, Context, LandmarkPath, &Landmarks);
+                if (bAStarFound != bLandmarkFound ||
+                    !FMath::IsNearlyEqual(GetPathCost(Nodes, AStarPath), GetPathCost(Nodes, LandmarkPath), FMath::Max(GetPathCost(Nodes, AStarPath) * 1.e-4f, 1.e-2f)))
+                {
+                    NumEditMismatches++;
+                }
+            }
+            UE_LOG(LogTemp, Log, TEXT("BenchmarkLandmarks: %s map, repair after 4 edits %.2f ms avg, against %.1f ms for preprocessing | %d cost mismatches after edits"),
+                MapNames[MapType], UpdateSeconds * 1000.0 / NumEditRounds, Landmarks.BuildSeconds * 1000.0, NumEditMismatches);
+        }
+    }
+
+    static FAutoConsoleCommand BenchmarkLandmarksCommand(
+        TEXT("Pathfinding.BenchmarkLandmarks"),
+        TEXT("Reports landmark preprocessing time and memory, and compares ALT with plain A* on weighted and maze maps. Usage: Pathfinding.BenchmarkLandmarks [GridCount] [NumQueries] [NumLandmarks] (defaults: 300 100 8)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunLandmarkBenchmark));
+
+    // Pathfinding.BenchmarkPathDatabase [GridCount] [NumQueries]
+    static void RunPathDatabaseBenchmark(const TArray<FString>& Args)
+    {
+        const int32 GridCount = Args.Num() > 0 ? FMath::Max(2, FCString::Atoi(*Args[0])) : 100;
+        const int32 NumQueries = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 1000;
+
+        const TCHAR* MapNames[] = { TEXT("random weights"), TEXT("maze") };
+        for (int32 MapType = 0; MapType < UE_ARRAY_COUNT(MapNames); MapType++)
+        {
+            FGridNodeStore Nodes;
+            Nodes.Build(GridCount);
+            FRandomStream Random(GridCount);
+            for (int32 Index = 0; Index < Nodes.Num(); Index++)
+            {
+                const int32 X = Nodes.GetGridX(Index);
+                const int32 Y = Nodes.GetGridY(Index);
+                if (MapType == 0)
+                {
+                    Nodes.Obstacles[Index] = Random.FRand() < 0.2f;
+                }
+                else
+                {
+                    Nodes.Weights[Index] = 1.0f;
+                    Nodes.Obstacles[Index] = (X % 8 == 0 || Y % 8 == 0) && Random.FRand() < 0.9f;
+                }
+            }
+
+            FCompressedPathDatabase Database;
+            Database.Build(Nodes);
+
+            // Round trip through the blob, and query the loaded copy so the benchmark also covers loading
+            TArray<uint8> Blob;
+            Database.SaveToBlob(Blob);
+            FCompressedPathDatabase Loaded;
+            const bool bLoaded = Loaded.LoadFromBlob(Blob) && Loaded.IsBuiltFor(Nodes);
+            if (!bLoaded)
+            {
+                UE_LOG(LogTemp, Error, TEXT("BenchmarkPathDatabase: the saved database did not load back for its own grid"));
+                continue;
+            }
+
+            FPathSearchContext Context;
+            TArray<int32> AStarPath;
+            TArray<int32> DatabasePath;
+            double AStarSeconds = 0.0;
+            double DatabaseSeconds = 0.0;
+            int32 NumMismatches = 0;
+
+            for (int32 Query = 0; Query < NumQueries; Query++)
+            {
+                const int32 StartIndex = Random.RandRange(0, Nodes.Num() - 1);
+                const int32 GoalIndex = Random.RandRange(0, Nodes.Num() - 1);
+
+                double StartTime = FPlatformTime::Seconds();
+                const bool bAStarFound = Nodes.FindPath(StartIndex, GoalIndex, Context, AStarPath);
+                AStarSeconds += FPlatformTime::Seconds() - StartTime;
+
+                StartTime = FPlatformTime::Seconds();
+                const bool bDatabaseFound = Loaded.FindPath(Nodes, StartIndex, GoalIndex, DatabasePath);
+                DatabaseSeconds += FPlatformTime::Seconds() - StartTime;
+
+                // Both follow cheapest paths, so the costs only differ by float rounding
+                if (bAStarFound != bDatabaseFound ||
+                    !FMath::IsNearlyEqual(GetPathCost(Nodes, AStarPath), GetPathCost(Nodes, DatabasePath), FMath::Max(GetPathCost(Nodes, AStarPath) * 1.e-4f, 1.e-2f)))
+                {
+                    NumMismatches++;
+                }
+            }
+
+            // An uncompressed table would hold three bits per pair of tiles
+            const double UncompressedBytes = (double)Nodes.Num() * Nodes.Num() * 3.0 / 8.0;
+            UE_LOG(LogTemp, Log, TEXT("BenchmarkPathDatabase: %s map, GridCount %d | build %.2f s, %d runs (%.1f per tile), %.1f KB in memory, %.1f KB blob, %.1fx smaller than an uncompressed table | A* %.3f us avg | database %.3f us avg | speedup %.1fx, %d cost mismatches"),
+                MapNames[MapType], GridCount, Database.BuildSeconds, Database.GetNumRuns(), (double)Database.GetNumRuns() / Nodes.Num(),
+                Loaded.GetAllocatedSize() / 1024.0, Blob.Num() / 1024.0, UncompressedBytes / FMath::Max<SIZE_T>(Loaded.GetAllocatedSize(), 1),
+                AStarSeconds * 1.e6 / NumQueries, DatabaseSeconds * 1.e6 / NumQueries, AStarSeconds / FMath::Max(DatabaseSeconds, 1.e-9), NumMismatches);
+        }
+    }
+
+    static FAutoConsoleCommand BenchmarkPathDatabaseCommand(
+        TEXT("Pathfinding.BenchmarkPathDatabase"),
+        TEXT("Reports build time and memory of the compressed path database, and compares its query latency with A*. Usage: Pathfinding.BenchmarkPathDatabase [GridCount] [NumQueries] (defaults: 100 1000)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunPathDatabaseBenchmark));
+
+    // Pathfinding.BenchmarkGridGeneration [NumRuns] [GridCount...]
+    static void RunGridGenerationBenchmark(const TArray<FString>& Args)
+    {
+        const int32 NumRuns = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 5;
+        TArray<int32> GridCounts;
+        for (int32 i = 1; i < Args.Num(); i++)
+        {
+            GridCounts.Add(FMath::Max(2, FCString::Atoi(*Args[i])));
+        }
+        if (GridCounts.Num() == 0)
+        {
+            GridCounts = { 100, 300, 1000 };
+        }
+
+        for (int32 GridCount : GridCounts)
+        {
+            // Regenerating reuses the arrays, like AGrid does on every slider move, so each store is built once before timing
+            FGridNodeStore SerialNodes;
+            FGridNodeStore ParallelNodes;
+            SerialNodes.Build(GridCount, EParallelForFlags::ForceSingleThread);
+            ParallelNodes.Build(GridCount);
+
+            double SerialSeconds = 0.0;
+            double ParallelSeconds = 0.0;
+            double TransformSeconds = 0.0;
+            TArray<FTransform> TileTransforms;
+            for (int32 Run = 0; Run < NumRuns; Run++)
+            {
+                double StartTime = FPlatformTime::Seconds();
+                SerialNodes.Build(GridCount, EParallelForFlags::ForceSingleThread);
+                SerialSeconds += FPlatformTime::Seconds() - StartTime;
+
+                StartTime = FPlatformTime::Seconds();
+                ParallelNodes.Build(GridCount);
+                ParallelSeconds += FPlatformTime::Seconds() - StartTime;
+
+                // The instance transforms AGrid::GenerateGrid hands to AddInstances
+                StartTime = FPlatformTime::Seconds();
+                TileTransforms.SetNumUninitialized(ParallelNodes.Num());
+                ParallelFor(ParallelNodes.Num(), [&ParallelNodes, &TileTransforms](int32 NodeIndex)
+                {
+                    TileTransforms[NodeIndex] = FTransform(FRotator::ZeroRotator, ParallelNodes.Positions[NodeIndex]);
+                });
+                TransformSeconds += FPlatformTime::Seconds() - StartTime;
+            }
+
+            const bool bSameLayout = SerialNodes.Positions == ParallelNodes.Positions && SerialNodes.Neighbors == ParallelNodes.Neighbors;
+            UE_LOG(LogTemp, Log, TEXT("BenchmarkGridGeneration: GridCount %d (%d tiles), %d runs | node layout single-threaded %.2f ms, parallel %.2f ms, speedup %.1fx | tile transforms %.2f ms | %s"),
+                GridCount, ParallelNodes.Num(), NumRuns, SerialSeconds * 1000.0 / NumRuns, ParallelSeconds * 1000.0 / NumRuns,
+                SerialSeconds / FMath::Max(ParallelSeconds, 1.e-9), TransformSeconds * 1000.0 / NumRuns,
+                bSameLayout ? TEXT("layouts match") : TEXT("LAYOUTS DIFFER"));
+        }
+    }
+
+    static FAutoConsoleCommand BenchmarkGridGenerationCommand(
+        TEXT("Pathfinding.BenchmarkGridGeneration"),
+        TEXT("Times the node layout on one thread and in parallel, and the tile transform pass. The instance upload is logged by AGrid::GenerateGrid. Usage: Pathfinding.BenchmarkGridGeneration [NumRuns] [GridCount...] (defaults: 5 runs at 100 300 1000)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunGridGenerationBenchmark));
+
+    // Pathfinding.BenchmarkGridFile [GridCount] [NumRuns]
+    static void RunGridFileBenchmark(const TArray<FString>& Args)
+    {
+        const int32 GridCount = Args.Num() > 0 ? FMath::Max(2, FCString::Atoi(*Args[0])) : 2048;
+        const int32 NumRuns = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 3;
+
+        FGridNodeStore Source;
+        Source.Build(GridCount, GridCount);
+        FRandomStream Random(GridCount);
+        for (int32 Index = 0; Index < Source.Num(); Index++)
+        {
+            Source.Obstacles[Index] = Random.FRand() < 0.2f;
+        }
+        FGridFile::QuantizeWeights(Source);
+
+        const FString PlainFile = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("BenchmarkGrid.hexgrid");
+        const FString NeighborFile = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("BenchmarkGridNeighbors.hexgrid");
+        if (!FGridFile::Save(PlainFile, Source) || !FGridFile::Save(NeighborFile, Source, FGridFile::WithNeighbors))
+        {
+            UE_LOG(LogTemp, Error, TEXT("BenchmarkGridFile: could not write the grid files to %s"), *FPaths::GetPath(PlainFile));
+            return;
+        }
+
+        // Each store is filled once before timing, so every run reuses its arrays like regenerating a grid does.
+        // The files were just written, so they load from the page cache; a cold start adds the disk reads.
+        FGridNodeStore Generated;
+        FGridNodeStore Loaded;
+        FGridNodeStore LoadedWithNeighbors;
+        Generated.Build(GridCount, GridCount);
+        double GenerateSeconds = 0.0;
+        double LoadSeconds = 0.0;
+        double LoadWithNeighborsSeconds = 0.0;
+        bool bLoaded = true;
+        for (int32 Run = 0; Run < NumRuns; Run++)
+        {
+            double StartTime = FPlatformTime::Seconds();
+            Generated.Build(GridCount, GridCount);
+            GenerateSeconds += FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            bLoaded &= FGridFile::Load(PlainFile, Loaded);
+            LoadSeconds += FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            bLoaded &= FGridFile::Load(NeighborFile, LoadedWithNeighbors);
+            LoadWithNeighborsSeconds += FPlatformTime::Seconds() - StartTime;
+        }
+
+        const bool bSameTiles = bLoaded && Loaded.Weights == Source.Weights && Loaded.Obstacles == Source.Obstacles && Loaded.Neighbors == Source.Neighbors
+            && LoadedWithNeighbors.Neighbors == Source.Neighbors && Loaded.MinStepCost == Source.MinStepCost;
+        UE_LOG(LogTemp, Log, TEXT("BenchmarkGridFile: GridCount %d (%d tiles), %d runs | Build %.2f ms | load %.2f ms from %.1f MB | load with neighbors %.2f ms from %.1f MB | %s"),
+            GridCount, Source.Num(), NumRuns, GenerateSeconds * 1000.0 / NumRuns,
+            LoadSeconds * 1000.0 / NumRuns, IFileManager::Get().FileSize(*PlainFile) / (1024.0 * 1024.0),
+            LoadWithNeighborsSeconds * 1000.0 / NumRuns, IFileManager::Get().FileSize(*NeighborFile) / (1024.0 * 1024.0),
+            bSameTiles ? TEXT("tiles match") : TEXT("TILES DIFFER"));
+    }
+
+    static FAutoConsoleCommand BenchmarkGridFileCommand(
+        TEXT("Pathfinding.BenchmarkGridFile"),
+        TEXT("Writes a grid to a grid file with and without its neighbor table, and times loading both against FGridNodeStore::Build, the data half of GenerateGrid. Usage: Pathfinding.BenchmarkGridFile [GridCount] [NumRuns] (defaults: 2048 3)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunGridFileBenchmark));
+
+    // Pathfinding.BenchmarkChunkWorld [ChunkSize] [BudgetMB] [NumQueries] [NumChunks...]
+    static void RunChunkWorldBenchmark(const TArray<FString>& Args)
+    {
+        const int32 ChunkSize = Args.Num() > 0 ? FMath::Max(2, FCString::Atoi(*Args[0])) : 128;
+        const int32 BudgetMB = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 64;
+        const int32 NumQueries = Args.Num() > 2 ? FMath::Max(1, FCString::Atoi(*Args[2])) : 200;
+        TArray<int32> ChunkCounts;
+        for (int32 i = 3; i < Args.Num(); i++)
+        {
+            ChunkCounts.Add(FMath::Max(1, FCString::Atoi(*Args[i])));
+        }
+        if (ChunkCounts.Num() == 0)
+        {
+            ChunkCounts = { 4, 8, 16 };
+        }
+
+        // The whole world held as one store would take about this much per chunk
+        FGridNodeStore OneChunk;
+        OneChunk.Build(ChunkSize, 0);
+        const double ChunkMB = OneChunk.GetAllocatedSize() / (1024.0 * 1024.0);
+
+        // The budget stays the same as the world grows, so resident memory should too; only the portal graph grows
+        for (int32 NumChunks : ChunkCounts)
+        {
+            FGridChunkWorld World;
+            World.Initialize(NumChunks, ChunkSize, FGridChunkWorld::MakeProceduralLoader(NumChunks, 0.2f), (SIZE_T)BudgetMB * 1024 * 1024);
+
+            FRandomStream Random(NumChunks);
+            TArray<FIntPoint> Path;
+            double TotalSeconds = 0.0;
+            double MaxSeconds = 0.0;
+            int32 NumFound = 0;
+            for (int32 Query = 0; Query < NumQueries; Query++)
+            {
+                const FIntPoint Start(Random.RandRange(0, World.GetWorldSize() - 1), Random.RandRange(0, World.GetWorldSize() - 1));
+                const FIntPoint Goal(Random.RandRange(0, World.GetWorldSize() - 1), Random.RandRange(0, World.GetWorldSize() - 1));
+
+                const double StartTime = FPlatformTime::Seconds();
+                NumFound += World.FindPath(Start, Goal, Path) ? 1 : 0;
+                const double QuerySeconds = FPlatformTime::Seconds() - StartTime;
+                TotalSeconds += QuerySeconds;
+                MaxSeconds = FMath::Max(MaxSeconds, QuerySeconds);
+            }
+
+            const FGridChunkWorldStats& Stats = World.GetStats();
+            UE_LOG(LogTemp, Log, TEXT("BenchmarkChunkWorld: %d x %d chunks of %d (%d tiles a side) | portal graph %d portals, %.1f KB, built in %.1f ms with %d loads | %d queries, %d found, %.2f ms avg, %.2f ms max | resident %.1f MB peak of %d MB budget, %.1f MB as one store | %d loads, %d evictions, %d hits"),
+                NumChunks, NumChunks, World.GetChunkSize(), World.GetWorldSize(), World.GetNumPortals(), World.GetPortalGraphSize() / 1024.0, World.BuildSeconds * 1000.0, Stats.NumBuildLoads,
+                NumQueries, NumFound, TotalSeconds * 1000.0 / NumQueries, MaxSeconds * 1000.0,
+                Stats.PeakResidentBytes / (1024.0 * 1024.0), BudgetMB, ChunkMB * NumChunks * NumChunks,
+                Stats.NumLoads, Stats.NumEvictions, Stats.NumHits);
+
+            // Nothing is pinned here, so the build and the queries must both have stayed within the budget, however
+            // large the world is. Only a budget smaller than one chunk may be exceeded.
+            if (Stats.PeakResidentBytes > World.GetMemoryBudget())
+            {
+                UE_LOG(LogTemp, Error, TEXT("BenchmarkChunkWorld: %d x %d chunks went over the budget, %.1f MB resident at peak of %d MB"),
+                    NumChunks, NumChunks, Stats.PeakResidentBytes / (1024.0 * 1024.0), BudgetMB);
+            }
+        }
+    }
+
+    static FAutoConsoleCommand BenchmarkChunkWorldCommand(
+        TEXT("Pathfinding.BenchmarkChunkWorld"),
+        TEXT("Runs random long queries on procedural chunked worlds of growing size under one memory budget, reports portal graph size, resident memory and chunk traffic, and logs an error if resident memory ever went over the budget. Usage: Pathfinding.BenchmarkChunkWorld [ChunkSize] [BudgetMB] [NumQueries] [NumChunks...] (defaults: 128 64 200 at 4 8 16)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunChunkWorldBenchmark));
+
+    // Pathfinding.BenchmarkConnectedComponents [GridCount] [NumEdits] [NumQueries]
+    static void RunConnectedComponentsBenchmark(const TArray<FString>& Args)
+    {
+        const int32 GridCount = Args.Num() > 0 ? FMath::Max(2, FCString::Atoi(*Args[0])) : 300;
+        const int32 NumEdits = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 2000;
+        const int32 NumQueries = Args.Num() > 2 ? FMath::Max(1, FCString::Atoi(*Args[2])) : 100;
+
+        // Dense enough that the grid breaks into many pockets, so edits both merge and split regions
+        FGridNodeStore Nodes;
+        Nodes.Build(GridCount, GridCount);
+        FRandomStream Random(GridCount);
+        for (int32 Index = 0; Index < Nodes.Num(); Index++)
+        {
+            Nodes.Obstacles[Index] = Random.FRand() < 0.4f;
+        }
+
+        FConnectedComponents Components;
+        double StartTime = FPlatformTime::Seconds();
+        Components.Build(Nodes);
+        const double BuildSeconds = FPlatformTime::Seconds() - StartTime;
+
+        // Every edit is repaired in place, and every so often the labels are compared with a fresh build
+        FConnectedComponents Reference;
+        double EditSeconds = 0.0;
+        double MaxEditSeconds = 0.0;
+        int64 NumVisited = 0;
+        int32 NumMismatches = 0;
+        for (int32 Edit = 0; Edit < NumEdits; Edit++)
+        {
+            const int32 Tile = Random.RandRange(0, Nodes.Num() - 1);
+            Nodes.Obstacles[Tile] = !Nodes.Obstacles[Tile];
+
+            StartTime = FPlatformTime::Seconds();
+            Components.NotifyNodeChanged(Tile);
+            const double Seconds = FPlatformTime::Seconds() - StartTime;
+            EditSeconds += Seconds;
+            MaxEditSeconds = FMath::Max(MaxEditSeconds, Seconds);
+            NumVisited += Components.NumVisited;
+
+            if (Edit % 100 == 99 || Edit == NumEdits - 1)
+            {
+                Reference.Build(Nodes);
+                bool bSame = Components.GetNumComponents() == Reference.GetNumComponents();
+                for (int32 Pair = 0; bSame && Pair < 1000; Pair++)
+                {
+                    const int32 A = Random.RandRange(0, Nodes.Num() - 1);
+                    const int32 B = Random.RandRange(0, Nodes.Num() - 1);
+                    bSame = Components.AreConnected(A, B) == Reference.AreConnected(A, B);
+                }
+                NumMismatches += bSame ? 0 : 1;
+            }
+        }
+
+        // What the labels save: queries towards goals the search cannot reach, which flood the whole start region
+        FPathSearchContext Context;
+        TArray<int32> Path;
+        double SearchSeconds = 0.0;
+        double LabelSeconds = 0.0;
+        int32 NumUnreachable = 0;
+        int32 NumDisagreements = 0;
+        for (int32 Query = 0; Query < NumQueries * 20 && NumUnreachable < NumQueries; Query++)
+        {
+            const int32 StartIndex = Random.RandRange(0, Nodes.Num() - 1);
+            const int32 GoalIndex = Random.RandRange(0, Nodes.Num() - 1);
+
+            StartTime = FPlatformTime::Seconds();
+            const bool bConnected = Components.AreConnected(StartIndex, GoalIndex);
+            const double QueryLabelSeconds = FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            const bool bFound = Nodes.FindPath(StartIndex, GoalIndex, Context, Path);
+            const double QuerySearchSeconds = FPlatformTime::Seconds() - StartTime;
+
+            NumDisagreements += bConnected != bFound ? 1 : 0;
+            if (!bFound)
+            {
+                SearchSeconds += QuerySearchSeconds;
+                LabelSeconds += QueryLabelSeconds;
+                NumUnreachable++;
+            }
+        }
+
+        UE_LOG(LogTemp, Log, TEXT("BenchmarkConnectedComponents: GridCount %d | build %.2f ms, %d regions, %.1f KB | %d edits, %.2f us avg, %.2f ms max, %.1f tiles visited avg | %d label mismatches against a rebuild"),
+            GridCount, BuildSeconds * 1000.0, Components.GetNumComponents(), Components.GetAllocatedSize() / 1024.0,
+            NumEdits, EditSeconds * 1.e6 / NumEdits, MaxEditSeconds * 1000.0, (double)NumVisited / NumEdits, NumMismatches);
+        UE_LOG(LogTemp, Log, TEXT("BenchmarkConnectedComponents: %d unreachable goals | A* %.3f ms avg to give up | labels %.3f us avg | %d disagreements with A*"),
+            NumUnreachable, NumUnreachable > 0 ? SearchSeconds * 1000.0 / NumUnreachable : 0.0, NumUnreachable > 0 ? LabelSeconds * 1.e6 / NumUnreachable : 0.0, NumDisagreements);
+    }
+
+    static FAutoConsoleCommand BenchmarkConnectedComponentsCommand(
+        TEXT("Pathfinding.BenchmarkConnectedComponents"),
+        TEXT("Times incremental region labeling under random obstacle edits, checks it against a fresh labeling and A*, and compares rejecting unreachable goals with the search. Usage: Pathfinding.BenchmarkConnectedComponents [GridCount] [NumEdits] [NumQueries] (defaults: 300 2000 100)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunConnectedComponentsBenchmark));
+
+    // Pathfinding.BenchmarkCooperative [Window] [NumAgents...]
+    static void RunCooperativeBenchmark(const TArray<FString>& Args)
+    {
+        const int32 Window = Args.Num() > 0 ? FMath::Max(2, FCString::Atoi(*Args[0])) : 16;
+        TArray<int32> AgentCounts;
+        for (int32 ArgIndex = 1; ArgIndex < Args.Num(); ArgIndex++)
+        {
+            AgentCounts.Add(FMath::Max(1, FCString::Atoi(*Args[ArgIndex])));
+        }
+        if (AgentCounts.Num() == 0)
+        {
+            AgentCounts = { 100, 1000, 10000 };
+        }
+
+        for (int32 NumAgents : AgentCounts)
+        {
+            // The grid grows with the units so the crowding stays the same: one unit for every 25 tiles
+            const int32 GridCount = FMath::CeilToInt(FMath::Sqrt(NumAgents * 25.0f));
+            FGridNodeStore Nodes;
+            Nodes.Build(GridCount, GridCount);
+            FRandomStream Random(NumAgents);
+            for (int32 Index = 0; Index < Nodes.Num(); Index++)
+            {
+                Nodes.Obstacles[Index] = Random.FRand() < 0.1f;
+            }
+
+            // Units move in squads of up to 50 from one area to another, so squads cross each other's paths and
+            // the units of a squad crowd around the same goal. Every squad shares the field towards its goal area.
+            constexpr int32 SquadSize = 50;
+            const int32 SquadRadius = 6;
+            TBitArray<> StartTaken(false, Nodes.Num());
+            TBitArray<> GoalTaken(false, Nodes.Num());
+            auto PickOpenTile = [&](const FIntPoint& Center, TBitArray<>& Taken)
+            {
+                for (int32 Attempt = 0; Attempt < 1000; Attempt++)
+                {
+                    const int32 X = FMath::Clamp(Center.X + Random.RandRange(-SquadRadius, SquadRadius), 0, GridCount - 1);
+                    const int32 Y = FMath::Clamp(Center.Y + Random.RandRange(-SquadRadius, SquadRadius), 0, GridCount - 1);
+                    const int32 Index = Nodes.GetIndex(X, Y);
+                    if (!Nodes.Obstacles[Index] && !Taken[Index])
+                    {
+                        Taken[Index] = true;
+                        return Index;
+                    }
+                }
+                return (int32)INDEX_NONE;
+            };
+
+            TArray<FCooperativeAgent> Agents;
+            Agents.Reserve(NumAgents);
+            while (Agents.Num() < NumAgents)
+            {
+                const FIntPoint StartCenter(Random.RandRange(0, GridCount - 1), Random.RandRange(0, GridCount - 1));
+                const FIntPoint GoalCenter(Random.RandRange(0, GridCount - 1), Random.RandRange(0, GridCount - 1));
+                const int32 GoalCenterIndex = Nodes.GetIndex(GoalCenter.X, GoalCenter.Y);
+                if (Nodes.Obstacles[GoalCenterIndex])
+                {
+                    continue;
+                }
+                for (int32 Member = 0; Member < SquadSize && Agents.Num() < NumAgents; Member++)
+                {
+                    FCooperativeAgent Agent;
+                    Agent.StartIndex = PickOpenTile(StartCenter, StartTaken);
+                    Agent.GoalIndex = PickOpenTile(GoalCenter, GoalTaken);
+                    Agent.HeuristicTile = GoalCenterIndex;
+                    if (Agent.StartIndex == INDEX_NONE || Agent.GoalIndex == INDEX_NONE)
+                    {
+                        break;
+                    }
+                    Agents.Add(Agent);
+                }
+            }
+
+            // Baseline: every unit follows its own shortest path as if it were alone
+            FPathSearchContext Context;
+            TArray<TArray<int32>> IndependentPaths;
+            IndependentPaths.SetNum(NumAgents);
+            double StartTime = FPlatformTime::Seconds();
+            for (int32 Agent = 0; Agent < NumAgents; Agent++)
+            {
+                if (!Nodes.FindPath(Agents[Agent].StartIndex, Agents[Agent].GoalIndex, Context, IndependentPaths[Agent]))
+                {
+                    IndependentPaths[Agent] = { Agents[Agent].StartIndex };
+                }
+            }
+            const double IndependentSeconds = FPlatformTime::Seconds() - StartTime;
+            const int32 IndependentCollisions = FCooperativePlanner::CountCollisions(IndependentPaths, Nodes.Num());
+
+            FCooperativePlanner Planner;
+            Planner.Initialize(Nodes, Agents, Window, Window / 2);
+            const int32 NumSteps = Planner.Run(8 * GridCount + Window);
+            const int32 CooperativeCollisions = FCooperativePlanner::CountCollisions(Planner.GetTrajectories(), Nodes.Num());
+
+            int32 NumArrived = 0;
+            int32 NumStranded = 0;
+            for (int32 Agent = 0; Agent < NumAgents; Agent++)
+            {
+                NumArrived += Planner.HasArrived(Agent) ? 1 : 0;
+                NumStranded += Planner.IsStranded(Agent) ? 1 : 0;
+            }
+
+            const int64 NumAgentSteps = FMath::Max<int64>((int64)NumAgents * NumSteps, 1);
+            UE_LOG(LogTemp, Log, TEXT("BenchmarkCooperative: %d units on GridCount %d, window %d | independent A* %.2f ms, %d collisions | cooperative %.2f ms planning (%.3f us per unit step), %.2f ms distance fields, %d collisions"),
+                NumAgents, GridCount, Window, IndependentSeconds * 1000.0, IndependentCollisions,
+                Planner.PlanSeconds * 1000.0, Planner.PlanSeconds * 1.e6 / NumAgentSteps, Planner.HeuristicSeconds * 1000.0, CooperativeCollisions);
+            UE_LOG(LogTemp, Log, TEXT("BenchmarkCooperative: %d units | %d arrived, %d unreachable, in %d steps | %.1f states expanded per unit step, %d partial plans"),
+                NumAgents, NumArrived, NumStranded, NumSteps, (double)Planner.NumExpanded / NumAgentSteps, Planner.NumFallbacks);
+        }
+    }
+
+    static FAutoConsoleCommand BenchmarkCooperativeCommand(
+        TEXT("Pathfinding.BenchmarkCooperative"),
+        TEXT("Moves squads of units across a grid at once with cooperative planning and reports planning time and collisions, against independent A* paths. Usage: Pathfinding.BenchmarkCooperative [Window] [NumAgents...] (defaults: 16 at 100 1000 10000)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunCooperativeBenchmark));
+
+    static FAutoConsoleCommand BenchmarkOpenSetCommand(
+        TEXT("Pathfinding.BenchmarkOpenSet"),
+        TEXT("Times the legacy linear-scan open set against the indexed heap. Usage: Pathfinding.BenchmarkOpenSet [NumQueries] [GridCount...] (defaults: 3 queries at 10 100 1000)"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunOpenSetBenchmark));
+}
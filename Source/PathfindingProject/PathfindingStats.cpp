@@ -0,0 +1,49 @@
+#include "PathfindingStats.h"
+#include "IndexedNodeHeap.h"
+
+DEFINE_LOG_CATEGORY(LogPathfinding);
+
+UE_TRACE_CHANNEL_DEFINE(PathfindingChannel);
+
+DEFINE_STAT(STAT_PathfindingSearch);
+DEFINE_STAT(STAT_PathfindingReset);
+DEFINE_STAT(STAT_PathfindingReconstruction);
+DEFINE_STAT(STAT_PathfindingDraw);
+
+DEFINE_STAT(STAT_PathfindingQueries);
+DEFINE_STAT(STAT_PathfindingNodesExpanded);
+DEFINE_STAT(STAT_PathfindingOpenSetPeak);
+DEFINE_STAT(STAT_PathfindingPathLength);
+
+DEFINE_STAT(STAT_PathfindingResidentChunks);
+DEFINE_STAT(STAT_PathfindingResidentChunkMemory);
+DEFINE_STAT(STAT_PathfindingChunkLoads);
+DEFINE_STAT(STAT_PathfindingChunkEvictions);
+
+FPathQueryStats::FPathQueryStats(const TArray<int32>& InPath)
+    : Path(InPath)
+{
+    INC_DWORD_STAT(STAT_PathfindingQueries);
+}
+
+FPathQueryStats::~FPathQueryStats()
+{
+    int32 NumExpanded = 0;
+    int32 OpenSetPeak = 0;
+    for (int32 Index = 0; Index < NumTracked; Index++)
+    {
+        NumExpanded += *ExpansionCounters[Index];
+        OpenSetPeak += OpenSets[Index] ? OpenSets[Index]->GetPeakNum() : 0;
+    }
+    INC_DWORD_STAT_BY(STAT_PathfindingNodesExpanded, NumExpanded);
+    SET_DWORD_STAT(STAT_PathfindingOpenSetPeak, OpenSetPeak);
+    SET_DWORD_STAT(STAT_PathfindingPathLength, Path.Num());
+}
+
+void FPathQueryStats::Track(const int32& NumExpanded, const FIndexedNodeHeap* OpenSet)
+{
+    check(NumTracked < UE_ARRAY_COUNT(ExpansionCounters));
+    ExpansionCounters[NumTracked] = &NumExpanded;
+    OpenSets[NumTracked] = OpenSet;
+    NumTracked++;
+}
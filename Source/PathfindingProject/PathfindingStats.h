@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+class FIndexedNodeHeap;
+
+/*
+ * Performance counters for the pathfinding code. "stat Pathfinding" shows the cycle counters and the per-frame
+ * query counters; running with -trace=cpu,Pathfinding shows every query as a timed event in Unreal Insights.
+ * Per-query and per-frame logging goes to LogPathfinding at Verbose, and per path segment at VeryVerbose, so it
+ * costs nothing unless turned on with "log LogPathfinding Verbose".
+ */
+DECLARE_LOG_CATEGORY_EXTERN(LogPathfinding, Log, All);
+
+UE_TRACE_CHANNEL_EXTERN(PathfindingChannel, PATHFINDINGPROJECT_API);
+
+DECLARE_STATS_GROUP(TEXT("Pathfinding"), STATGROUP_Pathfinding, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Search"), STAT_PathfindingSearch, STATGROUP_Pathfinding, PATHFINDINGPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Reset"), STAT_PathfindingReset, STATGROUP_Pathfinding, PATHFINDINGPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Reconstruction"), STAT_PathfindingReconstruction, STATGROUP_Pathfinding, PATHFINDINGPROJECT_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Draw"), STAT_PathfindingDraw, STATGROUP_Pathfinding, PATHFINDINGPROJECT_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries"), STAT_PathfindingQueries, STATGROUP_Pathfinding, PATHFINDINGPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Nodes Expanded"), STAT_PathfindingNodesExpanded, STATGROUP_Pathfinding, PATHFINDINGPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Open Set Peak (last query)"), STAT_PathfindingOpenSetPeak, STATGROUP_Pathfinding, PATHFINDINGPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Length (last query)"), STAT_PathfindingPathLength, STATGROUP_Pathfinding, PATHFINDINGPROJECT_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Resident Chunks"), STAT_PathfindingResidentChunks, STATGROUP_Pathfinding, PATHFINDINGPROJECT_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Resident Chunk Memory"), STAT_PathfindingResidentChunkMemory, STATGROUP_Pathfinding, PATHFINDINGPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Chunk Loads"), STAT_PathfindingChunkLoads, STATGROUP_Pathfinding, PATHFINDINGPROJECT_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Chunk Evictions"), STAT_PathfindingChunkEvictions, STATGROUP_Pathfinding, PATHFINDINGPROJECT_API);
+
+/*
+ * Counts one query for the stats. The searches it ran are registered with Track. When the query goes out of scope,
+ * whichever way it returns, their expansions are added to the frame's total and the open set peak and path length
+ * replace those of the previous query.
+ */
+struct PATHFINDINGPROJECT_API FPathQueryStats
+{
+    explicit FPathQueryStats(const TArray<int32>& InPath);
+    ~FPathQueryStats();
+
+    // Adds a search whose expansion count and open set are read at the end of the query. At most two per query.
+    void Track(const int32& NumExpanded, const FIndexedNodeHeap* OpenSet = nullptr);
+
+private:
+    const TArray<int32>& Path;
+    const int32* ExpansionCounters[2] = {};
+    const FIndexedNodeHeap* OpenSets[2] = {};
+    int32 NumTracked = 0;
+};
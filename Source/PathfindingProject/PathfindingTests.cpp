@@ -0,0 +1,153 @@
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "GridNodeStore.h"
+#include "PathSearchContext.h"
+#include "LandmarkHeuristic.h"
+#include "AllocationCounter.h"
+#include "GridChunkWorld.h"
+
+// Automation tests for the pathfinding code. Run them with "Automation RunTests Pathfinding" in the console or
+// -ExecCmds="Automation RunTests Pathfinding" on the command line.
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPathSearchAllocationTest, "Pathfinding.Search.WarmQueriesDoNotAllocate",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FPathSearchAllocationTest::RunTest(const FString& Parameters)
+{
+    constexpr int32 GridCount = 100;
+    constexpr int32 NumQueries = 100;
+
+    FGridNodeStore Nodes;
+    Nodes.Build(GridCount, GridCount);
+    FRandomStream Random(GridCount);
+    for (int32 Index = 0; Index < Nodes.Num(); Index++)
+    {
+        Nodes.Obstacles[Index] = Random.FRand() < 0.2f;
+    }
+
+    FLandmarkHeuristic Landmarks;
+    Landmarks.Build(Nodes, 8, 1);
+
+    // Endpoints on open tiles, so every query really searches
+    TArray<FIntPoint> Queries;
+    while (Queries.Num() < NumQueries)
+    {
+        const int32 StartIndex = Random.RandRange(0, Nodes.Num() - 1);
+        const int32 GoalIndex = Random.RandRange(0, Nodes.Num() - 1);
+        if (!Nodes.Obstacles[StartIndex] && !Nodes.Obstacles[GoalIndex])
+        {
+            Queries.Emplace(StartIndex, GoalIndex);
+        }
+    }
+
+    // Every search variant that runs on a caller's context. The first pass over the queries warms the contexts
+    // and the path buffer; the second runs the same queries and must not allocate anything at all.
+    FPathSearchContext Context;
+    FPathSearchContext ReverseContext;
+    TArray<int32> Path;
+    Path.Reserve(Nodes.Num());
+
+    struct FVariant
+    {
+        const TCHAR* Name;
+        TFunction<bool(int32, int32)> Search;
+    };
+    const FVariant Variants[] = {
+        { TEXT("AStar"), [&](int32 Start, int32 Goal) { return Nodes.FindPath(Start, Goal, Context, Path); } },
+        { TEXT("Landmarks"), [&](int32 Start, int32 Goal) { return Nodes.FindPath(Start, Goal, Context, Path, &Landmarks); } },
+        { TEXT("JumpPoint"), [&](int32 Start, int32 Goal) { return Nodes.FindPathJumpPoint(Start, Goal, Context, Path); } },
+        { TEXT("Bidirectional"), [&](int32 Start, int32 Goal) { return Nodes.FindPathBidirectional(Start, Goal, Context, ReverseContext, Path); } },
+        { TEXT("FixedPoint"), [&](int32 Start, int32 Goal) { return Nodes.FindPathFixedPoint(Start, Goal, Context, Path); } },
+    };
+
+    // While stats are collected, every cycle counter buffers a message until the next frame, which allocates on
+    // the searching thread. The searches are still run and compared then, but their allocations are not checked.
+    bool bCheckAllocations = true;
+#if STATS
+    if (FThreadStats::IsCollectingData())
+    {
+        AddWarning(TEXT("Stats are being collected, so allocations are not checked. Run with stats off to check them."));
+        bCheckAllocations = false;
+    }
+#endif
+
+    for (const FVariant& Variant : Variants)
+    {
+        int32 NumWarmFound = 0;
+        for (const FIntPoint& Query : Queries)
+        {
+            NumWarmFound += Variant.Search(Query.X, Query.Y) ? 1 : 0;
+        }
+
+        int32 NumFound = 0;
+        int64 NumAllocations = 0;
+        int64 NumBytes = 0;
+        {
+            FScopedAllocationCounter AllocationCounter;
+            for (const FIntPoint& Query : Queries)
+            {
+                NumFound += Variant.Search(Query.X, Query.Y) ? 1 : 0;
+            }
+            NumAllocations = AllocationCounter.GetNumAllocations();
+            NumBytes = AllocationCounter.GetNumBytes();
+        }
+
+        AddInfo(FString::Printf(TEXT("%s: %d of %d queries found a path, %lld allocations (%lld bytes) on warm contexts"),
+            Variant.Name, NumFound, NumQueries, NumAllocations, NumBytes));
+        TestEqual(FString::Printf(TEXT("%s finds the same paths when warm"), Variant.Name), NumFound, NumWarmFound);
+        if (bCheckAllocations)
+        {
+            TestEqual(FString::Printf(TEXT("%s heap allocations on warm contexts"), Variant.Name), NumAllocations, (int64)0);
+        }
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FChunkWorldBudgetTest, "Pathfinding.ChunkWorld.StaysWithinBudget",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FChunkWorldBudgetTest::RunTest(const FString& Parameters)
+{
+    constexpr int32 NumChunks = 8;
+    constexpr int32 ChunkSize = 32;
+    constexpr int32 NumQueries = 50;
+
+    // A budget of four chunks, for a world of sixty-four: far less than a column of chunks, so the build has to
+    // reload some and the queries have to evict
+    FGridNodeStore OneChunk;
+    OneChunk.Build(ChunkSize, 0);
+    const SIZE_T Budget = 4 * (OneChunk.GetAllocatedSize() + sizeof(FGridNodeStore) * 2);
+
+    FGridChunkWorld World;
+    World.Initialize(NumChunks, ChunkSize, FGridChunkWorld::MakeProceduralLoader(NumChunks, 0.2f), Budget);
+    TestTrue(TEXT("The portal graph has portals"), World.GetNumPortals() > 0);
+    TestTrue(TEXT("The build loads every chunk"), World.GetStats().NumBuildLoads >= NumChunks * NumChunks);
+
+    FRandomStream Random(NumChunks);
+    TArray<FIntPoint> Path;
+    int32 NumFound = 0;
+    for (int32 Query = 0; Query < NumQueries; Query++)
+    {
+        const FIntPoint Start(Random.RandRange(0, World.GetWorldSize() - 1), Random.RandRange(0, World.GetWorldSize() - 1));
+        const FIntPoint Goal(Random.RandRange(0, World.GetWorldSize() - 1), Random.RandRange(0, World.GetWorldSize() - 1));
+        if (World.FindPath(Start, Goal, Path))
+        {
+            NumFound++;
+            TestTrue(TEXT("A path runs from the start to the goal"), Path[0] == Start && Path.Last() == Goal);
+        }
+    }
+
+    const FGridChunkWorldStats& Stats = World.GetStats();
+    AddInfo(FString::Printf(TEXT("%d of %d queries found a path, %d build loads, %d loads, %d evictions, %.1f KB resident at peak of %.1f KB"),
+        NumFound, NumQueries, Stats.NumBuildLoads, Stats.NumLoads, Stats.NumEvictions, Stats.PeakResidentBytes / 1024.0, Budget / 1024.0));
+    TestTrue(TEXT("Some queries find a path"), NumFound > 0);
+    TestTrue(TEXT("Queries evict chunks"), Stats.NumEvictions > 0);
+    TestTrue(TEXT("Resident memory stays within the budget"), Stats.PeakResidentBytes <= Budget);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Per-tile array that copies of its owner share instead of duplicating, for tile data that stays the same for the
+ * life of a grid, like positions and adjacency. Copying a node store for a worker snapshot then only adds a
+ * reference to these arrays. Reads go straight to the elements, like a TArray's. Writes go through
+ * SetNumUninitialized and GetMutableData, which first give this owner its own elements if another one still shares
+ * them, so a snapshot never sees a later change. The reference count is thread safe, so snapshots may be released on any thread.
+ */
+template<typename ElementType>
+class TSharedTileArray
+{
+public:
+    TSharedTileArray()
+        : Array(MakeShared<TArray<ElementType>>())
+    {
+    }
+
+    const ElementType& operator[](int32 Index) const
+    {
+        checkSlow(Index >= 0 && Index < NumElements);
+        return Elements[Index];
+    }
+
+    int32 Num() const { return NumElements; }
+    bool IsValidIndex(int32 Index) const { return Index >= 0 && Index < NumElements; }
+    const ElementType* GetData() const { return Elements; }
+    const ElementType& Last() const { return (*this)[NumElements - 1]; }
+    SIZE_T GetAllocatedSize() const { return Array->GetAllocatedSize(); }
+
+    // The elements as a plain array, for code that takes one
+    operator const TArray<ElementType>&() const { return *Array; }
+
+    // Whether another owner holds the same elements
+    bool IsShared() const { return !Array.IsUnique(); }
+
+    bool operator==(const TSharedTileArray& Other) const { return Array == Other.Array || *Array == *Other.Array; }
+    bool operator!=(const TSharedTileArray& Other) const { return !(*this == Other); }
+
+    /* Resizes like TArray::SetNumUninitialized. New elements are left for the caller to fill in. If the elements are
+       shared, every element is left for the caller: this owner gets a fresh array instead of a copy, since rebuilding
+       the grid overwrites all of them anyway. */
+    void SetNumUninitialized(int32 NewNum)
+    {
+        if (!Array.IsUnique())
+        {
+            Array = MakeShared<TArray<ElementType>>();
+        }
+        Array->SetNumUninitialized(NewNum, false);
+        Refresh();
+    }
+
+    /* The elements for writing. Workers may write disjoint parts through the returned pointer in parallel, but this
+       has to be called before they start, since it may move the elements to a copy of their own. */
+    ElementType* GetMutableData()
+    {
+        Unshare();
+        Refresh();
+        return Array->GetData();
+    }
+
+private:
+    // Gives this owner a copy of its own, unless it holds the only reference already
+    void Unshare()
+    {
+        if (!Array.IsUnique())
+        {
+            Array = MakeShared<TArray<ElementType>>(*Array);
+        }
+    }
+
+    void Refresh()
+    {
+        Elements = Array->GetData();
+        NumElements = Array->Num();
+    }
+
+    TSharedRef<TArray<ElementType>> Array;
+
+    // Cached from Array, so reading an element costs what it does on a TArray
+    const ElementType* Elements = nullptr;
+    int32 NumElements = 0;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Tiles whose look has to be sent to the renderer again. Gameplay code edits the grid's own state (obstacles,
+ * weights, start and goal) and records here which tiles it touched and what changed about them. Once per frame
+ * the grid reads the current state of every recorded tile and uploads it in one go, so writing the same tile
+ * several times in a frame costs one upload, and a frame without edits costs nothing.
+ */
+struct FTileStateBuffer
+{
+    // Which part of a tile's look changed, as bit flags
+    enum EChange : uint8
+    {
+        // Obstacle, start or goal, shown by the tile's color
+        Appearance = 1 << 0,
+
+        // Weight, shown by the label above the tile
+        Label = 1 << 1
+    };
+
+    // Forgets every recorded change and sizes the buffer for a grid of NumTiles tiles
+    void Reset(int32 NumTiles)
+    {
+        Changes.Init(0, NumTiles);
+        DirtyTiles.Reset();
+    }
+
+    // Records that Index changed. Repeated changes to one tile merge into a single entry.
+    void MarkDirty(int32 Index, uint8 Change)
+    {
+        if (!Changes.IsValidIndex(Index))
+        {
+            return;
+        }
+        if (Changes[Index] == 0)
+        {
+            DirtyTiles.Add(Index);
+        }
+        Changes[Index] |= Change;
+    }
+
+    // Records the same change for every tile
+    void MarkAllDirty(uint8 Change)
+    {
+        for (int32 Index = 0; Index < Changes.Num(); Index++)
+        {
+            MarkDirty(Index, Change);
+        }
+    }
+
+    bool HasChanges() const { return DirtyTiles.Num() > 0; }
+    int32 GetNumDirty() const { return DirtyTiles.Num(); }
+
+    // Calls Visit(FirstIndex, Count, Change) for every run of consecutive tiles with the same changes, in index
+    // order, and empties the buffer
+    template <typename FunctionType>
+    void Flush(FunctionType&& Visit)
+    {
+        DirtyTiles.Sort();
+        for (int32 Position = 0; Position < DirtyTiles.Num();)
+        {
+            const int32 First = DirtyTiles[Position];
+            const uint8 Change = Changes[First];
+            int32 Count = 1;
+            while (Position + Count < DirtyTiles.Num() && DirtyTiles[Position + Count] == First + Count && Changes[First + Count] == Change)
+            {
+                Count++;
+            }
+
+            Visit(First, Count, Change);
+            FMemory::Memzero(Changes.GetData() + First, Count);
+            Position += Count;
+        }
+        DirtyTiles.Reset();
+    }
+
+private:
+    // Changes recorded for each tile since the last flush, zero for untouched tiles
+    TArray<uint8> Changes;
+
+    // Every tile with a nonzero entry in Changes, in the order they were first touched
+    TArray<int32> DirtyTiles;
+};
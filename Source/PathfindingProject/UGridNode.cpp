@@ -1,89 +1,76 @@
 #include "UGridNode.h"
-#include "Math/UnrealMathUtility.h"
+#include "Grid.h"
+#include "GridNodeStore.h"
 
 UGridNode::UGridNode()
 {
-	// Indicates that the node is not assigned to a grid position yet
-	GridX = -1;
-	GridY = -1;
+	// Indicates that the view is not bound to a tile yet
+	InstanceIndex = INDEX_NONE;
+}
 
-	// Updated during grid generation
-	WorldPosition = FVector::ZeroVector; 
-	InstanceIndex = -1;
-	
-	Weight = FMath::RandRange(1.0f, 5.0f); // Random movement cost
+void UGridNode::Initialize(AGrid* InGrid, int32 InInstanceIndex)
+{
+	Grid = InGrid;
+	InstanceIndex = InInstanceIndex;
+}
 
-	// Updated in FindPath()
-	GCost = 0.0f;
-	HCost = 0.0f;
-	ParentNode = nullptr;
-	bIsObstacle = false; // Neutral by default
+void UGridNode::Invalidate()
+{
+	Grid.Reset();
+	InstanceIndex = INDEX_NONE;
 }
 
-// Toggles a node's obstacle state
-void UGridNode::SetObstacle(bool bObstacle)
+bool UGridNode::IsValidNode() const
 {
-	bIsObstacle = bObstacle;
+	return Grid.IsValid() && Grid->GetNodeStore().IsValidIndex(InstanceIndex);
 }
 
-void UGridNode::FindNeighbors(const TArray<TArray<UGridNode*>>& Grid, int GridSizeX, int GridSizeY)
+int32 UGridNode::GetGridX() const
 {
-	Neighbors.Empty(); // Clear the array, ensuring we don't carry over neighbors from previous grid
+	return IsValidNode() ? Grid->GetNodeStore().GetGridX(InstanceIndex) : -1;
+}
 
-	if (GridY % 2 == 0) // Checks for even rows. Each offset designates how far to move in x and y directions
-	{
-		int EvenOffsets[6][2] = {
-			{-1,  0}, // Left
-			{ 1,  0}, // Right
-			{ 0, -1}, // Bottom Left
-			{-1, -1}, // Top Left
-			{ 0,  1}, // Bottom Right
-			{-1,  1} // Top Right
-		};
+int32 UGridNode::GetGridY() const
+{
+	return IsValidNode() ? Grid->GetNodeStore().GetGridY(InstanceIndex) : -1;
+}
 
-		for (int i = 0; i < 6; i++)
-		{
-			//Applies the offset to find the neighbors
-			int32 NeighborX = GridX + EvenOffsets[i][0];
-			int32 NeighborY = GridY + EvenOffsets[i][1];
+FVector UGridNode::GetWorldPosition() const
+{
+	return IsValidNode() ? Grid->GetNodeStore().Positions[InstanceIndex] : FVector::ZeroVector;
+}
 
-			// Checks for out of bound neighbors
-			if (NeighborX >= 0 && NeighborX < GridSizeX && NeighborY >= 0 && NeighborY < GridSizeY)
-			{
-				// Retrieves the node at that location, and sets it as a neighbor
-				UGridNode* Neighbor = Grid[NeighborX][NeighborY];
-				if (Neighbor && !Neighbor->bIsObstacle)
-				{
-					// Adds it to the neighbor array
-					Neighbors.Add(Neighbor);
-				}
-			}
-		}
-	}
-	else // Odd rows that were given a shift. The values are slightly different therefore
+float UGridNode::GetWeight() const
+{
+	return IsValidNode() ? Grid->GetNodeStore().Weights[InstanceIndex] : 0.0f;
+}
+
+bool UGridNode::IsObstacle() const
+{
+	return IsValidNode() && Grid->GetNodeStore().Obstacles[InstanceIndex];
+}
+
+// Toggles a node's obstacle state
+void UGridNode::SetObstacle(bool bObstacle)
+{
+	if (IsValidNode())
 	{
-		int OddOffsets[6][2] = {
-			{-1,  0}, // Left
-			{ 1,  0}, // Right
-			{ 0, -1}, // Bottom Left
-			{ 1, -1}, // Top Left
-			{ 0,  1}, // Bottom Right
-			{ 1,  1} // Top Right
-		};
+		Grid->SetNodeObstacle(InstanceIndex, bObstacle);
+	}
+}
 
-		for (int i = 0; i < 6; i++)
+TArray<UGridNode*> UGridNode::GetNeighbors() const
+{
+	TArray<UGridNode*> Neighbors;
+	if (IsValidNode())
+	{
+		for (int32 Neighbor : Grid->GetNodeStore().GetNeighbors(InstanceIndex))
 		{
-			int32 NeighborX = GridX + OddOffsets[i][0];
-			int32 NeighborY = GridY + OddOffsets[i][1];
-
-			if (NeighborX >= 0 && NeighborX < GridSizeX && NeighborY >= 0 && NeighborY < GridSizeY)
+			if (Neighbor != INDEX_NONE)
 			{
-				UGridNode* Neighbor = Grid[NeighborX][NeighborY];
-				if (Neighbor && !Neighbor->bIsObstacle)
-				{
-					Neighbors.Add(Neighbor);
-				}
+				Neighbors.Add(Grid->GetNodeView(Neighbor));
 			}
 		}
 	}
+	return Neighbors;
 }
@@ -4,7 +4,13 @@
 #include "UObject/NoExportTypes.h"
 #include "UGridNode.generated.h"
 
-UCLASS()
+class AGrid;
+
+/*
+ * Blueprint-facing view of one tile. The tile data itself lives in the grid's FGridNodeStore; a view only
+ * remembers which grid and index it refers to, and is created on demand by AGrid::GetNodeView.
+ */
+UCLASS(BlueprintType)
 class PATHFINDINGPROJECT_API UGridNode : public UObject
 {
 	GENERATED_BODY()
@@ -12,37 +18,51 @@ class PATHFINDINGPROJECT_API UGridNode : public UObject
 public:
 	UGridNode();
 
-	//Position of the node
-	int32 GridX;
-	int32 GridY;
+	// Points the view at a tile of the given grid
+	void Initialize(AGrid* InGrid, int32 InInstanceIndex);
 
-	// 3D World Location
-	FVector WorldPosition;
+	// Detaches the view, used when the grid it points into is regenerated
+	void Invalidate();
+
+	// Whether the view still refers to a tile
+	UFUNCTION(BlueprintPure, Category = "Grid Node")
+	bool IsValidNode() const;
 
 	// Instance index corresponding to the instanced mesh
-	int32 InstanceIndex;
+	UFUNCTION(BlueprintPure, Category = "Grid Node")
+	int32 GetInstanceIndex() const { return InstanceIndex; }
+
+	//Position of the node
+	UFUNCTION(BlueprintPure, Category = "Grid Node")
+	int32 GetGridX() const;
 
-	// Random weight (movement cost) used for weighted pathfinding
-	float Weight;
+	UFUNCTION(BlueprintPure, Category = "Grid Node")
+	int32 GetGridY() const;
 
-	// A* costs.
-	float GCost; // Movement cost from start node to current (this) node
-	float HCost; // Estimated cost from start node to goal through straight line distance
-	float FCost() const { return GCost + HCost; } // F Cost is used to select the shortest path
+	// 3D World Location
+	UFUNCTION(BlueprintPure, Category = "Grid Node")
+	FVector GetWorldPosition() const;
 
-	// Parent node for path reconstruction
-	UPROPERTY()
-	UGridNode* ParentNode;
+	// Movement cost used for weighted pathfinding
+	UFUNCTION(BlueprintPure, Category = "Grid Node")
+	float GetWeight() const;
 
 	// Indicates whether this node is an obstacle
-	bool bIsObstacle;
-
-	// Array of node's adjacent neighbors
-	TArray<UGridNode*> Neighbors;
+	UFUNCTION(BlueprintPure, Category = "Grid Node")
+	bool IsObstacle() const;
 
 	// Marks or unmarks this node as an obstacle
+	UFUNCTION(BlueprintCallable, Category = "Grid Node")
 	void SetObstacle(bool bObstacle);
 
-	// Finds the node's adjacent neighbors through the use of positions and offsets
-	void FindNeighbors(const TArray<TArray<UGridNode*>>& Grid, int GridSizeX, int GridSizeY);
+	// Returns views of the node's adjacent neighbors
+	UFUNCTION(BlueprintPure, Category = "Grid Node")
+	TArray<UGridNode*> GetNeighbors() const;
+
+private:
+	// Grid that owns the tile data
+	TWeakObjectPtr<AGrid> Grid;
+
+	// Index of the tile in the grid's node store
+	int32 InstanceIndex;
 };
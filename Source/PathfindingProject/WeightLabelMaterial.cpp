@@ -0,0 +1,99 @@
+#include "WeightLabelMaterial.h"
+#include "PathfindingStats.h"
+
+#if WITH_EDITOR
+#include "HAL/IConsoleManager.h"
+#include "Materials/Material.h"
+#include "Materials/MaterialExpressionConstant3Vector.h"
+#include "Materials/MaterialExpressionCustom.h"
+#include "Materials/MaterialExpressionPerInstanceCustomData.h"
+#include "Materials/MaterialExpressionTextureCoordinate.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+
+// Covers the quad where one of the seven segments is lit for the digit. Segments are numbered top, top right,
+// bottom right, bottom, bottom left, top left and middle, which is also their bit in each digit's mask.
+static const TCHAR* SegmentCode = TEXT(R"(
+static const int Masks[10] = { 0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F };
+static const float4 Segments[7] = {
+    float4(0.30, 0.15, 0.70, 0.23), float4(0.62, 0.15, 0.70, 0.50), float4(0.62, 0.50, 0.70, 0.85),
+    float4(0.30, 0.77, 0.70, 0.85), float4(0.30, 0.50, 0.38, 0.85), float4(0.30, 0.15, 0.38, 0.50),
+    float4(0.30, 0.46, 0.70, 0.54) };
+int Mask = Masks[clamp((int)round(Digit), 0, 9)];
+float Lit = 0.0;
+for (int Segment = 0; Segment < 7; Segment++)
+{
+    float4 Rect = Segments[Segment];
+    if (((Mask >> Segment) & 1) != 0 && all(UV >= Rect.xy) && all(UV <= Rect.zw))
+    {
+        Lit = 1.0;
+    }
+}
+return Lit;
+)");
+
+UMaterial* WeightLabelMaterial::Create(UObject* Outer, FName Name, EObjectFlags Flags)
+{
+    UMaterial* Material = NewObject<UMaterial>(Outer, Name, Flags);
+    Material->MaterialDomain = MD_Surface;
+    Material->BlendMode = BLEND_Masked;
+    Material->SetShadingModel(MSM_Unlit);
+    Material->TwoSided = true;
+    Material->bUsedWithInstancedStaticMeshes = true;
+
+    UMaterialExpressionTextureCoordinate* UV = NewObject<UMaterialExpressionTextureCoordinate>(Material);
+    UMaterialExpressionPerInstanceCustomData* Digit = NewObject<UMaterialExpressionPerInstanceCustomData>(Material);
+    Digit->DataIndex = 0;
+
+    UMaterialExpressionCustom* Segments = NewObject<UMaterialExpressionCustom>(Material);
+    Segments->OutputType = CMOT_Float1;
+    Segments->Code = SegmentCode;
+    Segments->Inputs.SetNum(2);
+    Segments->Inputs[0].InputName = TEXT("UV");
+    Segments->Inputs[0].Input.Expression = UV;
+    Segments->Inputs[1].InputName = TEXT("Digit");
+    Segments->Inputs[1].Input.Expression = Digit;
+
+    // Red, like the text labels used to be
+    UMaterialExpressionConstant3Vector* Color = NewObject<UMaterialExpressionConstant3Vector>(Material);
+    Color->Constant = FLinearColor::Red;
+
+    Material->GetExpressionCollection().AddExpression(UV);
+    Material->GetExpressionCollection().AddExpression(Digit);
+    Material->GetExpressionCollection().AddExpression(Segments);
+    Material->GetExpressionCollection().AddExpression(Color);
+    Material->GetEditorOnlyData()->EmissiveColor.Expression = Color;
+    Material->GetEditorOnlyData()->OpacityMask.Expression = Segments;
+
+    Material->PostEditChange();
+    return Material;
+}
+
+// Pathfinding.CreateLabelMaterial: builds the default weight label material and saves it where AGrid looks for it
+static void CreateLabelMaterial()
+{
+    const FString PackageName = FPackageName::ObjectPathToPackageName(FString(WeightLabelMaterial::AssetPath));
+    UPackage* Package = CreatePackage(*PackageName);
+    UMaterial* Material = WeightLabelMaterial::Create(Package, *FPackageName::GetShortName(PackageName), RF_Public | RF_Standalone);
+    Package->MarkPackageDirty();
+
+    const FString Filename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+    FSavePackageArgs SaveArgs;
+    SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+    if (UPackage::SavePackage(Package, Material, *Filename, SaveArgs))
+    {
+        UE_LOG(LogPathfinding, Display, TEXT("Saved the weight label material to %s"), *Filename);
+    }
+    else
+    {
+        UE_LOG(LogPathfinding, Error, TEXT("Could not save the weight label material to %s"), *Filename);
+    }
+}
+
+static FAutoConsoleCommand CreateLabelMaterialCommand(
+    TEXT("Pathfinding.CreateLabelMaterial"),
+    TEXT("Builds the default weight label material and saves it to /Game/Pathfinding/M_WeightLabel, where grids load it from."),
+    FConsoleCommandDelegate::CreateStatic(&CreateLabelMaterial));
+
+#endif // WITH_EDITOR
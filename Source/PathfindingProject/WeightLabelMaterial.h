@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UMaterial;
+
+/*
+ * The default material of AGrid's weight labels: unlit and masked, it draws the number in custom data 0 as a
+ * seven-segment digit worked out in the shader, so it needs no texture. It is generated rather than authored:
+ * Pathfinding.CreateLabelMaterial builds it and saves it to AssetPath, which is always cooked, and the editor builds a
+ * transient copy on the spot until it has been saved.
+ */
+namespace WeightLabelMaterial
+{
+    // Object path of the saved material
+    inline const TCHAR* const AssetPath = TEXT("/Game/Pathfinding/M_WeightLabel.M_WeightLabel");
+
+#if WITH_EDITOR
+    // Builds and compiles the material. Only the editor can, since it needs the shader compiler.
+    PATHFINDINGPROJECT_API UMaterial* Create(UObject* Outer, FName Name, EObjectFlags Flags);
+#endif
+}